@@ -7,24 +7,43 @@
 #include <ratio>
 
 #include "../src/driver.h"
+#include "../src/lint-sink.h"
 
 using namespace std::chrono;
 
-void Main(string directory, string jobs_file, string output_file, bool lint)
+void Main(
+    string directory,
+    string jobs_file,
+    string output_file,
+    bool lint,
+    int parser_threads,
+    string cache_directory,
+    string load_snapshot,
+    string save_snapshot)
 {
 
     Logger->debug("groot.cpp - Main function called");
     Driver driver;
+    if (cache_directory.length()) {
+        driver.SetZoneCache(cache_directory);
+    }
 
     high_resolution_clock::time_point t1 = high_resolution_clock::now();
 
-    std::ifstream metadataFile(
-        (boost::filesystem::path{directory} / boost::filesystem::path{"metadata.json"}).string());
-    json metadata;
-    metadataFile >> metadata;
-    Logger->debug("groot.cpp (Main) - Successfully read metadata.json file");
+    if (load_snapshot.length()) {
+        driver.LoadSnapshot(load_snapshot);
+    } else {
+        std::ifstream metadataFile(
+            (boost::filesystem::path{directory} / boost::filesystem::path{"metadata.json"}).string());
+        json metadata;
+        metadataFile >> metadata;
+        Logger->debug("groot.cpp (Main) - Successfully read metadata.json file");
 
-    driver.SetContext(metadata, directory, lint);
+        driver.SetContext(metadata, directory, lint, parser_threads);
+    }
+    if (save_snapshot.length()) {
+        driver.SaveSnapshot(save_snapshot);
+    }
 
     high_resolution_clock::time_point t2 = high_resolution_clock::now();
     duration<double> time_span = duration_cast<duration<double>>(t2 - t1);
@@ -74,14 +93,22 @@ a collection of zone files along with a collection of user-
 defined properties and systematically checks if any input to
 DNS can lead to a property violation for the properties.
 
-Usage: groot <zone_directory> [--jobs=<jobs_file_as_json>] [-hlsv] [--lint] [--output=<output_file>]
+Usage:
+  groot <zone_directory> [--jobs=<jobs_file_as_json>] [-hlsv] [--lint [--lint-format=<format>]] [--output=<output_file>] [--threads=<n>] [--cache=<dir>] [--save-snapshot=<file>]
+  groot --load-snapshot=<file> [--jobs=<jobs_file_as_json>] [-hlsv] [--output=<output_file>]
 
 Options:
   -h --help     Show this help screen.
   -l --log      Generate the log file - "log.txt". 
   -s --stats    Print statistics about the current run. 
   -v --verbose  Print more information to the log file. 
-  --lint        Log zone file sanity check warnings separately in "lint.txt".
+  --lint        Log zone file sanity check warnings separately in "lint.json".
+  --lint-format=<format>  Write the lint issues as a JSON array ("json") or as one JSON object per line in
+                          "lint.ndjson" ("ndjson") [default: json].
+  --threads=<n> Number of threads used to parse the zone files [default: 1].
+  --cache=<dir> Cache the parsed zone files in <dir> and load unchanged ones from there.
+  --save-snapshot=<file>  Save the label graph and the zone graphs to <file> once they are built.
+  --load-snapshot=<file>  Load the label graph and the zone graphs from <file> instead of the zone files.
   --version     Show groot version.
 )";
 
@@ -130,8 +157,21 @@ int main(int argc, const char **argv)
 
         string zone_directory;
         string jobs_file;
+        string load_snapshot;
+        string save_snapshot;
+        auto p = args.find("--load-snapshot");
+        if (p->second) {
+            load_snapshot = p->second.asString();
+        }
+        p = args.find("--save-snapshot");
+        if (p->second) {
+            save_snapshot = p->second.asString();
+        }
+
         auto z = args.find("<zone_directory>");
-        if (!z->second) {
+        if (load_snapshot.length()) {
+            // The zone files are not read.
+        } else if (!z->second) {
             Logger->critical(fmt::format("groot.cpp (main) - missing parameter <zone_directory>"));
             cout << USAGE[0];
             exit(EXIT_FAILURE);
@@ -139,7 +179,7 @@ int main(int argc, const char **argv)
             zone_directory = z->second.asString();
         }
 
-        auto p = args.find("--jobs");
+        p = args.find("--jobs");
         if (p->second) {
             jobs_file = p->second.asString();
         }
@@ -150,25 +190,31 @@ int main(int argc, const char **argv)
             output_file = p->second.asString();
         }
 
+        p = args.find("--threads");
+        int parser_threads = 1;
+        if (p->second) {
+            parser_threads = std::stoi(p->second.asString());
+        }
+
+        p = args.find("--cache");
+        string cache_directory;
+        if (p->second) {
+            cache_directory = p->second.asString();
+        }
+
         p = args.find("--lint");
         if (p->second.asBool()) {
-            fstream fs;
-            fs.open("lint.json", ios::out);
-            fs << "[\n";
-            fs.close();
+            LintSink::Format format = LintSink::StringToFormat(args.find("--lint-format")->second.asString());
+            Lint->Open(format == LintSink::Format::JSON ? "lint.json" : "lint.ndjson", format);
         }
 
         // TODO: validate that the directory and property files exist
-        Main(zone_directory, jobs_file, output_file, p->second.asBool());
+        Main(
+            zone_directory, jobs_file, output_file, p->second.asBool(), parser_threads, cache_directory, load_snapshot,
+            save_snapshot);
         Logger->debug("groot.cpp (main) - Finished checking all jobs");
+        Lint->Close();
         spdlog::shutdown();
-
-        if (p->second.asBool()) {
-            fstream fs;
-            fs.open("lint.json", ios::app);
-            fs << "\n]";
-            fs.close();
-        }
         return 0;
     } catch (exception &e) {
         cout << "Exception:- " << e.what() << endl;
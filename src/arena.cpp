@@ -0,0 +1,58 @@
+#include "arena.h"
+
+namespace
+{
+thread_local Arena *current_arena = nullptr;
+}
+
+void *Arena::Allocate(size_t bytes, size_t alignment)
+{
+    while (current_ < blocks_.size()) {
+        Block &block = blocks_[current_];
+        size_t offset = (used_ + alignment - 1) & ~(alignment - 1);
+        if (offset + bytes <= block.size) {
+            used_ = offset + bytes;
+            return block.data.get() + offset;
+        }
+        current_++;
+        used_ = 0;
+    }
+    // The new blocks double, so an arena needs few of them however large an EC gets.
+    size_t size = std::max(kMinBlockSize, bytes + alignment);
+    if (!blocks_.empty()) {
+        size = std::max(size, 2 * blocks_.back().size);
+    }
+    blocks_.push_back({std::make_unique<char[]>(size), size});
+    current_ = blocks_.size() - 1;
+    used_ = 0;
+    return Allocate(bytes, alignment);
+}
+
+void Arena::Reset()
+{
+    if (blocks_.size() > 1) {
+        size_t size = 0;
+        for (auto &block : blocks_) {
+            size += block.size;
+        }
+        blocks_.clear();
+        blocks_.push_back({std::make_unique<char[]>(size), size});
+    }
+    current_ = 0;
+    used_ = 0;
+}
+
+Arena *Arena::Current()
+{
+    return current_arena;
+}
+
+Arena::Scope::Scope(Arena &arena) : previous_(current_arena)
+{
+    current_arena = &arena;
+}
+
+Arena::Scope::~Scope()
+{
+    current_arena = previous_;
+}
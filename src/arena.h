@@ -0,0 +1,106 @@
+#ifndef ARENA_H_
+#define ARENA_H_
+
+#include <algorithm>
+#include <memory>
+#include <type_traits>
+#include <vector>
+
+// Monotonic memory for short-lived structures that are thrown away as a whole, such as the interpretation graph of an
+// EC. Allocating bumps a pointer, freeing does nothing and Reset makes all the memory available again without
+// returning it, so a worker that resets its arena after every EC stops allocating once the blocks are large enough.
+// An arena is not thread safe; every worker owns its own.
+class Arena
+{
+    struct Block {
+        std::unique_ptr<char[]> data;
+        size_t size;
+    };
+
+    static constexpr size_t kMinBlockSize = 64 * 1024;
+
+    std::vector<Block> blocks_;
+    size_t current_ = 0;
+    size_t used_ = 0;
+
+  public:
+    Arena() = default;
+    Arena(const Arena &) = delete;
+    Arena &operator=(const Arena &) = delete;
+
+    void *Allocate(size_t bytes, size_t alignment);
+    // Everything allocated before is invalid afterwards. An arena that needed more than one block is merged into a
+    // single block as large as all of them.
+    void Reset();
+
+    // The arena the ArenaAllocators constructed on this thread take their memory from, nullptr outside a Scope.
+    static Arena *Current();
+
+    class Scope
+    {
+        Arena *previous_;
+
+      public:
+        explicit Scope(Arena &);
+        ~Scope();
+        Scope(const Scope &) = delete;
+        Scope &operator=(const Scope &) = delete;
+    };
+};
+
+// Allocator for the standard and boost containers. An allocator is bound to the current arena of the thread when it is
+// constructed, and falls back to the heap if there is none. Copying a container outside of a Scope therefore gives a
+// copy on the heap that outlives the arena.
+template <typename T> class ArenaAllocator
+{
+    Arena *arena_;
+
+  public:
+    using value_type = T;
+    using propagate_on_container_copy_assignment = std::false_type;
+    using propagate_on_container_move_assignment = std::true_type;
+    using propagate_on_container_swap = std::true_type;
+
+    ArenaAllocator() noexcept : arena_(Arena::Current())
+    {
+    }
+    explicit ArenaAllocator(Arena *arena) noexcept : arena_(arena)
+    {
+    }
+    template <typename U> ArenaAllocator(const ArenaAllocator<U> &other) noexcept : arena_(other.get_arena())
+    {
+    }
+
+    T *allocate(size_t n)
+    {
+        if (!arena_) {
+            return static_cast<T *>(::operator new(n * sizeof(T)));
+        }
+        return static_cast<T *>(arena_->Allocate(n * sizeof(T), alignof(T)));
+    }
+    void deallocate(T *p, size_t) noexcept
+    {
+        if (!arena_) {
+            ::operator delete(p);
+        }
+    }
+    ArenaAllocator select_on_container_copy_construction() const
+    {
+        return ArenaAllocator();
+    }
+
+    Arena *get_arena() const
+    {
+        return arena_;
+    }
+    template <typename U> bool operator==(const ArenaAllocator<U> &other) const
+    {
+        return arena_ == other.get_arena();
+    }
+    template <typename U> bool operator!=(const ArenaAllocator<U> &other) const
+    {
+        return arena_ != other.get_arena();
+    }
+};
+
+#endif
@@ -0,0 +1,151 @@
+#include "canonical-index.h"
+
+bool CanonicalIndex::LabelLess(const NodeLabel &a, const NodeLabel &b)
+{
+    if (a == b) {
+        return false;
+    }
+    // std::string compares its characters as unsigned char, which is the octet order RFC 4034 asks for.
+    int c = a.lowercase().get().compare(b.lowercase().get());
+    if (c != 0) {
+        return c < 0;
+    }
+    return a.id < b.id;
+}
+
+void CanonicalIndex::Append(uint32_t parent, const NodeLabel &label, uint32_t vertex, std::bitset<RRType::N> types)
+{
+    Entry entry;
+    entry.vertex = vertex;
+    entry.labels = static_cast<uint32_t>(labels_.size());
+    entry.depth = 0;
+    if (entries_.empty()) {
+        entry.parent = 0;
+    } else {
+        entry.parent = parent;
+        const Entry &p = entries_[parent];
+        for (uint32_t i = p.labels; i < p.labels + p.depth; i++) {
+            NodeLabel l = labels_[i];
+            labels_.push_back(l);
+        }
+        labels_.push_back(label);
+        entry.depth = p.depth + 1;
+    }
+    entry.types = types;
+    entry.zone_cut = types[RRType::NS] && !types[RRType::SOA];
+    entry.dname = types[RRType::DNAME];
+    entry.subtree_end = static_cast<uint32_t>(entries_.size() + 1);
+    entry.stop = kNone;
+    entry.wildcard = kNone;
+    entries_.push_back(entry);
+}
+
+void CanonicalIndex::Finish()
+{
+    static const NodeLabel wildcard("*");
+    // A node comes after its parent, so a backward pass sees the ends of the subtrees of the children first and a
+    // forward pass sees the stop of the parent first. The lookups never stop at the root.
+    for (size_t i = entries_.size(); i-- > 1;) {
+        Entry &parent = entries_[entries_[i].parent];
+        parent.subtree_end = std::max(parent.subtree_end, entries_[i].subtree_end);
+    }
+    for (size_t i = 1; i < entries_.size(); i++) {
+        Entry &entry = entries_[i];
+        Entry &parent = entries_[entry.parent];
+        if (parent.stop != kNone) {
+            entry.stop = parent.stop;
+        } else if (entry.zone_cut || entry.dname) {
+            entry.stop = static_cast<uint32_t>(i);
+        }
+        if (labels_[entry.labels + entry.depth - 1] == wildcard) {
+            parent.wildcard = static_cast<uint32_t>(i);
+        }
+    }
+}
+
+void CanonicalIndex::clear()
+{
+    entries_ = {};
+    labels_ = {};
+}
+
+bool CanonicalIndex::empty() const
+{
+    return entries_.empty();
+}
+
+const CanonicalIndex::Entry &CanonicalIndex::operator[](size_t i) const
+{
+    return entries_[i];
+}
+
+DomainName CanonicalIndex::Name(const Entry &entry) const
+{
+    return DomainName(labels_.begin() + entry.labels, labels_.begin() + entry.labels + entry.depth);
+}
+
+int CanonicalIndex::Compare(const Entry &entry, const DomainName &name) const
+{
+    const NodeLabel *labels = labels_.data() + entry.labels;
+    for (size_t i = 0; i < entry.depth && i < name.size(); i++) {
+        if (labels[i] != name[i]) {
+            return LabelLess(labels[i], name[i]) ? -1 : 1;
+        }
+    }
+    if (entry.depth == name.size()) {
+        return 0;
+    }
+    return entry.depth < name.size() ? -1 : 1;
+}
+
+size_t CanonicalIndex::Predecessor(const DomainName &name) const
+{
+    // The root sorts before every name, so there always is one.
+    auto it = std::upper_bound(entries_.begin(), entries_.end(), name, [this](const DomainName &n, const Entry &e) {
+        return Compare(e, n) > 0;
+    });
+    return static_cast<size_t>(it - entries_.begin()) - 1;
+}
+
+size_t CanonicalIndex::CommonDepth(const Entry &entry, const DomainName &name) const
+{
+    const NodeLabel *labels = labels_.data() + entry.labels;
+    size_t i = 0;
+    while (i < entry.depth && i < name.size() && labels[i] == name[i]) {
+        i++;
+    }
+    return i;
+}
+
+const CanonicalIndex::Entry &CanonicalIndex::ClosestEncloser(const DomainName &name) const
+{
+    // Every existing ancestor of the name sorts between the deepest one and the name, so the deepest is the common
+    // ancestor of the name and the last entry not after it.
+    size_t i = Predecessor(name);
+    size_t depth = CommonDepth(entries_[i], name);
+    while (entries_[i].depth > depth) {
+        i = entries_[i].parent;
+    }
+    if (entries_[i].stop != kNone) {
+        return entries_[entries_[i].stop];
+    }
+    return entries_[i];
+}
+
+const CanonicalIndex::Entry *CanonicalIndex::Find(const DomainName &name) const
+{
+    const Entry &entry = entries_[Predecessor(name)];
+    if (Compare(entry, name) == 0) {
+        return &entry;
+    }
+    return nullptr;
+}
+
+boost::iterator_range<const CanonicalIndex::Entry *> CanonicalIndex::Subtree(const DomainName &name) const
+{
+    const Entry *entry = Find(name);
+    if (!entry) {
+        return {entries_.data(), entries_.data()};
+    }
+    return {entry, entries_.data() + entry->subtree_end};
+}
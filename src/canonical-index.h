@@ -0,0 +1,68 @@
+#ifndef CANONICAL_INDEX_H_
+#define CANONICAL_INDEX_H_
+
+#include <bitset>
+#include <boost/range/iterator_range.hpp>
+
+#include "resource-record.h"
+
+// Read-only index of the owner names of a zone as one array in the canonical order of RFC 4034 section 6.1, that is a
+// preorder walk of the zone tree with the children of every node sorted by their lower case label. Every entry carries
+// the type bitmap of its node and the facts the lookups need, so the closest encloser of a name, and with it a
+// referral, a DNAME rewrite or a wildcard match, comes from a binary search over contiguous memory. The names below a
+// node are the contiguous run of entries that follows it.
+class CanonicalIndex
+{
+  public:
+    static constexpr uint32_t kNone = std::numeric_limits<uint32_t>::max();
+
+    struct Entry {
+        // The vertex of the zone graph and the entry of its parent (the root is its own parent).
+        uint32_t vertex;
+        uint32_t parent;
+        // The name is labels_[labels] to labels_[labels + depth - 1].
+        uint32_t labels;
+        uint16_t depth;
+        bool zone_cut;
+        bool dname;
+        std::bitset<RRType::N> types;
+        // One past the last entry below this one.
+        uint32_t subtree_end;
+        // The first zone cut or DNAME node on the way down from the root to this one (itself included) or kNone; the
+        // lookups do not descend below it.
+        uint32_t stop;
+        // The entry of the "*" child or kNone.
+        uint32_t wildcard;
+    };
+
+  private:
+    std::vector<Entry> entries_;
+    std::vector<NodeLabel> labels_;
+
+    int Compare(const Entry &, const DomainName &) const;
+    size_t Predecessor(const DomainName &) const;
+    size_t CommonDepth(const Entry &, const DomainName &) const;
+
+  public:
+    // Canonical order of two labels: by their lower case octets, and by id between labels that differ only in case.
+    static bool LabelLess(const NodeLabel &, const NodeLabel &);
+
+    // Appends the entry of a node, whose parent has to be appended before it; the root comes first with no parent.
+    void Append(uint32_t parent, const NodeLabel &, uint32_t vertex, std::bitset<RRType::N> types);
+    void Finish();
+
+    void clear();
+    bool empty() const;
+    const Entry &operator[](size_t) const;
+    DomainName Name(const Entry &) const;
+
+    // The entry where a lookup of the name stops: its deepest existing ancestor (or itself) unless a zone cut or a
+    // DNAME node is reached first on the way down.
+    const Entry &ClosestEncloser(const DomainName &) const;
+    // The entry of the name itself or nullptr.
+    const Entry *Find(const DomainName &) const;
+    // The name and every name below it, in canonical order; empty if the name is not in the zone.
+    boost::iterator_range<const Entry *> Subtree(const DomainName &) const;
+};
+
+#endif
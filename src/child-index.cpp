@@ -0,0 +1,114 @@
+#include "child-index.h"
+#include "my-logger.h"
+
+namespace
+{
+
+// Fibonacci hashing of the label id; consecutive ids land in distinct slots of a power of two table.
+uint32_t Slot(const NodeLabel &label, uint32_t mask)
+{
+    return (label.id * 2654435769u) & mask;
+}
+
+} // namespace
+
+void ChildIndex::CheckSize(size_t vertex_count, size_t edge_count)
+{
+    if (vertex_count >= kNone || edge_count >= kNone / 4) {
+        Logger->critical(fmt::format(
+            "child-index.cpp (CheckSize) - A graph with {} vertices and {} edges is too large to be indexed",
+            vertex_count, edge_count));
+        exit(EXIT_FAILURE);
+    }
+}
+
+void ChildIndex::Finish()
+{
+    size_t n = offsets_.size() - 1;
+    wildcards_.assign(n, kNone);
+    table_offsets_.assign(n + 1, 0);
+    static const NodeLabel wildcard("*");
+    for (size_t v = 0; v < n; v++) {
+        auto first = children_.begin() + offsets_[v];
+        auto last = children_.begin() + offsets_[v + 1];
+        std::sort(first, last, [](const Child &a, const Child &b) { return a.label.id < b.label.id; });
+        auto it = std::lower_bound(
+            first, last, wildcard, [](const Child &child, const NodeLabel &l) { return child.label.id < l.id; });
+        if (it != last && it->label == wildcard) {
+            wildcards_[v] = it->vertex;
+        }
+        uint32_t size = 0;
+        uint32_t count = offsets_[v + 1] - offsets_[v];
+        if (count > kSortedChildrenLimit) {
+            size = 1;
+            while (size < 2 * count) {
+                size <<= 1;
+            }
+        }
+        table_offsets_[v + 1] = table_offsets_[v] + size;
+    }
+    tables_.assign(table_offsets_[n], kNone);
+    for (size_t v = 0; v < n; v++) {
+        if (table_offsets_[v + 1] == table_offsets_[v]) {
+            continue;
+        }
+        uint32_t mask = table_offsets_[v + 1] - table_offsets_[v] - 1;
+        uint32_t *table = tables_.data() + table_offsets_[v];
+        for (uint32_t i = offsets_[v]; i < offsets_[v + 1]; i++) {
+            uint32_t slot = Slot(children_[i].label, mask);
+            while (table[slot] != kNone) {
+                slot = (slot + 1) & mask;
+            }
+            table[slot] = i;
+        }
+    }
+}
+
+void ChildIndex::clear()
+{
+    offsets_ = {};
+    children_ = {};
+    table_offsets_ = {};
+    tables_ = {};
+    wildcards_ = {};
+}
+
+bool ChildIndex::empty() const
+{
+    return offsets_.empty();
+}
+
+boost::iterator_range<const ChildIndex::Child *> ChildIndex::Children(size_t v) const
+{
+    return {children_.data() + offsets_[v], children_.data() + offsets_[v + 1]};
+}
+
+boost::optional<size_t> ChildIndex::Find(size_t v, const NodeLabel &label) const
+{
+    uint32_t size = table_offsets_[v + 1] - table_offsets_[v];
+    if (size == 0) {
+        auto first = children_.begin() + offsets_[v];
+        auto last = children_.begin() + offsets_[v + 1];
+        auto it = std::lower_bound(
+            first, last, label, [](const Child &child, const NodeLabel &l) { return child.label.id < l.id; });
+        if (it != last && it->label == label) {
+            return it->vertex;
+        }
+        return {};
+    }
+    const uint32_t *table = tables_.data() + table_offsets_[v];
+    for (uint32_t slot = Slot(label, size - 1); table[slot] != kNone; slot = (slot + 1) & (size - 1)) {
+        if (children_[table[slot]].label == label) {
+            return children_[table[slot]].vertex;
+        }
+    }
+    return {};
+}
+
+boost::optional<size_t> ChildIndex::Wildcard(size_t v) const
+{
+    if (wildcards_[v] == kNone) {
+        return {};
+    }
+    return wildcards_[v];
+}
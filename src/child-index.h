@@ -0,0 +1,76 @@
+#ifndef CHILD_INDEX_H_
+#define CHILD_INDEX_H_
+
+#include <boost/optional.hpp>
+#include <boost/range/iterator_range.hpp>
+
+#include "node-label.h"
+
+// Vertices with up to this many children are searched by binary search; the others get an open addressing table.
+const uint32_t kSortedChildrenLimit = 16;
+
+// Index of the children of every vertex of a graph by label, built once the graph is complete. The children of all the
+// vertices are kept in one array, those of each vertex contiguous and sorted by label id. A vertex with more than
+// kSortedChildrenLimit children also gets a linear probing table over its children, at most half full, so a lookup
+// costs O(log k) for a small fan-out and O(1) for a large one such as a TLD or a reverse zone. The wildcard child of
+// every vertex is kept aside.
+class ChildIndex
+{
+  public:
+    struct Child {
+        NodeLabel label;
+        uint32_t vertex;
+    };
+
+  private:
+    static constexpr uint32_t kNone = std::numeric_limits<uint32_t>::max();
+
+    // The children of vertex v are children_[offsets_[v]] to children_[offsets_[v + 1] - 1], and its table (empty for
+    // a small fan-out) is tables_[table_offsets_[v]] to tables_[table_offsets_[v + 1] - 1], holding indices into
+    // children_ or kNone.
+    std::vector<uint32_t> offsets_;
+    std::vector<Child> children_;
+    std::vector<uint32_t> table_offsets_;
+    std::vector<uint32_t> tables_;
+    std::vector<uint32_t> wildcards_;
+
+    static void CheckSize(size_t, size_t);
+    void Finish();
+
+  public:
+    // Indexes the children of every vertex of the graph, which needs a "name" label on its vertices, through the out
+    // edges for which is_child holds.
+    template <typename Graph, typename EdgePredicate> void Build(const Graph &graph, EdgePredicate is_child)
+    {
+        size_t n = num_vertices(graph);
+        CheckSize(n, num_edges(graph));
+        offsets_.assign(n + 1, 0);
+        for (auto v : boost::make_iterator_range(vertices(graph))) {
+            offsets_[v + 1] = offsets_[v];
+            for (auto e : boost::make_iterator_range(out_edges(v, graph))) {
+                if (is_child(e)) {
+                    offsets_[v + 1]++;
+                }
+            }
+        }
+        children_.resize(offsets_[n]);
+        for (auto v : boost::make_iterator_range(vertices(graph))) {
+            uint32_t next = offsets_[v];
+            for (auto e : boost::make_iterator_range(out_edges(v, graph))) {
+                if (is_child(e)) {
+                    auto u = target(e, graph);
+                    children_[next++] = Child{graph[u].name, static_cast<uint32_t>(u)};
+                }
+            }
+        }
+        Finish();
+    }
+
+    void clear();
+    bool empty() const;
+    boost::iterator_range<const Child *> Children(size_t) const;
+    boost::optional<size_t> Find(size_t, const NodeLabel &) const;
+    boost::optional<size_t> Wildcard(size_t) const;
+};
+
+#endif
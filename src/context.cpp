@@ -0,0 +1,110 @@
+#include "context.h"
+
+NameserverId Context::Intern(const string &ns)
+{
+    auto [it, inserted] = nameserver_ids.emplace(ns, static_cast<NameserverId>(nameservers.size()));
+    if (inserted) {
+        nameservers.push_back(ns);
+        nameserver_zones.emplace_back();
+    }
+    return it->second;
+}
+
+void Context::IndexNameservers()
+{
+    nameservers.clear();
+    nameserver_ids.clear();
+    nameserver_zones.clear();
+    zones.assign(static_cast<size_t>(zoneId_counter_) + 1, nullptr);
+    top_nameserver_ids.clear();
+    ns_target_ids_.clear();
+
+    Intern("");
+    for (auto &ns : top_nameservers) {
+        top_nameserver_ids.push_back(Intern(ns));
+    }
+    // Going through the zone ids in order lists the zones of every name server in the order they were added, as in
+    // nameserver_zoneIds_map. Zone files without a SOA record leave gaps.
+    for (int zid = 1; zid <= zoneId_counter_; zid++) {
+        auto it = zoneId_to_zone.find(zid);
+        if (it != zoneId_to_zone.end()) {
+            zones[zid] = &it->second;
+            nameserver_zones[Intern(zoneId_nameserver_map.at(zid).get())].push_back(zid);
+        }
+    }
+    for (const zone::Graph *z : zones) {
+        if (!z) {
+            continue;
+        }
+        for (zone::Graph::VertexDescriptor v : boost::make_iterator_range(vertices(*z))) {
+            if (!(*z)[v].rr_types[RRType::NS]) {
+                continue;
+            }
+            for (auto &record : z->RRSet(v, RRType::NS)) {
+                ns_target_ids_.emplace(&record.get_rdata(), Intern(record.get_rdata()));
+            }
+        }
+    }
+    top_nameserver_set.clear();
+    top_nameserver_set.resize(nameservers.size());
+    for (NameserverId id : top_nameserver_ids) {
+        top_nameserver_set.set(id);
+    }
+    IndexOrigins();
+}
+
+void Context::IndexOrigins()
+{
+    origin_children_.clear();
+    origin_zones_.assign(nameservers.size(), 0);
+    for (NameserverId ns = 0; ns < nameservers.size(); ns++) {
+        for (int zid : nameserver_zones[ns]) {
+            uint32_t node = ns;
+            for (const NodeLabel &l : zones[zid]->get_origin()) {
+                auto [it, inserted] =
+                    origin_children_.emplace(std::make_pair(node, l.id), static_cast<uint32_t>(origin_zones_.size()));
+                if (inserted) {
+                    origin_zones_.push_back(0);
+                }
+                node = it->second;
+            }
+            // Zone ids start at 1. The first zone with an origin keeps it, as the linear search did.
+            if (!origin_zones_[node]) {
+                origin_zones_[node] = zid;
+            }
+        }
+    }
+}
+
+boost::optional<int> Context::GetRelevantZone(NameserverId ns, const DomainName &name) const
+{
+    boost::optional<int> zone;
+    uint32_t node = ns;
+    if (origin_zones_[node]) {
+        zone = origin_zones_[node];
+    }
+    for (const NodeLabel &l : name) {
+        auto it = origin_children_.find(std::make_pair(node, l.id));
+        if (it == origin_children_.end()) {
+            break;
+        }
+        node = it->second;
+        if (origin_zones_[node]) {
+            zone = origin_zones_[node];
+        }
+    }
+    return zone;
+}
+
+boost::optional<NameserverId> Context::GetNameserverId(const ResourceRecord &record) const
+{
+    auto it = ns_target_ids_.find(&record.get_rdata());
+    if (it != ns_target_ids_.end()) {
+        return it->second;
+    }
+    auto id = nameserver_ids.find(record.get_rdata());
+    if (id == nameserver_ids.end()) {
+        return {};
+    }
+    return id->second;
+}
@@ -1,8 +1,19 @@
 #ifndef CONTEXT_H
 #define CONTEXT_H
 
+// Boost 1.74's unordered map serialization uses library_version_type without including it.
+#include <boost/serialization/library_version_type.hpp>
+
+#include <boost/serialization/boost_unordered_map.hpp>
+#include <boost/dynamic_bitset.hpp>
+#include <boost/serialization/split_member.hpp>
+
 #include "zone-graph.h"
 
+using NameserverId = uint32_t;
+// The name server of the start vertices of the interpretation graphs, which has the empty name.
+const NameserverId kStartNameserver = 0;
+
 struct Context {
     boost::unordered_map<string, std::vector<int>> nameserver_zoneIds_map;
     boost::unordered_map<int, Nameserver> zoneId_nameserver_map;
@@ -10,6 +21,73 @@ struct Context {
     boost::unordered_map<int, zone::Graph> zoneId_to_zone;
     boost::unordered_map<string, long> type_to_rr_count;
     int zoneId_counter_ = 0;
+
+    // Built by IndexNameservers from the fields above, and not saved in a snapshot. The resolution works with dense
+    // name server ids: id 0 is the empty name of the start vertices of the interpretation graphs, and the others are
+    // the top name servers, the name servers of the zones and the targets of the NS records of the zones.
+    vector<string> nameservers;
+    boost::unordered_map<string, NameserverId> nameserver_ids;
+    // The zones of a name server, the zone of an id (nullptr if the id was not given to a zone) and the top name
+    // servers in metadata order and as a set.
+    vector<vector<int>> nameserver_zones;
+    vector<const zone::Graph *> zones;
+    vector<NameserverId> top_nameserver_ids;
+    boost::dynamic_bitset<> top_nameserver_set;
+
+    void IndexNameservers();
+    // The id of the target of an NS record of one of the zones, which IndexNameservers interns up front. The lookup
+    // only reads the maps, so the resolution threads can call it concurrently; it is empty for a name server that was
+    // never interned.
+    boost::optional<NameserverId> GetNameserverId(const ResourceRecord &) const;
+    // The zone of the name server whose origin is the longest prefix of the name, the first of them in
+    // nameserver_zones if several zones have that origin.
+    boost::optional<int> GetRelevantZone(NameserverId, const DomainName &) const;
+
+  private:
+    // The NS targets by the address of their shared rdata, which is the same for all the records with the same text.
+    boost::unordered_map<const string *, NameserverId> ns_target_ids_;
+    // A trie of the zone origins of every name server. Node n < nameservers.size() is the root of the trie of name
+    // server n, and the child of a node for a label is found by the node and the label id. origin_zones_ holds the zone
+    // whose origin ends at a node, 0 for none.
+    boost::unordered_map<std::pair<uint32_t, uint32_t>, uint32_t> origin_children_;
+    vector<int> origin_zones_;
+
+    NameserverId Intern(const string &);
+    void IndexOrigins();
+
+    friend class boost::serialization::access;
+    template <typename Archive> void save(Archive &ar, const unsigned int version) const
+    {
+        ar &nameserver_zoneIds_map;
+        ar &zoneId_nameserver_map;
+        ar &top_nameservers;
+        // zone::Graph has no public default constructor, so the zones are written one by one.
+        size_t zone_count = zoneId_to_zone.size();
+        ar &zone_count;
+        for (auto &[id, z] : zoneId_to_zone) {
+            ar &id;
+            ar &z;
+        }
+        ar &type_to_rr_count;
+        ar &zoneId_counter_;
+    }
+    template <typename Archive> void load(Archive &ar, const unsigned int version)
+    {
+        ar &nameserver_zoneIds_map;
+        ar &zoneId_nameserver_map;
+        ar &top_nameservers;
+        size_t zone_count;
+        ar &zone_count;
+        zoneId_to_zone.clear();
+        for (size_t i = 0; i < zone_count; i++) {
+            int id;
+            ar &id;
+            ar &zoneId_to_zone.emplace(id, zone::Graph(id)).first->second;
+        }
+        ar &type_to_rr_count;
+        ar &zoneId_counter_;
+    }
+    BOOST_SERIALIZATION_SPLIT_MEMBER()
 };
 
 #endif
\ No newline at end of file
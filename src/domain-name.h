@@ -0,0 +1,140 @@
+#ifndef DOMAIN_NAME_H_
+#define DOMAIN_NAME_H_
+
+#include <boost/container/small_vector.hpp>
+#include <initializer_list>
+
+#include "node-label.h"
+
+// Labels stored inline by DomainName; longer names spill over to the heap.
+const size_t kInlineLabels = 8;
+
+// A domain name as its labels from the top down (the root has none). Typical names fit inline, so copying one does not
+// allocate, and the length of the name in wire format is kept alongside the labels so length checks are O(1). The
+// labels can only be changed at the end, which keeps that length up to date.
+class DomainName
+{
+  public:
+    using Labels = boost::container::small_vector<NodeLabel, kInlineLabels>;
+    using const_iterator = Labels::const_iterator;
+    using value_type = NodeLabel;
+
+  private:
+    Labels labels_;
+    // Wire format length: a length byte per label plus the label itself, and the zero byte of the root.
+    size_t wire_length_ = 1;
+
+    friend class boost::serialization::access;
+    template <typename Archive> void save(Archive &ar, const unsigned int version) const
+    {
+        size_t size = labels_.size();
+        ar &size;
+        for (const NodeLabel &l : labels_) {
+            ar &l;
+        }
+    }
+    template <typename Archive> void load(Archive &ar, const unsigned int version)
+    {
+        size_t size;
+        ar &size;
+        clear();
+        for (size_t i = 0; i < size; i++) {
+            NodeLabel l;
+            ar &l;
+            push_back(l);
+        }
+    }
+    BOOST_SERIALIZATION_SPLIT_MEMBER()
+
+  public:
+    DomainName() = default;
+    DomainName(std::initializer_list<NodeLabel> labels)
+    {
+        for (const NodeLabel &l : labels) {
+            push_back(l);
+        }
+    }
+    template <typename Iterator> DomainName(Iterator first, Iterator last)
+    {
+        for (; first != last; ++first) {
+            push_back(*first);
+        }
+    }
+
+    size_t size() const
+    {
+        return labels_.size();
+    }
+    bool empty() const
+    {
+        return labels_.empty();
+    }
+    size_t wire_length() const
+    {
+        return wire_length_;
+    }
+    const NodeLabel &operator[](size_t i) const
+    {
+        return labels_[i];
+    }
+    const NodeLabel &front() const
+    {
+        return labels_.front();
+    }
+    const NodeLabel &back() const
+    {
+        return labels_.back();
+    }
+    const_iterator begin() const
+    {
+        return labels_.begin();
+    }
+    const_iterator end() const
+    {
+        return labels_.end();
+    }
+
+    void push_back(const NodeLabel &l)
+    {
+        labels_.push_back(l);
+        wire_length_ += l.length() + 1;
+    }
+    void pop_back()
+    {
+        wire_length_ -= labels_.back().length() + 1;
+        labels_.pop_back();
+    }
+    void clear()
+    {
+        labels_.clear();
+        wire_length_ = 1;
+    }
+    void reserve(size_t n)
+    {
+        labels_.reserve(n);
+    }
+
+    // True if this name is the given domain or below it.
+    bool IsSubDomainOf(const DomainName &domain) const
+    {
+        if (domain.size() > size() || domain.wire_length_ > wire_length_) {
+            return false;
+        }
+        for (size_t i = 0; i < domain.size(); i++) {
+            if (domain.labels_[i] != labels_[i]) {
+                return false;
+            }
+        }
+        return true;
+    }
+    bool operator==(const DomainName &name) const
+    {
+        return wire_length_ == name.wire_length_ && labels_ == name.labels_;
+    }
+    bool operator!=(const DomainName &name) const
+    {
+        return !(*this == name);
+    }
+};
+
+#endif
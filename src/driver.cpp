@@ -4,6 +4,8 @@
 #include <boost/accumulators/accumulators.hpp>
 #include <boost/accumulators/statistics.hpp>
 #include <boost/algorithm/string.hpp>
+#include <boost/archive/binary_iarchive.hpp>
+#include <boost/archive/binary_oarchive.hpp>
 #include <boost/filesystem.hpp>
 
 using namespace boost::accumulators;
@@ -37,12 +39,15 @@ void Driver::GenerateECsAndCheckProperties()
             bool itemsLeft;
             unique_ptr<Task> item;
             int id = i;
+            interpretation::Graph interpretation_graph;
+            vector<boost::any> worker_ec_variadic = ec_variadic;
+            worker_ec_variadic.push_back(&interpretation_graph);
             do {
                 itemsLeft = !current_job_.finished_ec_generation;
                 while (current_job_.ec_queue.try_dequeue(item)) {
                     itemsLeft = true;
                     if (dynamic_cast<ECTask *>(item.get()) != nullptr) {
-                        item->Process(context_, ec_variadic);
+                        item->Process(context_, worker_ec_variadic);
                     } else if (dynamic_cast<StructuralTask *>(item.get()) != nullptr) {
                         item->Process(context_, structural_variadic);
                     }
@@ -145,6 +150,17 @@ void MetadataSanityCheck(const json &metadata, string directory)
                 zone_json.dump(4)));
             exit(EXIT_FAILURE);
         }
+        if (zone_json.count("Format") == 1) {
+            string format = string(zone_json["Format"]);
+            boost::to_lower(format);
+            if (format != "text" && format != "wire") {
+                Logger->critical(fmt::format(
+                    "driver.cpp (MetadataSanityCheck) -\n{} \nThe \"Format\" of this zone file has to be either "
+                    "\"text\" or \"wire\". Check the example metadata.json format.",
+                    zone_json.dump(4)));
+                exit(EXIT_FAILURE);
+            }
+        }
         string ns = string(zone_json["NameServer"]);
         boost::to_lower(ns);
         nameservers.insert(ns);
@@ -171,7 +187,45 @@ void MetadataSanityCheck(const json &metadata, string directory)
     }
 }
 
-long Driver::SetContext(const json &metadata, string directory, bool lint)
+void Driver::LoadSnapshot(string snapshot_file)
+{
+    std::ifstream ifs(snapshot_file, std::ios::binary);
+    if (!ifs.is_open()) {
+        Logger->critical(fmt::format("driver.cpp (LoadSnapshot) - Unable to open the snapshot file {}", snapshot_file));
+        std::exit(EXIT_FAILURE);
+    }
+    try {
+        boost::archive::binary_iarchive ia(ifs);
+        ia >> label_graph_;
+        ia >> context_;
+    } catch (const boost::archive::archive_exception &e) {
+        Logger->critical(fmt::format(
+            "driver.cpp (LoadSnapshot) - {} is not a valid snapshot file ({})", snapshot_file, e.what()));
+        std::exit(EXIT_FAILURE);
+    }
+    Logger->info(fmt::format(
+        "Loaded {} zone files from the snapshot {}", context_.zoneId_to_zone.size(), snapshot_file));
+    Logger->info(
+        fmt::format("Label Graph: vertices = {}, edges = {}", num_vertices(label_graph_), num_edges(label_graph_)));
+    label_graph_.Freeze();
+    context_.IndexNameservers();
+}
+
+void Driver::SaveSnapshot(string snapshot_file) const
+{
+    std::ofstream ofs(snapshot_file, std::ios::binary | std::ios::trunc);
+    if (!ofs.is_open()) {
+        Logger->critical(
+            fmt::format("driver.cpp (SaveSnapshot) - Unable to create the snapshot file {}", snapshot_file));
+        std::exit(EXIT_FAILURE);
+    }
+    boost::archive::binary_oarchive oa(ofs);
+    oa << label_graph_;
+    oa << context_;
+    Logger->debug(fmt::format("driver.cpp (SaveSnapshot) - Snapshot written to {}", snapshot_file));
+}
+
+long Driver::SetContext(const json &metadata, string directory, bool lint, int parser_threads)
 {
     // TODO: Teardown if the context is set multiple times
 
@@ -182,7 +236,7 @@ long Driver::SetContext(const json &metadata, string directory, bool lint)
         boost::to_lower(s);
         context_.top_nameservers.push_back(s);
     }
-    long rr_count = 0;
+    vector<tuple<string, string, string, ZoneFileFormat>> zone_files;
     for (auto &zone_json : metadata["ZoneFiles"]) {
         string file_name;
         zone_json["FileName"].get_to(file_name);
@@ -191,7 +245,23 @@ long Driver::SetContext(const json &metadata, string directory, bool lint)
         boost::to_lower(ns);
         string origin = zone_json.count("Origin") ? string(zone_json["Origin"]) : "";
         boost::to_lower(origin);
-        rr_count += ParseZoneFileAndExtendGraphs(zone_file_path, ns, origin, lint);
+        string format = zone_json.count("Format") ? string(zone_json["Format"]) : "text";
+        boost::to_lower(format);
+        zone_files.push_back(
+            {zone_file_path, ns, origin, format == "wire" ? ZoneFileFormat::WIRE : ZoneFileFormat::TEXT});
+    }
+    long rr_count = 0;
+    if (parser_threads > 1 && zone_files.size() > 1) {
+        rr_count = ParseZoneFilesInParallel(
+            zone_files, lint, std::min(parser_threads, static_cast<int>(zone_files.size())));
+    } else {
+        for (auto &[zone_file_path, ns, origin, format] : zone_files) {
+            if (format == ZoneFileFormat::WIRE) {
+                rr_count += ParseWireZoneFileAndExtendGraphs(zone_file_path, ns, lint);
+            } else {
+                rr_count += ParseZoneFileAndExtendGraphs(zone_file_path, ns, origin, lint, parser_threads);
+            }
+        }
     }
     Logger->info(fmt::format("Total number of RRs parsed across all zone files: {}", rr_count));
     string types_info = "";
@@ -201,11 +271,13 @@ long Driver::SetContext(const json &metadata, string directory, bool lint)
     Logger->info(fmt::format("RR Stats: {}", types_info));
     Logger->info(
         fmt::format("Label Graph: vertices = {}, edges = {}", num_vertices(label_graph_), num_edges(label_graph_)));
+    label_graph_.Freeze();
     if (lint) {
         for (auto &[id, z] : context_.zoneId_to_zone) {
             z.CheckGlueRecordsPresence(context_.zoneId_nameserver_map.at(id));
         }
     }
+    context_.IndexNameservers();
     return rr_count;
 }
 
@@ -301,7 +373,7 @@ void Driver::SetJob(const json &user_job)
             };
             current_job_.path_functions.push_back(l);
         } else if (name == "QueryRewrite") {
-            vector<vector<NodeLabel>> allowed_domains;
+            vector<DomainName> allowed_domains;
             for (string v : property["Value"]) {
                 boost::to_lower(v);
                 allowed_domains.push_back(LabelUtils::StringToLabels(v));
@@ -319,7 +391,7 @@ void Driver::SetJob(const json &user_job)
                     string(user_job["Domain"])));
             }
         } else if (name == "NameserverContact") {
-            vector<vector<NodeLabel>> allowed_domains;
+            vector<DomainName> allowed_domains;
             for (string v : property["Value"]) {
                 boost::to_lower(v);
                 allowed_domains.push_back(LabelUtils::StringToLabels(v));
@@ -340,7 +412,7 @@ void Driver::SetJob(const json &user_job)
         } else if (name == "RewriteBlackholing") {
             current_job_.path_functions.push_back(interpretation::Graph::Properties::RewriteBlackholing);
         } else if (name == "AllAliases") {
-            vector<vector<NodeLabel>> canonical_names;
+            vector<DomainName> canonical_names;
             for (string v : property["Value"]) {
                 boost::to_lower(v);
                 canonical_names.push_back(LabelUtils::StringToLabels(v));
@@ -413,7 +485,7 @@ void Driver::SetJob(string &domain_name)
     };
     current_job_.path_functions.push_back(lame_delegation);
 
-    vector<vector<NodeLabel>> allowed_domains;
+    vector<DomainName> allowed_domains;
     allowed_domains.push_back(LabelUtils::StringToLabels(domain_name));
     auto query_rewrite = [d = std::move(allowed_domains)](
                              const interpretation::Graph &graph, const interpretation::Graph::Path &p,
@@ -426,6 +498,11 @@ void Driver::SetJob(string &domain_name)
     // current_job_.check_structural_delegations = true;
 }
 
+void Driver::SetZoneCache(string directory)
+{
+    zone_cache_.emplace(directory);
+}
+
 void Driver::WriteStatsForAJob()
 {
 
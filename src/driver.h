@@ -10,11 +10,40 @@
 #include "interpretation-properties.h"
 #include "job.h"
 #include "label-graph.h"
+#include "zone-cache.h"
+#include "zone-file-decompressor.h"
 #include "zone-graph.h"
 
 using json = nlohmann::json;
 
 const int kECConsumerCount = 8;
+// Number of zone files each parser thread may have read ahead of the merge point.
+const int kZoneFileReadAheadPerThread = 2;
+// Size of the chunks a single zone file is split into when it is parsed by several threads. Files smaller than two
+// chunks are parsed by one thread.
+const size_t kZoneFileChunkSize = 1 << 22;
+// Zone files with at least this many records are added to the zone graph in bulk (zone::Graph::AddResourceRecords).
+const size_t kBulkLoadThreshold = 1 << 12;
+
+// Encoding of a zone file, given by the "Format" field of its entry in metadata.json: "text" (the default) for
+// RFC 1035 master files, "wire" for zone transfer dumps (see ZoneFileWireReader).
+enum class ZoneFileFormat { TEXT, WIRE };
+
+struct MiniContext {
+    string file_name = "";
+    bool found_SOA = false;
+    bool lint = false;
+    bool parsed_completely = false;
+    size_t lines = 0;
+    int rrs_parsed = 0;
+    std::unordered_map<string, long> type_to_count;
+    // Records added to the zone graph that are yet to be added to the label graph (in file order). Only the zones
+    // parsed on the worker pool or stored in the zone cache collect them; the serial parser adds the records to the
+    // label graph as it goes.
+    vector<tuple<ResourceRecord, zone::Graph::VertexDescriptor>> label_graph_records;
+    // Lint issues found while parsing, written out when the zone is merged into the context.
+    vector<json> lint_issues;
+};
 
 class Driver
 {
@@ -24,16 +53,67 @@ class Driver
     Context context_;
     Job current_job_;
     std::set<json> property_violations_;
-    int ParseZoneFileAndExtendGraphs(string, string, string, bool);
+    boost::optional<ZoneCache> zone_cache_;
+    int MergeZone(zone::Graph &, MiniContext &, const string &);
+    int ParseZoneFileAndExtendGraphs(string, string, string, bool, int = 1, size_t = kZoneFileChunkSize);
+    int ParseWireZoneFileAndExtendGraphs(string, string, bool);
+    long ParseZoneFilesInParallel(const vector<tuple<string, string, string, ZoneFileFormat>> &, bool, int);
+    // The parsers add the records of the zone to the label graph right away when they are given one; otherwise the
+    // records are collected in MiniContext::label_graph_records and MergeZone adds them.
+    MiniContext ParseOrLoadZoneFile(
+        string_view,
+        zone::Graph &,
+        const string &,
+        const string &,
+        bool,
+        int,
+        size_t,
+        label::Graph * = nullptr) const;
+    static MiniContext ParseCompressedZoneFile(
+        string_view,
+        ZoneFileDecompressor::Format,
+        zone::Graph &,
+        const string &,
+        const string &,
+        bool,
+        size_t = kZoneFileStreamChunkSize,
+        label::Graph * = nullptr);
+    static MiniContext ParseZoneFile(
+        string_view,
+        zone::Graph &,
+        const string &,
+        const string &,
+        bool,
+        size_t = kBulkLoadThreshold,
+        label::Graph * = nullptr);
+    static MiniContext ParseWireZoneFile(
+        string_view,
+        zone::Graph &,
+        const string &,
+        bool,
+        size_t = kBulkLoadThreshold,
+        label::Graph * = nullptr);
+    static MiniContext ParseZoneFileInChunks(
+        string_view,
+        zone::Graph &,
+        const string &,
+        const string &,
+        bool,
+        int,
+        size_t,
+        label::Graph * = nullptr);
     // void DumpNameServerZoneMap() const;
 
   public:
     friend class DriverTest;
     void GenerateECsAndCheckProperties();
     long GetECCountForCurrentJob() const;
-    long SetContext(const json &, string, bool);
+    void LoadSnapshot(string);
+    void SaveSnapshot(string) const;
+    long SetContext(const json &, string, bool, int = 1);
     void SetJob(const json &);
     void SetJob(string &);
+    void SetZoneCache(string);
     void WriteStatsForAJob();
     void WriteViolationsToFile(string) const;
 };
@@ -9,7 +9,10 @@ string ECTask::PrintTaskType()
 void ECTask::Process(const Context &context, vector<boost::any> &variadic_arguments)
 {
     Job *current_job = boost::any_cast<Job *>(variadic_arguments[0]);
-    interpretation::Graph interpretation_graph_for_ec(ec_, context);
+    // The graph belongs to the worker and is rebuilt for every EC.
+    interpretation::Graph &interpretation_graph_for_ec =
+        *boost::any_cast<interpretation::Graph *>(variadic_arguments[1]);
+    interpretation_graph_for_ec.Build(ec_, context);
     interpretation_graph_for_ec.CheckForLoops(current_job->json_queue);
     // interpretation_graph_for_ec.GenerateDotFile("InterpretationGraph.dot");
     current_job->attributes_queue.enqueue(
@@ -29,3 +29,54 @@ bool EC::operator==(const EC &q) const
     }
     return true;
 }
+
+std::size_t hash_value(const EC &ec)
+{
+    std::size_t seed = 0;
+    for (const NodeLabel &l : ec.name) {
+        boost::hash_combine(seed, l);
+    }
+    boost::hash_combine(seed, std::hash<std::bitset<RRType::N>>()(ec.rrTypes));
+    boost::hash_combine(seed, static_cast<bool>(ec.excluded));
+    return seed;
+}
+
+uint32_t ECTable::Intern(const EC &ec)
+{
+    auto &bucket = buckets_[hash_value(ec)];
+    uint32_t equivalence_class = std::numeric_limits<uint32_t>::max();
+    for (uint32_t id : bucket) {
+        const EC &e = entries_[id].ec;
+        if (e == ec) {
+            if (e.nonExistent == ec.nonExistent && e.excluded == ec.excluded) {
+                return id;
+            }
+            equivalence_class = entries_[id].equivalence_class;
+        }
+    }
+    uint32_t id = static_cast<uint32_t>(entries_.size());
+    entries_.push_back({ec, equivalence_class == std::numeric_limits<uint32_t>::max() ? id : equivalence_class});
+    bucket.push_back(id);
+    return id;
+}
+
+void ECTable::clear()
+{
+    entries_.clear();
+    buckets_.clear();
+}
+
+size_t ECTable::size() const
+{
+    return entries_.size();
+}
+
+const EC &ECTable::operator[](uint32_t id) const
+{
+    return entries_[id].ec;
+}
+
+uint32_t ECTable::get_class(uint32_t id) const
+{
+    return entries_[id].equivalence_class;
+}
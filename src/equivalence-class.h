@@ -1,6 +1,9 @@
 #ifndef EQUIVALENCE_CLASS_H
 #define EQUIVALENCE_CLASS_H
 
+#include <boost/container/small_vector.hpp>
+#include <boost/unordered_map.hpp>
+
 #include "resource-record.h"
 
 class EC
@@ -17,7 +20,7 @@ class EC
 
   public:
     boost::optional<std::vector<NodeLabel>> excluded;
-    vector<NodeLabel> name;
+    DomainName name;
     std::bitset<RRType::N> rrTypes;
     bool nonExistent = false;
 
@@ -25,4 +28,28 @@ class EC
     bool operator==(const EC &) const;
 };
 
+// Agrees with EC::operator==, so it leaves out the excluded labels and nonExistent.
+std::size_t hash_value(const EC &);
+
+// Hash-consed ECs. Every distinct EC gets a stable id, and an EC is hashed once when it is interned. Two ECs that
+// differ only in what operator== leaves out get their own ids but share a class, the id of the first of them, which is
+// what a search for an equal query has to compare.
+class ECTable
+{
+    struct Entry {
+        EC ec;
+        uint32_t equivalence_class;
+    };
+
+    vector<Entry> entries_;
+    boost::unordered_map<std::size_t, boost::container::small_vector<uint32_t, 1>> buckets_;
+
+  public:
+    uint32_t Intern(const EC &);
+    void clear();
+    size_t size() const;
+    const EC &operator[](uint32_t) const;
+    uint32_t get_class(uint32_t) const;
+};
+
 #endif
\ No newline at end of file
@@ -17,71 +17,130 @@ inline string ReturntagToString(const ReturnTag &r)
     return "";
 }
 
-template <class NSMap, class QueryMap, class AnswerMap>
-template <class Vertex>
-inline void interpretation::Graph::VertexWriter<NSMap, QueryMap, AnswerMap>::operator()(ostream &out, const Vertex &v)
-    const
+interpretation::Graph::Graph()
 {
-    auto nameServer = get(nsm, v);
-    auto query = get(qm, v);
-    auto answer = get(am, v);
-    // string label = "[label=\"NS: " + nameServer + " \\n Q: " + query.name + " T:"+ RRTypesToString(query.rrTypes) + "
-    // \\n A:";
-    string queryName = "\\n Q:";
-    if (query.excluded) {
-        queryName += "~{}.";
-    }
-    string label = "[label=\"NS: " + nameServer + queryName + LabelUtils::LabelsToString(query.name) +
-                   " T:" + TypeUtils::TypesToString(query.rrTypes) + "  \\n A:";
-    std::bitset<RRType::N> answerTypes;
-    if (answer) {
-        for (auto r : answer.get()) {
-            label += ReturntagToString(std::get<0>(r));
-        }
-    }
-    // label += RRTypesToString(answerTypes) + "\"]";
-    label += "\"]";
-    if (nameServer == "") {
-        label = label + " [shape=diamond]";
-    }
-    out << label;
 }
 
-template <class EdgeMap>
-template <class Edge>
-inline void interpretation::Graph::EdgeWriter<EdgeMap>::operator()(ostream &out, const Edge &e) const
+interpretation::Graph::Graph(const EC &query, const Context &context)
 {
-    auto type = get(wm, e);
-    if (!type) {
-        out << "[color=black]";
-    } else {
-        out << "[color=red]";
-    }
+    Build(query, context);
 }
 
-interpretation::Graph::Graph(const EC query, const Context &context)
+void interpretation::Graph::Build(const EC &query, const Context &context)
 {
+    vertices_.clear();
+    edges_.clear();
+    side_queries_.clear();
+    vertex_index_ = {};
+    queries_.clear();
+    answers_.clear();
+    arena_->Reset();
+    Arena::Scope scope(*arena_);
+    vertex_index_ = VertexIndex(ArenaAllocator<VertexIndex::value_type>(arena_.get()));
+    context_ = &context;
+
     // Add a dummy vertex as the start node over the top Name Servers
-    root_ = boost::add_vertex(*this);
-    (*this)[root_].ns = "";
-    (*this)[root_].query = query;
-    nameserver_to_vertices_map_.insert({"", std::vector<VertexDescriptor>()});
-    auto it = nameserver_to_vertices_map_.find("");
-    if (it != nameserver_to_vertices_map_.end()) {
-        it->second.push_back(root_);
-    } else {
-        Logger->critical(
-            fmt::format("interpretation-graph.cpp (Graph) - Unable to insert node into a interpretation graph"));
-        std::exit(EXIT_FAILURE);
-    }
+    root_ = AddVertex(kStartNameserver, queries_.Intern(query));
     // Logger->debug(fmt::format("interpretation-graph (Graph) Added the dummy node {}", query.ToString()));
     StartFromTopNameservers(root_, query, context);
     // cout << "Interpretation: " << num_vertices(*this) << endl;
+    // The links are looked up by their edge from now on.
+    std::sort(side_queries_.begin(), side_queries_.end(), [](const SideQueryLink &a, const SideQueryLink &b) {
+        return std::tie(a.source, a.edge) < std::tie(b.source, b.edge);
+    });
+}
+
+interpretation::Vertex interpretation::Graph::operator[](VertexDescriptor v) const
+{
+    static const boost::optional<vector<zone::LookUpAnswer>> no_answer;
+    const VertexRecord &vertex = vertices_[v];
+    return {vertex.ns, queries_[vertex.query], vertex.answer == kNone ? no_answer : answers_[vertex.answer]};
+}
+
+const string &interpretation::Graph::NameserverName(NameserverId ns) const
+{
+    return context_->nameservers[ns];
+}
+
+boost::iterator_range<const interpretation::Graph::VertexDescriptor *> interpretation::Graph::Successors(
+    VertexDescriptor v) const
+{
+    const auto &out = vertices_[v].out;
+    return {out.data(), out.data() + out.size()};
+}
+
+size_t interpretation::Graph::num_vertices() const
+{
+    return vertices_.size();
+}
+
+size_t interpretation::Graph::num_edges() const
+{
+    return edges_.size();
+}
+
+size_t interpretation::num_vertices(const Graph &graph)
+{
+    return graph.num_vertices();
+}
+
+size_t interpretation::num_edges(const Graph &graph)
+{
+    return graph.num_edges();
+}
+
+interpretation::Graph::VertexDescriptor interpretation::Graph::AddVertex(NameserverId ns, uint32_t query)
+{
+    VertexDescriptor v = static_cast<VertexDescriptor>(vertices_.size());
+    vertices_.push_back({ns, query, kNone, false, {}});
+    vertex_index_.emplace(VertexKey{ns, queries_.get_class(query)}, v);
+    return v;
+}
+
+void interpretation::Graph::AddEdge(
+    VertexDescriptor source,
+    VertexDescriptor target,
+    boost::optional<VertexDescriptor> side_query)
+{
+    VertexRecord &vertex = vertices_[source];
+    uint32_t edge = static_cast<uint32_t>(vertex.out.size());
+    vertex.out.push_back(target);
+    edges_.push_back({source, edge});
+    if (side_query) {
+        vertex.side_queries = true;
+        side_queries_.push_back({source, edge, side_query.get()});
+    }
+}
+
+boost::optional<interpretation::Graph::VertexDescriptor> interpretation::Graph::SideQueryAt(
+    VertexDescriptor source,
+    uint32_t edge) const
+{
+    if (vertices_[source].side_queries) {
+        auto link = std::lower_bound(
+            side_queries_.begin(), side_queries_.end(), std::make_pair(source, edge),
+            [](const SideQueryLink &link, const std::pair<VertexDescriptor, uint32_t> &key) {
+                return std::tie(link.source, link.edge) < std::tie(key.first, key.second);
+            });
+        if (link != side_queries_.end() && link->source == source && link->edge == edge) {
+            return link->vertex;
+        }
+    }
+    return {};
+}
+
+void interpretation::Graph::SetAnswer(VertexDescriptor v, boost::optional<vector<zone::LookUpAnswer>> answer)
+{
+    if (vertices_[v].answer == kNone) {
+        vertices_[v].answer = static_cast<uint32_t>(answers_.size());
+        answers_.emplace_back();
+    }
+    answers_[vertices_[v].answer] = std::move(answer);
 }
 
 void interpretation::Graph::CheckCnameDnameAtSameNameserver(
     VertexDescriptor &current_node,
-    const EC newQuery,
+    const EC &newQuery,
     const Context &context)
 {
     // Logger->debug(fmt::format("interpretation-graph (CheckCnameDnameAtSameNameserver) Query:{} New query:{}",
@@ -89,17 +148,18 @@ void interpretation::Graph::CheckCnameDnameAtSameNameserver(
     // first
     auto [valid, violation_label] = LabelUtils::LengthCheck(newQuery.name, 0);
     if (valid) {
-        boost::optional<int> start = GetRelevantZone((*this)[current_node].ns, newQuery, context);
+        boost::optional<int> start = GetRelevantZone(vertices_[current_node].ns, newQuery, context);
         if (start) {
             // Logger->debug(fmt::format("interpretation-graph (CheckCnameDnameAtSameNameserver) Found relevant zone
             // with id
             // {}", start.get()));
-            boost::optional<VertexDescriptor> node = InsertNode((*this)[current_node].ns, newQuery, current_node, {});
+            boost::optional<VertexDescriptor> node =
+                InsertNode(vertices_[current_node].ns, queries_.Intern(newQuery), current_node, {});
             // If there was no same query earlier to this NS then continue the querying process.
             if (node) {
                 // Logger->debug(fmt::format("interpretation-graph (CheckCnameDnameAtSameNameserver) Inserted new node
                 // with vd {}", node.get()));
-                QueryResolver(context.zoneId_to_zone.find(start.get())->second, node.get(), context);
+                QueryResolver(*context.zones[start.get()], node.get(), context);
             }
         } else {
             // Start from the top Zone file
@@ -108,123 +168,54 @@ void interpretation::Graph::CheckCnameDnameAtSameNameserver(
             StartFromTopNameservers(current_node, newQuery, context);
         }
     } else {
-        boost::optional<VertexDescriptor> node = InsertNode((*this)[current_node].ns, newQuery, current_node, {});
+        boost::optional<VertexDescriptor> node =
+            InsertNode(vertices_[current_node].ns, queries_.Intern(newQuery), current_node, {});
         if (node) {
             vector<zone::LookUpAnswer> answers = {};
-            answers.push_back(std::make_tuple(ReturnTag::YX, newQuery.rrTypes, vector<ResourceRecord>{}));
-            (*this)[node.get()].answer = std::move(answers);
+            answers.push_back(std::make_tuple(ReturnTag::YX, newQuery.rrTypes, RRSetView(), nullptr));
+            SetAnswer(node.get(), std::move(answers));
         }
     }  
 }
 
 boost::optional<interpretation::Graph::VertexDescriptor> interpretation::Graph::InsertNode(
-    string ns,
-    EC query,
+    NameserverId ns,
+    uint32_t query,
     VertexDescriptor edge_start,
     boost::optional<VertexDescriptor> edge_query)
 {
     // First checks if a node exists in the graph with NS = ns and Query = query
     // If it exists, then it add an edge from the edgeStart to found node and returns {}
     // Else Creates a new node and adds an edge and returns the new node
-    auto it = nameserver_to_vertices_map_.find(ns);
-    if (it == nameserver_to_vertices_map_.end()) {
-        nameserver_to_vertices_map_.insert({ns, std::vector<VertexDescriptor>()});
-    } else {
-        std::vector<VertexDescriptor> &existingNodes = it->second;
-        for (auto &n : existingNodes) {
-            if (query == (*this)[n].query) {
-                EdgeDescriptor e;
-                bool b;
-                /*if (edgeStart != n) {*/
-                boost::tie(e, b) = boost::add_edge(edge_start, n, *this);
-                if (!b) {
-                    Logger->critical(fmt::format(
-                        "interpretation-graph.cpp (InsertNode) - Unable to add edge to a interpretation graph"));
-                    std::exit(EXIT_FAILURE);
-                }
-                if (edge_query) {
-                    (*this)[e].intermediate_query = boost::make_optional(static_cast<int>(edge_query.get()));
-                }
-                //}
-                // Logger->debug(fmt::format("interpretation-graph (InsertNode) Found duplicate node in interpretation
-                // graph"));
-                return {};
-            }
-        }
-    }
-    it = nameserver_to_vertices_map_.find(ns);
-    if (it != nameserver_to_vertices_map_.end()) {
-        VertexDescriptor v = boost::add_vertex(*this);
-        (*this)[v].ns = ns;
-        (*this)[v].query = query;
-        // Logger->debug(fmt::format("interpretation-graph (InsertNode) Added new node with id {} to interpretation
-        // graph - ns:{}, query:{}", v, (*this)[v].ns, (*this)[v].query.ToString()));
-        EdgeDescriptor e;
-        bool b;
-        boost::tie(e, b) = boost::add_edge(edge_start, v, *this);
-        if (!b) {
-            Logger->critical(
-                fmt::format("interpretation-graph.cpp (InsertNode) - Unable to add edge to a interpretation graph"));
-            std::exit(EXIT_FAILURE);
-        }
-        if (edge_query) {
-            (*this)[e].intermediate_query = boost::make_optional(static_cast<int>(edge_query.get()));
-        }
-        it->second.push_back(v);
-        return v;
-    } else {
-        Logger->critical(
-            fmt::format("interpretation-graph.cpp (InsertNode) -Unable to insert into a nameserver_to_vertices_map_"));
-        std::exit(EXIT_FAILURE);
+    auto it = vertex_index_.find(VertexKey{ns, queries_.get_class(query)});
+    if (it != vertex_index_.end()) {
+        AddEdge(edge_start, it->second, edge_query);
+        // Logger->debug(fmt::format("interpretation-graph (InsertNode) Found duplicate node in interpretation
+        // graph"));
+        return {};
     }
+    VertexDescriptor v = AddVertex(ns, query);
+    // Logger->debug(fmt::format("interpretation-graph (InsertNode) Added new node with id {} to interpretation
+    // graph - ns:{}, query:{}", v, (*this)[v].ns, (*this)[v].query.ToString()));
+    AddEdge(edge_start, v, edge_query);
+    return v;
 }
 
-boost::optional<int> interpretation::Graph::GetRelevantZone(string ns, const EC query, const Context &context) const
+boost::optional<int> interpretation::Graph::GetRelevantZone(
+    NameserverId ns,
+    const EC &query,
+    const Context &context) const
 {
-    auto it = context.nameserver_zoneIds_map.find(ns);
-    auto queryLabels = query.name;
-    // Logger->debug(fmt::format("interpretation-graph (GetRelevantZone) TopNS {} queryLabels {}", ns,
-    // LabelUtils::LabelsToString(queryLabels)));
-    if (it != context.nameserver_zoneIds_map.end()) {
-        bool found = false;
-        int max = -1;
-        int bestMatch = 0;
-        for (auto zid : it->second) {
-            int i = 0;
-            bool valid = true;
-            // Logger->debug(fmt::format("interpretation-graph (GetRelevantZone) Searching zone with id {} and origin
-            // {}", zid, LabelUtils::LabelsToString(context.zoneId_to_zone.find(zid)->second.get_origin())));
-            for (const NodeLabel &l : context.zoneId_to_zone.find(zid)->second.get_origin()) {
-                if (i >= queryLabels.size() || l.n != queryLabels[i].n) {
-                    valid = false;
-                    break;
-                }
-                i++;
-            }
-            if (valid) {
-                // Logger->debug(fmt::format("interpretation-graph (GetRelevantZone) Found valid one with id {}", zid));
-                found = true;
-                if (i > max) {
-                    // Logger->debug(fmt::format("interpretation-graph (GetRelevantZone) Best match updated from  {} to
-                    // {}", bestMatch, zid));
-                    max = i;
-                    bestMatch = zid;
-                }
-            }
-        }
-        if (found)
-            return bestMatch;
-        else
-            return {};
-    } else {
-        return {};
-    }
+    // The zone with the longest origin that is a prefix of the query, found in the trie of the origins of the name
+    // server.
+    // Logger->debug(fmt::format("interpretation-graph (GetRelevantZone) TopNS {} queryLabels {}",
+    // context.nameservers[ns], LabelUtils::LabelsToString(query.name)));
+    return context.GetRelevantZone(ns, query.name);
 }
 
-vector<tuple<ResourceRecord, vector<ResourceRecord>>> interpretation::Graph::MatchNsGlueRecords(
-    vector<ResourceRecord> records) const
+vector<zone::NSGlue> interpretation::Graph::MatchNsGlueRecords(vector<ResourceRecord> records) const
 {
-    vector<tuple<ResourceRecord, vector<ResourceRecord>>> pairs;
+    vector<zone::NSGlue> pairs;
     for (int i = 0; i < records.size(); i++) {
         if (records[i].get_type() == RRType::NS) {
             vector<ResourceRecord> matched;
@@ -249,31 +240,30 @@ vector<tuple<ResourceRecord, vector<ResourceRecord>>> interpretation::Graph::Mat
 
 void interpretation::Graph::NsSubRoutine(
     const VertexDescriptor &current_vertex,
-    const string &new_ns,
+    NameserverId new_ns,
     boost::optional<VertexDescriptor> edge_query,
     const Context &context)
 {
     boost::optional<VertexDescriptor> node =
-        InsertNode(new_ns, (*this)[current_vertex].query, current_vertex, edge_query);
+        InsertNode(new_ns, vertices_[current_vertex].query, current_vertex, edge_query);
     if (node) {
-        auto it = context.nameserver_zoneIds_map.find(new_ns);
-        if (it != context.nameserver_zoneIds_map.end()) {
+        if (!context.nameserver_zones[new_ns].empty()) {
             boost::optional<int> start = GetRelevantZone(new_ns, (*this)[current_vertex].query, context);
             if (start) {
-                QueryResolver(context.zoneId_to_zone.find(start.get())->second, node.get(), context);
+                QueryResolver(*context.zones[start.get()], node.get(), context);
             } else {
                 // Path terminates - No relevant zone file available from the NS.
                 vector<zone::LookUpAnswer> answer;
                 answer.push_back(
-                    std::make_tuple(ReturnTag::REFUSED, (*this)[node.get()].query.rrTypes, vector<ResourceRecord>{}));
-                (*this)[node.get()].answer = answer;
+                    std::make_tuple(ReturnTag::REFUSED, (*this)[node.get()].query.rrTypes, RRSetView(), nullptr));
+                SetAnswer(node.get(), std::move(answer));
             }
         } else {
             // Path terminates -  The newNS not found.
             vector<zone::LookUpAnswer> answer;
             answer.push_back(
-                std::make_tuple(ReturnTag::NSNOTFOUND, (*this)[node.get()].query.rrTypes, vector<ResourceRecord>{}));
-            (*this)[node.get()].answer = answer;
+                std::make_tuple(ReturnTag::NSNOTFOUND, (*this)[node.get()].query.rrTypes, RRSetView(), nullptr));
+            SetAnswer(node.get(), std::move(answer));
         }
     }
 }
@@ -298,7 +288,7 @@ void interpretation::Graph::PrettyPrintLoop(
     tmp["Loop"] = {};
     for (auto &v : loop) {
         json node;
-        node["NS"] = (*this)[v].ns;
+        node["NS"] = NameserverName((*this)[v].ns);
         node["Query"] = (*this)[v].query.ToString();
         if ((*this)[v].answer) {
             node["AnswerTag"] = std::get<0>((*this)[v].answer.get()[0]);
@@ -308,16 +298,16 @@ void interpretation::Graph::PrettyPrintLoop(
     json_queue.enqueue(tmp);
 }
 
-EC interpretation::Graph::ProcessCname(const ResourceRecord &record, const EC query) const
+EC interpretation::Graph::ProcessCname(const ResourceRecord &record, const EC &query) const
 {
     EC new_query;
     new_query.rrTypes = query.rrTypes;
     new_query.rrTypes.reset(RRType::CNAME);
-    new_query.name = LabelUtils::StringToLabels(record.get_rdata());
+    new_query.name = record.get_target();
     return new_query;
 }
 
-EC interpretation::Graph::ProcessDname(const ResourceRecord &record, const EC query) const
+EC interpretation::Graph::ProcessDname(const ResourceRecord &record, const EC &query) const
 {
     int i = 0;
     for (auto &l : record.get_name()) {
@@ -328,8 +318,8 @@ EC interpretation::Graph::ProcessDname(const ResourceRecord &record, const EC qu
         }
         i++;
     }
-    vector<NodeLabel> rdata_labels = LabelUtils::StringToLabels(record.get_rdata());
-    vector<NodeLabel> name_labels = query.name;
+    DomainName rdata_labels = record.get_target();
+    const DomainName &name_labels = query.name;
     for (; i < name_labels.size(); i++) {
         rdata_labels.push_back(name_labels[i]);
     }
@@ -348,7 +338,7 @@ void interpretation::Graph::QueryResolver(
     // Logger->debug(fmt::format("interpretation-graph (QueryResolver) Query:{} look up at zone with origin-{}",
     // (*this)[current_vertex].query.ToString(), LabelUtils::LabelsToString(z.get_origin())));
     bool complete_match = false;
-    (*this)[current_vertex].answer = z.QueryLookUpAtZone((*this)[current_vertex].query, complete_match);
+    SetAnswer(current_vertex, z.QueryLookUpAtZone((*this)[current_vertex].query, complete_match));
     if ((*this)[current_vertex].answer) {
         vector<zone::LookUpAnswer> zone_lookup_answers = (*this)[current_vertex].answer.get();
         if (zone_lookup_answers.size() > 0) {
@@ -359,7 +349,7 @@ void interpretation::Graph::QueryResolver(
                 } else if (ret == ReturnTag::NX) {
                     // Non-existent domain or Type not found Case
                 } else if (ret == ReturnTag::REWRITE) {
-                    ResourceRecord &record = std::get<2>(answer)[0];
+                    const ResourceRecord &record = std::get<2>(answer).front();
                     // It will always be of size 1
                     // CNAME Case
                     if (record.get_type() == RRType::CNAME) {
@@ -377,21 +367,30 @@ void interpretation::Graph::QueryResolver(
                         CheckCnameDnameAtSameNameserver(current_vertex, new_query, context);
                     }
                 } else if (ret == ReturnTag::REF) {
-                    // Referral to other NS case.
-                    vector<tuple<ResourceRecord, vector<ResourceRecord>>> pairs =
-                        MatchNsGlueRecords(std::get<2>(answer));
-                    for (auto &pair : pairs) {
-                        string new_ns = std::get<0>(pair).get_rdata();
-                        vector<ResourceRecord> glueRecords = std::get<1>(pair);
+                    // Referral to other NS case. An indexed zone has the NS records of the cut already paired with
+                    // their glue.
+                    const zone::Referral *referral = std::get<3>(answer);
+                    vector<zone::NSGlue> matched;
+                    if (!referral) {
+                        matched = MatchNsGlueRecords(std::get<2>(answer).ToVector());
+                    }
+                    for (auto &pair : referral ? referral->pairs : matched) {
+                        boost::optional<NameserverId> id = context.GetNameserverId(std::get<0>(pair));
+                        if (!id) {
+                            Logger->error(fmt::format(
+                                "interpretation-graph.cpp (QueryResolver) - The name server {} was not indexed",
+                                std::get<0>(pair).get_rdata()));
+                            continue;
+                        }
+                        NameserverId new_ns = id.get();
+                        const vector<ResourceRecord> &glueRecords = std::get<1>(pair);
                         // Either the Glue records have to exist or the referral to a topNameServer
-                        if (glueRecords.size() ||
-                            (std::find(context.top_nameservers.begin(), context.top_nameservers.end(), new_ns) !=
-                             context.top_nameservers.end())) {
+                        if (glueRecords.size() || context.top_nameserver_set[new_ns]) {
                             NsSubRoutine(current_vertex, new_ns, {}, context);
                         } else {
                             // Have to query for the IP address of NS
                             EC ns_query;
-                            ns_query.name = LabelUtils::StringToLabels(new_ns);
+                            ns_query.name = std::get<0>(pair).get_target();
                             ns_query.rrTypes[RRType::A] = 1;
                             ns_query.rrTypes[RRType::AAAA] = 1;
                             VertexDescriptor nsStart = SideQuery(ns_query, context);
@@ -416,55 +415,40 @@ void interpretation::Graph::QueryResolver(
     }
 }
 
-interpretation::Graph::VertexDescriptor interpretation::Graph::SideQuery(const EC query, const Context &context)
+interpretation::Graph::VertexDescriptor interpretation::Graph::SideQuery(const EC &query, const Context &context)
 {
-    auto it = nameserver_to_vertices_map_.find("");
-    if (it == nameserver_to_vertices_map_.end()) {
-        nameserver_to_vertices_map_.insert({"", std::vector<VertexDescriptor>()});
-    } else {
-        std::vector<VertexDescriptor> &existingNodes = it->second;
-        for (auto &n : existingNodes) {
-            if (query == (*this)[n].query) {
-                return n;
-            }
-        }
+    uint32_t id = queries_.Intern(query);
+    auto it = vertex_index_.find(VertexKey{0, queries_.get_class(id)});
+    if (it != vertex_index_.end()) {
+        return it->second;
     }
     // Add a dummy vertex as the start node over the top Name Servers
-    VertexDescriptor dummy = boost::add_vertex(*this);
-    (*this)[dummy].ns = "";
-    (*this)[dummy].query = query;
-    it = nameserver_to_vertices_map_.find("");
-    if (it != nameserver_to_vertices_map_.end()) {
-        it->second.push_back(dummy);
-    } else {
-        Logger->critical(
-            fmt::format("interpretation-graph.cpp (SideQuery) - Unable to insert into a nameserver_to_vertices_map_"));
-        std::exit(EXIT_FAILURE);
-    }
+    VertexDescriptor dummy = AddVertex(kStartNameserver, id);
     StartFromTopNameservers(dummy, query, context);
     return dummy;
 }
 
 void interpretation::Graph::StartFromTopNameservers(
     VertexDescriptor edge_start_node,
-    const EC query,
+    const EC &query,
     const Context &context)
 {
-    for (string ns : context.top_nameservers) {
+    uint32_t id = queries_.Intern(query);
+    for (NameserverId ns : context.top_nameserver_ids) {
         // ns exists in the database.
         // Logger->debug(fmt::format("interpretation-graph (StartFromTopNameservers) Starting with TopNS {} for {}", ns,
         // query.ToString()));
         boost::optional<int> start = GetRelevantZone(ns, query, context);
-        boost::optional<VertexDescriptor> node = InsertNode(ns, query, edge_start_node, {});
+        boost::optional<VertexDescriptor> node = InsertNode(ns, id, edge_start_node, {});
         if (start && node) {
             // Logger->debug(fmt::format("interpretation-graph (StartFromTopNameservers) Before calling
             // QueryResolver"));
-            QueryResolver(context.zoneId_to_zone.find(start.get())->second, node.get(), context);
+            QueryResolver(*context.zones[start.get()], node.get(), context);
         } else if (node && !start) {
             vector<zone::LookUpAnswer> answer;
             answer.push_back(
-                std::make_tuple(ReturnTag::REFUSED, (*this)[node.get()].query.rrTypes, vector<ResourceRecord>{}));
-            (*this)[node.get()].answer = answer;
+                std::make_tuple(ReturnTag::REFUSED, (*this)[node.get()].query.rrTypes, RRSetView(), nullptr));
+            SetAnswer(node.get(), std::move(answer));
             // Logger->debug(fmt::format("interpretation-graph (StartFromTopNameservers) No relevant zone found and
             // answer is updated to REFUSED"));
         }
@@ -490,12 +474,14 @@ bool interpretation::Graph::CheckForLoops(
         }
     }
     p.push_back(current_vertex);
-    for (EdgeDescriptor edge : boost::make_iterator_range(out_edges(current_vertex, *this))) {
-        if ((*this)[edge].intermediate_query) {
-            if (CheckForLoops((*this)[edge].intermediate_query.get(), p, json_queue))
+    const auto &out = vertices_[current_vertex].out;
+    for (uint32_t edge = 0; edge < out.size(); edge++) {
+        boost::optional<VertexDescriptor> side_query = SideQueryAt(current_vertex, edge);
+        if (side_query) {
+            if (CheckForLoops(side_query.get(), p, json_queue))
                 return true;
         }
-        if (CheckForLoops(edge.m_target, p, json_queue))
+        if (CheckForLoops(out[edge], p, json_queue))
             return true;
     }
     return false;
@@ -526,12 +512,12 @@ void interpretation::Graph::EnumeratePathsAndReturnEndNodes(
     moodycamel::ConcurrentQueue<json> &json_queue) const
 {
     const EC &query = (*this)[current_vertex].query;
-    if ((*this)[current_vertex].ns != "") {
+    if ((*this)[current_vertex].ns != kStartNameserver) {
         // If the returnTag is a AnsQ (along with record being CNAME) and request type contains CNAME then the path ends
         // here for CNAME and this node is a leaf node with respect to t = CNAME.
         if ((*this)[current_vertex].answer && (*this)[current_vertex].answer.get().size() > 0) {
             if (std::get<0>((*this)[current_vertex].answer.get()[0]) == ReturnTag::REWRITE &&
-                std::get<2>((*this)[current_vertex].answer.get()[0])[0].get_type() == RRType::CNAME &&
+                std::get<2>((*this)[current_vertex].answer.get()[0]).front().get_type() == RRType::CNAME &&
                 query.rrTypes[RRType::CNAME]) {
                 if (end_nodes.end() == std::find(end_nodes.begin(), end_nodes.end(), current_vertex)) {
                     end_nodes.push_back(current_vertex);
@@ -556,11 +542,11 @@ void interpretation::Graph::EnumeratePathsAndReturnEndNodes(
         }
     }
     p.push_back(current_vertex);
-    for (EdgeDescriptor edge : boost::make_iterator_range(out_edges(current_vertex, *this))) {
+    for (VertexDescriptor next : Successors(current_vertex)) {
         // TODO : Edges that have side query
-        EnumeratePathsAndReturnEndNodes(edge.m_target, end_nodes, p, path_functions, json_queue);
+        EnumeratePathsAndReturnEndNodes(next, end_nodes, p, path_functions, json_queue);
     }
-    if (out_degree(current_vertex, *this) == 0) {
+    if (vertices_[current_vertex].out.empty()) {
         // Last node in the graph
         if (end_nodes.end() == std::find(end_nodes.begin(), end_nodes.end(), current_vertex)) {
             end_nodes.push_back(current_vertex);
@@ -574,11 +560,32 @@ void interpretation::Graph::EnumeratePathsAndReturnEndNodes(
 
 void interpretation::Graph::GenerateDotFile(const string output_file) const
 {
+    // The same layout as boost::write_graphviz: the vertices in order and then the edges in the order they were added.
     std::ofstream dotfile(output_file);
-    write_graphviz(
-        dotfile, *this,
-        MakeVertexWriter(
-            boost::get(&interpretation::Vertex::ns, *this), boost::get(&interpretation::Vertex::query, *this),
-            boost::get(&interpretation::Vertex::answer, *this)),
-        MakeEdgeWriter(boost::get(&interpretation::Edge::intermediate_query, *this)));
+    dotfile << "digraph G {\n";
+    for (VertexDescriptor v = 0; v < vertices_.size(); v++) {
+        const Vertex vertex = (*this)[v];
+        string queryName = "\\n Q:";
+        if (vertex.query.excluded) {
+            queryName += "~{}.";
+        }
+        string label = "[label=\"NS: " + NameserverName(vertex.ns) + queryName +
+                       LabelUtils::LabelsToString(vertex.query.name) +
+                       " T:" + TypeUtils::TypesToString(vertex.query.rrTypes) + "  \\n A:";
+        if (vertex.answer) {
+            for (auto &r : vertex.answer.get()) {
+                label += ReturntagToString(std::get<0>(r));
+            }
+        }
+        label += "\"]";
+        if (vertex.ns == kStartNameserver) {
+            label = label + " [shape=diamond]";
+        }
+        dotfile << v << label << ";\n";
+    }
+    for (auto &edge : edges_) {
+        dotfile << edge.source << "->" << vertices_[edge.source].out[edge.edge] << " ";
+        dotfile << (SideQueryAt(edge.source, edge.edge) ? "[color=red]" : "[color=black]") << ";\n";
+    }
+    dotfile << "}\n";
 }
@@ -4,6 +4,7 @@
 #include <nlohmann/json.hpp>
 
 #include "../concurrentqueue/concurrentqueue.h"
+#include "arena.h"
 #include "context.h"
 #include "equivalence-class.h"
 #include "utils.h"
@@ -14,37 +15,21 @@ using json = nlohmann::json;
 namespace interpretation
 {
 
+// A vertex of the graph as the properties see it. The name server is an id in the context; Graph::NameserverName
+// gives its name for the output.
 struct Vertex {
-    std::string ns;
-    EC query;
-    boost::optional<vector<zone::LookUpAnswer>> answer;
-   
-  private:
-    friend class boost::serialization::access;
-    template <typename Archive> void serialize(Archive &ar, const unsigned int version)
-    {
-        ar &ns;
-        ar &query;
-        ar &answer;
-    }
-};
-
-struct Edge {
-    boost::optional<int> intermediate_query;
-
-  private:
-    friend class boost::serialization::access;
-    template <typename Archive> void serialize(Archive &ar, const unsigned int version)
-    {
-        ar &intermediate_query;
-    }
+    NameserverId ns;
+    const EC &query;
+    const boost::optional<vector<zone::LookUpAnswer>> &answer;
 };
 
-class Graph : public boost::adjacency_list<boost::vecS, boost::vecS, boost::bidirectionalS, Vertex, Edge>
+// The resolution DAG of an EC. Every vertex is a query sent to a name server and the edges lead to the queries that
+// follow from its answer. A side query edge also records the vertex where the side query for the address of a name
+// server started. Only the forward edges are kept, as the traversals never walk an edge backwards.
+class Graph
 {
   public:
-    using VertexDescriptor = boost::graph_traits<Graph>::vertex_descriptor;
-    using EdgeDescriptor = boost::graph_traits<Graph>::edge_descriptor;
+    using VertexDescriptor = uint32_t;
     using Path = vector<VertexDescriptor>;
     using NodeFunction =
         std::function<void(const Graph &, const vector<VertexDescriptor> &, moodycamel::ConcurrentQueue<json> &)>;
@@ -52,48 +37,59 @@ class Graph : public boost::adjacency_list<boost::vecS, boost::vecS, boost::bidi
     using Attributes = std::tuple<int, int>;
 
   private:
-    template <class NSMap, class QueryMap, class AnswerMap> class VertexWriter
-    {
-      public:
-        VertexWriter(NSMap ns, QueryMap q, AnswerMap a) : nsm(ns), qm(q), am(a)
-        {
-        }
-        template <class Vertex> void operator()(ostream &out, const Vertex &v) const;
-
-      private:
-        NSMap nsm;
-        QueryMap qm;
-        AnswerMap am;
+    static constexpr uint32_t kNone = std::numeric_limits<uint32_t>::max();
+
+    // The name server of a vertex is its id in the context and the query and answer are ids into the tables of the
+    // graph. The targets of the out edges are stored inline up to two of them, and side_queries is set if a side query
+    // starts at one of the edges.
+    struct VertexRecord {
+        NameserverId ns;
+        uint32_t query;
+        uint32_t answer;
+        bool side_queries;
+        boost::container::small_vector<VertexDescriptor, 2, ArenaAllocator<VertexDescriptor>> out;
     };
-
-    template <class NSMap, class QueryMap, class AnswerMap>
-    inline VertexWriter<NSMap, QueryMap, AnswerMap> MakeVertexWriter(NSMap ns, QueryMap q, AnswerMap a) const
-    {
-        return VertexWriter<NSMap, QueryMap, AnswerMap>(ns, q, a);
-    }
-
-    template <class EdgeMap> class EdgeWriter
-    {
-      public:
-        EdgeWriter(EdgeMap w) : wm(w)
-        {
-        }
-        template <class Edge> void operator()(ostream &out, const Edge &e) const;
-
-      private:
-        EdgeMap wm;
+    // The edge at position edge in the out edges of source and the vertex its side query starts at. Build sorts them
+    // by edge so that SideQueryAt can use a binary search.
+    struct SideQueryLink {
+        VertexDescriptor source;
+        uint32_t edge;
+        VertexDescriptor vertex;
+    };
+    // An edge as the position in the out edges of its source, for listing the edges in the order they were added.
+    struct EdgeRef {
+        VertexDescriptor source;
+        uint32_t edge;
     };
 
-    template <class EdgeMap> inline EdgeWriter<EdgeMap> MakeEdgeWriter(EdgeMap w) const
-    {
-        return EdgeWriter<EdgeMap>(w);
-    }
-
-    Graph();
+    // The vertex of a name server and the class of a query in queries_.
+    using VertexKey = std::pair<NameserverId, uint32_t>;
+    using VertexIndex = boost::unordered_map<
+        VertexKey,
+        VertexDescriptor,
+        boost::hash<VertexKey>,
+        std::equal_to<VertexKey>,
+        ArenaAllocator<std::pair<const VertexKey, VertexDescriptor>>>;
+
+    // The out edges and the vertex index are allocated from the arena while the graph is built, and the arena is reset
+    // when the graph is built again; it is declared first so that it is destroyed last. The other tables are not in it
+    // but keep their capacity from one build to the next.
+    std::unique_ptr<Arena> arena_ = std::make_unique<Arena>();
     VertexDescriptor root_ = 0;
-    boost::unordered_map<string, vector<VertexDescriptor>> nameserver_to_vertices_map_;
-
-    void CheckCnameDnameAtSameNameserver(VertexDescriptor &, const EC, const Context &);
+    vector<VertexRecord> vertices_;
+    vector<EdgeRef> edges_;
+    vector<SideQueryLink> side_queries_;
+    // The context the graph was built in, which names the name servers.
+    const Context *context_ = nullptr;
+    VertexIndex vertex_index_;
+    ECTable queries_;
+    vector<boost::optional<vector<zone::LookUpAnswer>>> answers_;
+
+    VertexDescriptor AddVertex(NameserverId, uint32_t);
+    void AddEdge(VertexDescriptor, VertexDescriptor, boost::optional<VertexDescriptor>);
+    boost::optional<VertexDescriptor> SideQueryAt(VertexDescriptor, uint32_t) const;
+    void SetAnswer(VertexDescriptor, boost::optional<vector<zone::LookUpAnswer>>);
+    void CheckCnameDnameAtSameNameserver(VertexDescriptor &, const EC &, const Context &);
     bool CheckForLoops(VertexDescriptor, Path, moodycamel::ConcurrentQueue<json> &) const;
     void EnumeratePathsAndReturnEndNodes(
         VertexDescriptor,
@@ -101,23 +97,27 @@ class Graph : public boost::adjacency_list<boost::vecS, boost::vecS, boost::bidi
         Path,
         const vector<interpretation::Graph::PathFunction> &,
         moodycamel::ConcurrentQueue<json> &) const;
-    boost::optional<VertexDescriptor> InsertNode(string, EC, VertexDescriptor, boost::optional<VertexDescriptor>);
-    boost::optional<int> GetRelevantZone(string, const EC, const Context &) const;
-    vector<tuple<ResourceRecord, vector<ResourceRecord>>> MatchNsGlueRecords(vector<ResourceRecord> records) const;
-    void NsSubRoutine(const VertexDescriptor &, const string &, boost::optional<VertexDescriptor>, const Context &);
+    boost::optional<VertexDescriptor> InsertNode(
+        NameserverId,
+        uint32_t,
+        VertexDescriptor,
+        boost::optional<VertexDescriptor>);
+    boost::optional<int> GetRelevantZone(NameserverId, const EC &, const Context &) const;
+    vector<zone::NSGlue> MatchNsGlueRecords(vector<ResourceRecord> records) const;
+    void NsSubRoutine(const VertexDescriptor &, NameserverId, boost::optional<VertexDescriptor>, const Context &);
     void PrettyPrintLoop(const VertexDescriptor &, Path, moodycamel::ConcurrentQueue<json> &) const;
-    EC ProcessCname(const ResourceRecord &, const EC) const;
-    EC ProcessDname(const ResourceRecord &, const EC) const;
+    EC ProcessCname(const ResourceRecord &, const EC &) const;
+    EC ProcessDname(const ResourceRecord &, const EC &) const;
     void QueryResolver(const zone::Graph &, VertexDescriptor &, const Context &);
-    VertexDescriptor SideQuery(const EC, const Context &);
-    void StartFromTopNameservers(VertexDescriptor, const EC, const Context &);
+    VertexDescriptor SideQuery(const EC &, const Context &);
+    void StartFromTopNameservers(VertexDescriptor, const EC &, const Context &);
 
   public:
     class Properties
     {
 
       private:
-        static tuple<vector<ResourceRecord>, vector<ResourceRecord>> GetNSGlueRecords(const vector<ResourceRecord> &);
+        static tuple<vector<ResourceRecord>, vector<ResourceRecord>> GetNSGlueRecords(const RRSetView &);
         static void PrettyPrintResponseValue(
             set<string>,
             set<string> &,
@@ -154,7 +154,7 @@ class Graph : public boost::adjacency_list<boost::vecS, boost::vecS, boost::bidi
             const interpretation::Graph &,
             const Path &,
             moodycamel::ConcurrentQueue<json> &,
-            vector<vector<NodeLabel>>);
+            vector<DomainName>);
         static void CheckDelegationConsistency(
             const interpretation::Graph &,
             const Path &,
@@ -175,7 +175,7 @@ class Graph : public boost::adjacency_list<boost::vecS, boost::vecS, boost::bidi
             const interpretation::Graph &,
             const Path &,
             moodycamel::ConcurrentQueue<json> &,
-            vector<vector<NodeLabel>>);
+            vector<DomainName>);
         static void NumberOfHops(const interpretation::Graph &, const Path &, moodycamel::ConcurrentQueue<json> &, int);
         static void NumberOfRewrites(
             const interpretation::Graph &,
@@ -186,7 +186,7 @@ class Graph : public boost::adjacency_list<boost::vecS, boost::vecS, boost::bidi
             const interpretation::Graph &,
             const Path &,
             moodycamel::ConcurrentQueue<json> &,
-            vector<vector<NodeLabel>>);
+            vector<DomainName>);
         static void RewriteBlackholing(
             const interpretation::Graph &,
             const Path &,
@@ -199,8 +199,22 @@ class Graph : public boost::adjacency_list<boost::vecS, boost::vecS, boost::bidi
         const vector<interpretation::Graph::NodeFunction> &,
         moodycamel::ConcurrentQueue<json> &) const;
     void GenerateDotFile(const string) const;
-    Graph(const EC, const Context &);
+    // Builds the graph of the EC, replacing the graph built before. A worker reuses one graph for all its ECs.
+    void Build(const EC &, const Context &);
+    Graph();
+    Graph(const EC &, const Context &);
+    Graph(const Graph &) = delete;
+    Graph &operator=(const Graph &) = delete;
+
+    Vertex operator[](VertexDescriptor) const;
+    const string &NameserverName(NameserverId) const;
+    boost::iterator_range<const VertexDescriptor *> Successors(VertexDescriptor) const;
+    size_t num_vertices() const;
+    size_t num_edges() const;
 };
+
+size_t num_vertices(const Graph &);
+size_t num_edges(const Graph &);
 } // namespace interpretation
 
 #endif
\ No newline at end of file
@@ -3,6 +3,25 @@
 #include "structural-task.h"
 #include "utils.h"
 
+namespace
+{
+
+const uint32_t kNoVertex = std::numeric_limits<uint32_t>::max();
+
+// Hash of a name extended by one more label below it; the root hashes to 0.
+uint64_t ExtendNameHash(uint64_t hash, const NodeLabel &label)
+{
+    hash ^= label.id + 0x9e3779b97f4a7c15ULL + (hash << 6) + (hash >> 2);
+    return hash * 0xbf58476d1ce4e5b9ULL;
+}
+
+size_t NameSlotIndex(uint64_t hash, size_t mask)
+{
+    return static_cast<size_t>(hash ^ (hash >> 31)) & mask;
+}
+
+} // namespace
+
 label::Graph::Graph()
 {
     root_ = boost::add_vertex(*this);
@@ -20,9 +39,112 @@ void label::Graph::ConstructChildLabelsToVertexDescriptorMap(VertexDescriptor no
     vertex_to_child_map_.insert({node, std::move(m)});
 }
 
+void label::Graph::ConstructChildLabelsToVertexDescriptorMaps()
+{
+    // A loaded graph has no child maps yet; give one to each node with more than kHashMapThreshold children.
+    for (VertexDescriptor v : boost::make_iterator_range(vertices(*this))) {
+        if (out_degree(v, *this) > kHashMapThreshold) {
+            ConstructChildLabelsToVertexDescriptorMap(v);
+        }
+    }
+}
+
+void label::Graph::Freeze()
+{
+    if (is_frozen_) {
+        return;
+    }
+    size_t n = num_vertices(*this);
+    if (n >= std::numeric_limits<uint32_t>::max() || num_edges(*this) >= std::numeric_limits<uint32_t>::max()) {
+        Logger->critical(
+            fmt::format("label-graph.cpp (Freeze) - The label graph is too large to be laid out in 32 bits"));
+        exit(EXIT_FAILURE);
+    }
+    frozen_.names.resize(n);
+    frozen_.children.Build(*this, [this](EdgeDescriptor edge) { return (*this)[edge].type == normal; });
+    frozen_.dname_offsets.assign(n + 1, 0);
+    frozen_.zone_offsets.assign(n + 1, 0);
+    frozen_.path_lengths.assign(n, -1);
+    for (VertexDescriptor v : boost::make_iterator_range(vertices(*this))) {
+        frozen_.names[v] = (*this)[v].name;
+        frozen_.dname_offsets[v + 1] = frozen_.dname_offsets[v];
+        for (EdgeDescriptor edge : boost::make_iterator_range(out_edges(v, *this))) {
+            if ((*this)[edge].type == dname) {
+                frozen_.dname_offsets[v + 1]++;
+            }
+        }
+        frozen_.zone_offsets[v + 1] = frozen_.zone_offsets[v] + (*this)[v].zoneId_vertexId.size();
+    }
+    frozen_.dname_targets.resize(frozen_.dname_offsets[n]);
+    frozen_.zones.resize(frozen_.zone_offsets[n]);
+    for (VertexDescriptor v : boost::make_iterator_range(vertices(*this))) {
+        uint32_t next = frozen_.dname_offsets[v];
+        for (EdgeDescriptor edge : boost::make_iterator_range(out_edges(v, *this))) {
+            if ((*this)[edge].type == dname) {
+                frozen_.dname_targets[next++] = static_cast<uint32_t>(edge.m_target);
+            }
+        }
+        // The zone lists are only read from here on, so they are moved rather than copied.
+        auto &zoneId_vertexId = (*this)[v].zoneId_vertexId;
+        std::move(zoneId_vertexId.begin(), zoneId_vertexId.end(), frozen_.zones.begin() + frozen_.zone_offsets[v]);
+        std::vector<ZoneVertex>().swap(zoneId_vertexId);
+    }
+    // Hash the name of every vertex top down for LongestExistingName.
+    frozen_.parents.assign(n, kNoVertex);
+    frozen_.dname_on_path.assign(n, false);
+    size_t table_size = 1;
+    while (table_size < 2 * n) {
+        table_size <<= 1;
+    }
+    frozen_.name_table.assign(table_size, NameSlot{0, kNoVertex});
+    vector<std::pair<uint32_t, uint64_t>> stack{{static_cast<uint32_t>(root_), 0}};
+    while (!stack.empty()) {
+        auto [v, hash] = stack.back();
+        stack.pop_back();
+        bool dname_at_v = frozen_.dname_offsets[v + 1] != frozen_.dname_offsets[v];
+        frozen_.dname_on_path[v] = dname_at_v || (v != root_ && frozen_.dname_on_path[frozen_.parents[v]]);
+        size_t slot = NameSlotIndex(hash, table_size - 1);
+        while (frozen_.name_table[slot].vertex != kNoVertex) {
+            slot = (slot + 1) & (table_size - 1);
+        }
+        frozen_.name_table[slot] = NameSlot{hash, v};
+        for (const ChildIndex::Child &child : frozen_.children.Children(v)) {
+            frozen_.parents[child.vertex] = v;
+            stack.push_back({child.vertex, ExtendNameHash(hash, child.label)});
+        }
+    }
+    // The child index replaces the hash maps of the nodes with many children.
+    vertex_to_child_map_.clear();
+    is_frozen_ = true;
+}
+
+void label::Graph::Thaw()
+{
+    if (!is_frozen_) {
+        return;
+    }
+    for (VertexDescriptor v : boost::make_iterator_range(vertices(*this))) {
+        (*this)[v].zoneId_vertexId.assign(
+            frozen_.zones.begin() + frozen_.zone_offsets[v], frozen_.zones.begin() + frozen_.zone_offsets[v + 1]);
+    }
+    frozen_ = FrozenGraph{};
+    is_frozen_ = false;
+    ConstructChildLabelsToVertexDescriptorMaps();
+}
+
+boost::iterator_range<const label::Graph::ZoneVertex *> label::Graph::ZoneVertices(VertexDescriptor node) const
+{
+    if (is_frozen_) {
+        const ZoneVertex *zones = frozen_.zones.data();
+        return {zones + frozen_.zone_offsets[node], zones + frozen_.zone_offsets[node + 1]};
+    }
+    const auto &zoneId_vertexId = (*this)[node].zoneId_vertexId;
+    return {zoneId_vertexId.data(), zoneId_vertexId.data() + zoneId_vertexId.size()};
+}
+
 label::Graph::VertexDescriptor label::Graph::GetAncestor(
     label::Graph::VertexDescriptor closest_encloser,
-    const vector<NodeLabel> &labels,
+    const DomainName &labels,
     vector<VertexDescriptor> &vertices_to_create_maps,
     int &index) const
 {
@@ -67,7 +189,7 @@ label::Graph::VertexDescriptor label::Graph::GetAncestor(
     exit(EXIT_FAILURE);
 } */
 
-void label::Graph::NodeEC(const vector<NodeLabel> &name, Job &current_job) const
+void label::Graph::NodeEC(const DomainName &name, Job &current_job) const
 {
     unique_ptr<ECTask> present = make_unique<ECTask>();
     present->ec_.name = name;
@@ -79,7 +201,7 @@ void label::Graph::NodeEC(const vector<NodeLabel> &name, Job &current_job) const
 
 label::Graph::VertexDescriptor label::Graph::AddNodes(
     label::Graph::VertexDescriptor closest_encloser,
-    const vector<NodeLabel> &labels,
+    const DomainName &labels,
     int &index)
 {
 
@@ -110,52 +232,108 @@ void label::Graph::AddResourceRecord(
     zone::Graph::VertexDescriptor zone_vertexId)
 {
     if (record.get_type() != RRType::N) {
+        Thaw();
         int index = 0;
-        vector<NodeLabel> name_labels = record.get_name();
+        const DomainName &name_labels = record.get_name();
         vector<VertexDescriptor> vertices_to_create_maps{};
         VertexDescriptor closest_encloser = GetAncestor(root_, name_labels, vertices_to_create_maps, index);
         for (auto &v : vertices_to_create_maps) {
             ConstructChildLabelsToVertexDescriptorMap(v);
         }
-        vertices_to_create_maps.clear();
         VertexDescriptor main_node = AddNodes(closest_encloser, name_labels, index);
-        if (record.get_type() == RRType::DNAME) {
-            vector<NodeLabel> labels = LabelUtils::StringToLabels(record.get_rdata());
-            index = 0;
-            closest_encloser = GetAncestor(root_, labels, vertices_to_create_maps, index);
-            for (auto &v : vertices_to_create_maps) {
-                ConstructChildLabelsToVertexDescriptorMap(v);
+        AddResourceRecordAtNode(main_node, record, zoneId, zone_vertexId);
+    }
+}
+
+void label::Graph::AddResourceRecords(
+    const vector<tuple<ResourceRecord, zone::Graph::VertexDescriptor>> &records,
+    const int &zoneId,
+    const zone::Graph &zone_graph)
+{
+    // The owner of every record is a vertex of the zone graph, so the label graph node of each zone vertex is found
+    // once, as a child of the node of its parent, instead of walking down from the root for every record. The nodes
+    // are created in the same order as with AddResourceRecord.
+    Thaw();
+    size_t zone_vertices = num_vertices(zone_graph);
+    vector<boost::optional<zone::Graph::VertexDescriptor>> zone_parent(zone_vertices);
+    for (auto v : boost::make_iterator_range(vertices(zone_graph))) {
+        for (auto u : boost::make_iterator_range(adjacent_vertices(v, zone_graph))) {
+            zone_parent[u] = v;
+        }
+    }
+    vector<boost::optional<VertexDescriptor>> label_node(zone_vertices);
+    vector<zone::Graph::VertexDescriptor> unresolved;
+    vector<VertexDescriptor> vertices_to_create_maps{};
+    for (auto &[record, zone_vertexId] : records) {
+        if (record.get_type() == RRType::N) {
+            continue;
+        }
+        for (auto v = zone_vertexId; !label_node[v]; v = zone_parent[v].get()) {
+            if (!zone_parent[v]) {
+                // The root of the zone graph
+                label_node[v] = root_;
+                break;
             }
-            VertexDescriptor second_node = AddNodes(closest_encloser, labels, index);
-            // Check if DNAME edge was added due to another zone file
-            bool duplicate = false;
-            for (const EdgeDescriptor& edge : boost::make_iterator_range(out_edges(main_node, *this))) {
-                if (edge.m_target == second_node && (*this)[edge].type == dname) {
-                    duplicate = true;
-                }
+            unresolved.push_back(v);
+        }
+        for (; !unresolved.empty(); unresolved.pop_back()) {
+            auto v = unresolved.back();
+            DomainName label{zone_graph[v].name};
+            int index = 0;
+            VertexDescriptor closest_encloser =
+                GetAncestor(label_node[zone_parent[v].get()].get(), label, vertices_to_create_maps, index);
+            for (auto &u : vertices_to_create_maps) {
+                ConstructChildLabelsToVertexDescriptorMap(u);
             }
-            if (!duplicate) {
-                EdgeDescriptor e;
-                bool b;
-                boost::tie(e, b) = boost::add_edge(main_node, second_node, *this);
-                if (!b) {
-                    Logger->critical(
-                        fmt::format("label-graph.cpp (AddResourceRecord) - Unable to add edge to label graph"));
-                    exit(EXIT_FAILURE);
-                }
-                (*this)[e].type = dname;
+            vertices_to_create_maps.clear();
+            label_node[v] = AddNodes(closest_encloser, label, index);
+        }
+        AddResourceRecordAtNode(label_node[zone_vertexId].get(), record, zoneId, zone_vertexId);
+    }
+}
+
+void label::Graph::AddResourceRecordAtNode(
+    VertexDescriptor main_node,
+    const ResourceRecord &record,
+    const int &zoneId,
+    zone::Graph::VertexDescriptor zone_vertexId)
+{
+    if (record.get_type() == RRType::DNAME) {
+        const DomainName &labels = record.get_target();
+        int index = 0;
+        vector<VertexDescriptor> vertices_to_create_maps{};
+        VertexDescriptor closest_encloser = GetAncestor(root_, labels, vertices_to_create_maps, index);
+        for (auto &v : vertices_to_create_maps) {
+            ConstructChildLabelsToVertexDescriptorMap(v);
+        }
+        VertexDescriptor second_node = AddNodes(closest_encloser, labels, index);
+        // Check if DNAME edge was added due to another zone file
+        bool duplicate = false;
+        for (const EdgeDescriptor& edge : boost::make_iterator_range(out_edges(main_node, *this))) {
+            if (edge.m_target == second_node && (*this)[edge].type == dname) {
+                duplicate = true;
+            }
+        }
+        if (!duplicate) {
+            EdgeDescriptor e;
+            bool b;
+            boost::tie(e, b) = boost::add_edge(main_node, second_node, *this);
+            if (!b) {
+                Logger->critical(
+                    fmt::format("label-graph.cpp (AddResourceRecordAtNode) - Unable to add edge to label graph"));
+                exit(EXIT_FAILURE);
             }
+            (*this)[e].type = dname;
         }
-        auto it = std::find_if(
-            (*this)[main_node].zoneId_vertexId.begin(), (*this)[main_node].zoneId_vertexId.end(),
-            [=](const std::tuple<int, zone::Graph::VertexDescriptor> &e) {
-                return std::get<0>(e) == zoneId && std::get<1>(e) == zone_vertexId;
-            });
-        if (it == (*this)[main_node].zoneId_vertexId.end())
-            (*this)[main_node].zoneId_vertexId.push_back(
-                tuple<int, zone::Graph::VertexDescriptor>(zoneId, zone_vertexId));
-        (*this)[main_node].rrtypes_available.set(record.get_type());
     }
+    auto it = std::find_if(
+        (*this)[main_node].zoneId_vertexId.begin(), (*this)[main_node].zoneId_vertexId.end(),
+        [=](const std::tuple<int, zone::Graph::VertexDescriptor> &e) {
+            return std::get<0>(e) == zoneId && std::get<1>(e) == zone_vertexId;
+        });
+    if (it == (*this)[main_node].zoneId_vertexId.end())
+        (*this)[main_node].zoneId_vertexId.push_back(tuple<int, zone::Graph::VertexDescriptor>(zoneId, zone_vertexId));
+    (*this)[main_node].rrtypes_available.set(record.get_type());
 }
 
 void label::Graph::CheckStructuralDelegationConsistency(
@@ -164,24 +342,19 @@ void label::Graph::CheckStructuralDelegationConsistency(
     const Context &context,
     Job &current_job)
 {
-    auto zoneId_vertexIds = (*this)[node].zoneId_vertexId;
+    auto zoneId_vertexIds = ZoneVertices(node);
     auto types = (*this)[node].rrtypes_available;
     if (types[RRType::NS] == 1) {
         std::vector<ZoneIdGlueNSRecords> parents;
         std::vector<ZoneIdGlueNSRecords> children;
-        vector<NodeLabel> child_zone;
-        vector<NodeLabel> longest_parent;
+        DomainName child_zone;
+        DomainName longest_parent;
         for (auto zoneId_vertexId_pair : zoneId_vertexIds) {
             if (context.zoneId_to_zone.find(std::get<0>(zoneId_vertexId_pair)) != context.zoneId_to_zone.end()) {
                 const zone::Graph &z = context.zoneId_to_zone.find(std::get<0>(zoneId_vertexId_pair))->second;
-                vector<ResourceRecord> ns_records;
-                bool soa = false;
-                for (auto record : z[std::get<1>(zoneId_vertexId_pair)].rrs) {
-                    if (record.get_type() == RRType::SOA)
-                        soa = true;
-                    if (record.get_type() == RRType::NS)
-                        ns_records.push_back(record);
-                }
+                zone::Graph::RecordRange rrset = z.RRSet(std::get<1>(zoneId_vertexId_pair), RRType::NS);
+                vector<ResourceRecord> ns_records(rrset.begin(), rrset.end());
+                bool soa = z[std::get<1>(zoneId_vertexId_pair)].rr_types[RRType::SOA];
                 if (soa) {
                     /*
                         The RequireGlueRecords check is necessary as the child may not need glue records but the parent
@@ -370,8 +543,14 @@ void label::Graph::ConstructOutputNS(
     j["Inconsistent Pairs"].push_back(diffAB);
 }
 
-vector<label::Graph::ClosestNode> label::Graph::ClosestEnclosers(const vector<NodeLabel> &labels)
+vector<label::Graph::ClosestNode> label::Graph::ClosestEnclosers(const DomainName &labels)
 {
+    Freeze();
+    // Without a DNAME on the way down the longest existing name is the only closest encloser.
+    auto longest = LongestExistingName(labels);
+    if (longest) {
+        return {longest.get()};
+    }
     return SearchNode(root_, labels, 0);
 }
 
@@ -380,9 +559,57 @@ vector<label::Graph::ClosestNode> label::Graph::ClosestEnclosers(const string &d
     return ClosestEnclosers(LabelUtils::StringToLabels(domain_name));
 }
 
+boost::optional<label::Graph::ClosestNode> label::Graph::LongestExistingName(const DomainName &labels) const
+{
+    /*
+        The ancestors of an existing name exist as well, so the longest existing name is found by a binary search on
+        the number of labels, looking up the hash of each candidate in the name table. A miss is certain but a hit may
+        be a collision, so the result is checked label by label. Nothing is returned if the check fails or there is a
+        DNAME edge on the way, and the caller then searches the graph instead.
+    */
+    boost::container::small_vector<uint64_t, kInlineLabels + 1> hashes{0};
+    for (const NodeLabel &l : labels) {
+        hashes.push_back(ExtendNameHash(hashes.back(), l));
+    }
+    size_t mask = frozen_.name_table.size() - 1;
+    auto find = [&](uint64_t hash) {
+        for (size_t slot = NameSlotIndex(hash, mask); frozen_.name_table[slot].vertex != kNoVertex;
+             slot = (slot + 1) & mask) {
+            if (frozen_.name_table[slot].hash == hash) {
+                return frozen_.name_table[slot].vertex;
+            }
+        }
+        return kNoVertex;
+    };
+    size_t low = 0;
+    size_t high = labels.size();
+    uint32_t vertex = static_cast<uint32_t>(root_);
+    while (low < high) {
+        size_t middle = (low + high + 1) / 2;
+        uint32_t v = find(hashes[middle]);
+        if (v != kNoVertex) {
+            low = middle;
+            vertex = v;
+        } else {
+            high = middle - 1;
+        }
+    }
+    uint32_t v = vertex;
+    for (size_t i = low; i > 0; i--) {
+        if (v == kNoVertex || frozen_.names[v] != labels[i - 1]) {
+            return {};
+        }
+        v = frozen_.parents[v];
+    }
+    if (v != root_ || frozen_.dname_on_path[vertex]) {
+        return {};
+    }
+    return ClosestNode{vertex, static_cast<int>(low)};
+}
+
 vector<label::Graph::ClosestNode> label::Graph::SearchNode(
     VertexDescriptor closest_encloser,
-    const vector<NodeLabel> &labels,
+    const DomainName &labels,
     int index)
 {
     /*
@@ -395,47 +622,28 @@ vector<label::Graph::ClosestNode> label::Graph::SearchNode(
         enclosers.push_back(ClosestNode{closest_encloser, index});
         return enclosers;
     }
-    if (index == (*this)[closest_encloser].len) {
+    if (index == frozen_.path_lengths[closest_encloser]) {
         // Loop detected
         // TODO: Trace the loop to get the usr input.
         enclosers.push_back(ClosestNode{closest_encloser, -1});
         return enclosers;
     }
 
-    int16_t before_len = (*this)[closest_encloser].len;
-    (*this)[closest_encloser].len = index;
+    int16_t before_len = frozen_.path_lengths[closest_encloser];
+    frozen_.path_lengths[closest_encloser] = index;
     // The current node could also be the closest encloser if no child matches.
     enclosers.push_back(ClosestNode{closest_encloser, index});
-    for (EdgeDescriptor edge : boost::make_iterator_range(out_edges(closest_encloser, *this))) {
-        if ((*this)[edge].type == dname) {
-            auto r = SearchNode(edge.m_target, labels, index);
-            enclosers.insert(enclosers.end(), r.begin(), r.end());
-        }
+    for (uint32_t i = frozen_.dname_offsets[closest_encloser]; i < frozen_.dname_offsets[closest_encloser + 1]; i++) {
+        auto r = SearchNode(frozen_.dname_targets[i], labels, index);
+        enclosers.insert(enclosers.end(), r.begin(), r.end());
     }
-    if (vertex_to_child_map_.find(closest_encloser) != vertex_to_child_map_.end()) {
-        // Check if a hash-map exists for child labels.
-        LabelToVertex &m = vertex_to_child_map_.find(closest_encloser)->second;
-        auto it = m.find(labels[index]);
-        if (it != m.end()) {
-            index++;
-            auto r = SearchNode(it->second, labels, index);
-            enclosers.insert(enclosers.end(), r.begin(), r.end());
-        } else {
-            // label[index] does not exist
-        }
-    } else {
-        for (EdgeDescriptor edge : boost::make_iterator_range(out_edges(closest_encloser, *this))) {
-            if ((*this)[edge].type == normal) {
-                if ((*this)[edge.m_target].name == labels[index]) {
-                    index++;
-                    auto r = SearchNode(edge.m_target, labels, index);
-                    enclosers.insert(enclosers.end(), r.begin(), r.end());
-                    break;
-                }
-            }
-        }
+    auto child = frozen_.children.Find(closest_encloser, labels[index]);
+    if (child) {
+        index++;
+        auto r = SearchNode(child.get(), labels, index);
+        enclosers.insert(enclosers.end(), r.begin(), r.end());
     }
-    (*this)[closest_encloser].len = before_len;
+    frozen_.path_lengths[closest_encloser] = before_len;
     int max = -1;
     for (auto &r : enclosers) {
         if (r.second > max) {
@@ -455,23 +663,20 @@ vector<label::Graph::ClosestNode> label::Graph::SearchNode(
 
 void label::Graph::SubDomainECGeneration(
     VertexDescriptor start,
-    vector<NodeLabel> parent_domain_name,
+    DomainName parent_domain_name,
     bool skipLabel,
     Job &current_job,
     const Context &context,
     bool check_structural_delegations)
 {
-    size_t len = 0;
-    for (NodeLabel &l : parent_domain_name) {
-        len += l.get().length() + 1;
-    }
-    if (len >= kMaxDomainLength || (len == (*this)[start].len && skipLabel)) {
+    size_t len = parent_domain_name.wire_length() - 1;
+    if (len >= kMaxDomainLength || (static_cast<int16_t>(len) == frozen_.path_lengths[start] && skipLabel)) {
         //return if length exceedes or DNAME loop detected 
         //mostly likely turns out as cyclic zone dependecy so no need to report here
         return;
     }
-    NodeLabel node_labels = (*this)[start].name;
-    vector<NodeLabel> name;
+    NodeLabel node_labels = frozen_.names[start];
+    DomainName name;
     name = parent_domain_name;
     if (node_labels.get() == ".") {
         // Root has empty parent vector
@@ -482,17 +687,14 @@ void label::Graph::SubDomainECGeneration(
         // DNAME can not occur at the root.
         name.push_back(node_labels);
     }
-    int16_t beforeLen = (*this)[start].len;
-    size_t nodeLen = 0;
-    for (NodeLabel &l : name) {
-        nodeLen += l.get().length() + 1;
-    }
+    int16_t beforeLen = frozen_.path_lengths[start];
+    size_t nodeLen = name.wire_length() - 1;
     if (nodeLen >= kMaxDomainLength) {
         return;
     }
-    (*this)[start].len = static_cast<int16_t>(nodeLen);
+    frozen_.path_lengths[start] = static_cast<int16_t>(nodeLen);
     std::vector<NodeLabel> children_labels;
-    std::optional<VertexDescriptor> wildcard_node;
+    boost::optional<size_t> wildcard_node = frozen_.children.Wildcard(start);
 
     // Check structural delegation for this node
     if (check_structural_delegations) {
@@ -500,18 +702,13 @@ void label::Graph::SubDomainECGeneration(
         current_job.ec_queue.enqueue(std::move(task));
     }
 
-    for (EdgeDescriptor edge : boost::make_iterator_range(out_edges(start, *this))) {
-        if ((*this)[edge].type == normal) {
-            if ((*this)[edge.m_target].name.get() == "*") {
-                wildcard_node = edge.m_target;
-            }
-            SubDomainECGeneration(edge.m_target, name, false, current_job, context, check_structural_delegations);
-        }
-        if ((*this)[edge].type == dname) {
-            SubDomainECGeneration(edge.m_target, name, true, current_job, context, false);
-        }
+    for (const ChildIndex::Child &child : frozen_.children.Children(start)) {
+        SubDomainECGeneration(child.vertex, name, false, current_job, context, check_structural_delegations);
+    }
+    for (uint32_t i = frozen_.dname_offsets[start]; i < frozen_.dname_offsets[start + 1]; i++) {
+        SubDomainECGeneration(frozen_.dname_targets[i], name, true, current_job, context, false);
     }
-    (*this)[start].len = beforeLen;
+    frozen_.path_lengths[start] = beforeLen;
     if (!skipLabel) {
         // EC for the node if the node is not skipped.
         NodeEC(name, current_job);
@@ -534,7 +731,7 @@ void label::Graph::SubDomainECGeneration(
 
 void label::Graph::WildcardChildEC(
     std::vector<NodeLabel> &children_labels,
-    const vector<NodeLabel> &labels,
+    const DomainName &labels,
     int index,
     Job &current_job) const
 {
@@ -562,7 +759,7 @@ void label::Graph::GenerateECs(Job &current_job, const Context &context)
     // Given an user input for domain and query types, the function searches for relevant node
     // The search is relevant even for subdomain = False as we want to know the exact EC
 
-    vector<NodeLabel> labels = LabelUtils::StringToLabels(current_job.user_input_domain);
+    DomainName labels = LabelUtils::StringToLabels(current_job.user_input_domain);
     if (!std::get<0>(LabelUtils::LengthCheck(labels, 2))) {
         return;
     }
@@ -580,7 +777,7 @@ void label::Graph::GenerateECs(Job &current_job, const Context &context)
         }
         if (labels.size() == matchedIndex) {
             if (current_job.check_subdomains == true) {
-                vector<NodeLabel> parent_domain_name = labels;
+                DomainName parent_domain_name = labels;
                 if (parent_domain_name.size())
                     parent_domain_name.pop_back();
                 vector<std::thread> ECproducers;
@@ -3,6 +3,7 @@
 
 //#define BOOST_GRAPH_NO_BUNDLED_PROPERTIES 1
 
+#include "child-index.h"
 #include "job.h"
 #include "my-logger.h"
 
@@ -11,8 +12,8 @@ namespace label
 
 struct Vertex {
     NodeLabel name;
-    int16_t len = -1;
     std::bitset<RRType::N> rrtypes_available;
+    // Moved into the flat zone list of the graph while it is frozen; serialized by the graph for that reason.
     std::vector<tuple<int, zone::Graph::VertexDescriptor>> zoneId_vertexId;
 
   private:
@@ -20,9 +21,7 @@ struct Vertex {
     template <typename Archive> void serialize(Archive &ar, const unsigned int version)
     {
         ar &name;
-        ar &len;
         ar &rrtypes_available;
-        ar &zoneId_vertexId;
     }
 };
 
@@ -51,6 +50,34 @@ class Graph : public boost::adjacency_list<boost::vecS, boost::vecS, boost::dire
     using EdgeIterator = boost::graph_traits<Graph>::edge_iterator;
     using LabelToVertex = boost::unordered_map<NodeLabel, VertexDescriptor>;
     using ZoneIdGlueNSRecords = tuple<int, boost::optional<vector<ResourceRecord>>, vector<ResourceRecord>>;
+    using ZoneVertex = tuple<int, zone::Graph::VertexDescriptor>;
+
+    // Compressed sparse row layout of the graph, built by Freeze once the zone files are in. The normal children are
+    // in a child index; the DNAME targets of a vertex v are dname_targets[dname_offsets[v]] to
+    // dname_targets[dname_offsets[v + 1] - 1] and its zone vertices are laid out the same way. The searches and the EC
+    // generation only read these.
+    struct NameSlot {
+        uint64_t hash;
+        uint32_t vertex;
+    };
+
+    struct FrozenGraph {
+        std::vector<NodeLabel> names;
+        ChildIndex children;
+        std::vector<uint32_t> dname_offsets;
+        std::vector<uint32_t> dname_targets;
+        std::vector<uint32_t> zone_offsets;
+        std::vector<ZoneVertex> zones;
+        // Length of the name with which a vertex was reached on the current search path (-1 if it is not on it), which
+        // is how DNAME loops are detected.
+        std::vector<int16_t> path_lengths;
+        // The parent of every vertex through a normal edge, and whether a DNAME edge leaves the vertex or one of its
+        // ancestors.
+        std::vector<uint32_t> parents;
+        std::vector<bool> dname_on_path;
+        // Open addressing table, at most half full, from the hash of the name of every vertex to the vertex.
+        std::vector<NameSlot> name_table;
+    };
 
     template <class VertexMap> class VertexWriter
     {
@@ -100,8 +127,39 @@ class Graph : public boost::adjacency_list<boost::vecS, boost::vecS, boost::dire
 
     boost::unordered_map<VertexDescriptor, LabelToVertex> vertex_to_child_map_;
     VertexDescriptor root_ = 0;
+    FrozenGraph frozen_;
+    bool is_frozen_ = false;
+
+    friend class boost::serialization::access;
+    template <typename Archive> void save(Archive &ar, const unsigned int version) const
+    {
+        ar &boost::serialization::base_object<
+            boost::adjacency_list<boost::vecS, boost::vecS, boost::directedS, Vertex, Edge>>(*this);
+        ar &root_;
+        for (VertexDescriptor v : boost::make_iterator_range(vertices(*this))) {
+            auto zones = ZoneVertices(v);
+            std::vector<ZoneVertex> zoneId_vertexId(zones.begin(), zones.end());
+            ar &zoneId_vertexId;
+        }
+    }
+    template <typename Archive> void load(Archive &ar, const unsigned int version)
+    {
+        clear();
+        vertex_to_child_map_.clear();
+        frozen_ = FrozenGraph{};
+        is_frozen_ = false;
+        ar &boost::serialization::base_object<
+            boost::adjacency_list<boost::vecS, boost::vecS, boost::directedS, Vertex, Edge>>(*this);
+        ar &root_;
+        for (VertexDescriptor v : boost::make_iterator_range(vertices(*this))) {
+            ar &(*this)[v].zoneId_vertexId;
+        }
+        ConstructChildLabelsToVertexDescriptorMaps();
+    }
+    BOOST_SERIALIZATION_SPLIT_MEMBER()
 
-    VertexDescriptor AddNodes(VertexDescriptor, const vector<NodeLabel> &, int &);
+    VertexDescriptor AddNodes(VertexDescriptor, const DomainName &, int &);
+    void AddResourceRecordAtNode(VertexDescriptor, const ResourceRecord &, const int &, zone::Graph::VertexDescriptor);
     void CompareParentChildDelegationRecords(
         const std::vector<ZoneIdGlueNSRecords> &,
         const std::vector<ZoneIdGlueNSRecords> &,
@@ -109,6 +167,7 @@ class Graph : public boost::adjacency_list<boost::vecS, boost::vecS, boost::dire
         const Context &,
         Job &) const;
     void ConstructChildLabelsToVertexDescriptorMap(VertexDescriptor);
+    void ConstructChildLabelsToVertexDescriptorMaps();
     void ConstructOutputNS(
         json &,
         const CommonSymDiff &,
@@ -117,19 +176,30 @@ class Graph : public boost::adjacency_list<boost::vecS, boost::vecS, boost::dire
         string,
         string,
         string) const;
-    VertexDescriptor GetAncestor(VertexDescriptor, const vector<NodeLabel> &, vector<VertexDescriptor> &, int &index)
+    VertexDescriptor GetAncestor(VertexDescriptor, const DomainName &, vector<VertexDescriptor> &, int &index)
         const;
     // string GetHostingNameServer(int, const Context &) const;
-    void NodeEC(const vector<NodeLabel> &name, Job &) const;
-    vector<ClosestNode> SearchNode(VertexDescriptor, const vector<NodeLabel> &, int);
-    void SubDomainECGeneration(VertexDescriptor, vector<NodeLabel>, bool, Job &, const Context &, bool);
-    void WildcardChildEC(std::vector<NodeLabel> &, const vector<NodeLabel> &, int, Job &) const;
+    void NodeEC(const DomainName &name, Job &) const;
+    boost::optional<ClosestNode> LongestExistingName(const DomainName &) const;
+    vector<ClosestNode> SearchNode(VertexDescriptor, const DomainName &, int);
+    void SubDomainECGeneration(VertexDescriptor, DomainName, bool, Job &, const Context &, bool);
+    void Thaw();
+    void WildcardChildEC(std::vector<NodeLabel> &, const DomainName &, int, Job &) const;
+    boost::iterator_range<const ZoneVertex *> ZoneVertices(VertexDescriptor) const;
 
   public:
     void AddResourceRecord(const ResourceRecord &, const int &, zone::Graph::VertexDescriptor);
+    // Adds the records of a zone (with their vertices in the given zone graph) in order.
+    void AddResourceRecords(
+        const vector<tuple<ResourceRecord, zone::Graph::VertexDescriptor>> &,
+        const int &,
+        const zone::Graph &);
     void CheckStructuralDelegationConsistency(string, label::Graph::VertexDescriptor, const Context &, Job &);
-    vector<ClosestNode> ClosestEnclosers(const vector<NodeLabel> &);
+    vector<ClosestNode> ClosestEnclosers(const DomainName &);
     vector<ClosestNode> ClosestEnclosers(const string &);
+    // Lays the graph out in the compressed sparse row form used for the EC generation. It is done on the first search
+    // if not before, and adding a record afterwards brings the graph back to the adjacency list form.
+    void Freeze();
     void GenerateDotFile(string);
     void GenerateECs(Job &, const Context &);
     Graph();
@@ -0,0 +1,100 @@
+#include "lint-sink.h"
+
+#include "my-logger.h"
+
+LintSink::~LintSink()
+{
+    Close();
+}
+
+LintSink::Format LintSink::StringToFormat(const std::string &format)
+{
+    if (format == "json") {
+        return Format::JSON;
+    } else if (format == "ndjson") {
+        return Format::NDJSON;
+    }
+    Logger->critical(fmt::format("lint-sink.cpp (StringToFormat) - Unknown lint format {}", format));
+    std::exit(EXIT_FAILURE);
+}
+
+void LintSink::Open(std::string file, Format format)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (out_.is_open()) {
+        Logger->critical(fmt::format(
+            "lint-sink.cpp (Open) - Unable to open {} while the lint file {} is still open", file, file_));
+        std::exit(EXIT_FAILURE);
+    }
+    out_.open(file, std::ios::out | std::ios::trunc | std::ios::binary);
+    if (!out_.is_open()) {
+        Logger->critical(fmt::format("lint-sink.cpp (Open) - Unable to open the lint file {}", file));
+        std::exit(EXIT_FAILURE);
+    }
+    file_ = file;
+    format_ = format;
+    empty_ = true;
+    buffer_.clear();
+    buffer_.reserve(kLintBufferSize);
+    if (format_ == Format::JSON) {
+        buffer_ += "[\n";
+    }
+}
+
+void LintSink::Write(const json &issue)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!out_.is_open()) {
+        return;
+    }
+    if (format_ == Format::JSON) {
+        if (!empty_) {
+            buffer_ += ",\n";
+        }
+        buffer_ += issue.dump(4);
+    } else {
+        buffer_ += issue.dump();
+        buffer_ += '\n';
+    }
+    empty_ = false;
+    if (buffer_.size() >= kLintBufferSize) {
+        WriteBuffer();
+    }
+}
+
+void LintSink::WriteBuffer()
+{
+    out_.write(buffer_.data(), static_cast<std::streamsize>(buffer_.size()));
+    buffer_.clear();
+    if (!out_) {
+        Logger->error(fmt::format("lint-sink.cpp (WriteBuffer) - Unable to write to the lint file {}", file_));
+    }
+}
+
+void LintSink::Flush()
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (out_.is_open()) {
+        WriteBuffer();
+        out_.flush();
+    }
+}
+
+void LintSink::Close()
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!out_.is_open()) {
+        return;
+    }
+    if (format_ == Format::JSON) {
+        buffer_ += "\n]";
+    }
+    WriteBuffer();
+    out_.close();
+}
+
+bool LintSink::is_open()
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return out_.is_open();
+}
@@ -0,0 +1,57 @@
+#ifndef LINT_SINK_H_
+#define LINT_SINK_H_
+
+#include <fstream>
+#include <mutex>
+#include <nlohmann/json.hpp>
+#include <string>
+
+using json = nlohmann::json;
+
+// Size of the buffer the lint issues are collected in before they are written out.
+const size_t kLintBufferSize = 1 << 20;
+
+// Destination of the zone file issues reported with --lint. The issues are serialized into an in-memory buffer that
+// is written out whenever it grows past kLintBufferSize, so the file is opened once per run instead of once per issue.
+// Issues may be reported from several threads at once.
+class LintSink
+{
+  public:
+    // JSON writes a single array of issues, NDJSON writes one issue per line so that the output can be consumed
+    // while it is being written.
+    enum class Format { JSON, NDJSON };
+
+  private:
+    std::mutex mutex_;
+    std::ofstream out_;
+    std::string buffer_;
+    std::string file_;
+    Format format_ = Format::JSON;
+    bool empty_ = true;
+
+    LintSink()
+    {
+    }
+    ~LintSink();
+    void WriteBuffer();
+
+  public:
+    static LintSink *getInstance()
+    {
+        static LintSink instance;
+        return &instance;
+    }
+    static Format StringToFormat(const std::string &);
+
+    // Starts a new lint file (truncating it). Issues written while no file is open are dropped.
+    void Open(std::string, Format = Format::JSON);
+    void Write(const json &);
+    void Flush();
+    // Writes out the remaining issues and terminates the file.
+    void Close();
+    bool is_open();
+};
+
+inline class LintSink *Lint = LintSink::getInstance();
+
+#endif
@@ -32,6 +32,10 @@ class MyLogger
         static MyLogger instance;
         return &instance;
     }
+    bool should_log(spdlog::level::level_enum level)
+    {
+        return _logger && _logger->should_log(level);
+    }
     void trace(std::string s)
     {
         if (_logger) {
@@ -68,6 +72,12 @@ class MyLogger
             _logger->critical(s);
         }
     }
+    void log(spdlog::level::level_enum level, std::string s)
+    {
+        if (_logger) {
+            _logger->log(level, s);
+        }
+    }
 };
 
 inline class MyLogger *Logger = MyLogger::getInstance();
@@ -1,22 +1,80 @@
 #include "node-label.h"
 
-std::string NodeLabel::get() const
+#include <limits>
+
+LabelTable::LabelTable() : chunks_(new std::atomic<Entry *>[size_t{1} << (32 - kChunkBits)]())
+{
+    Intern("");
+}
+
+LabelTable::Entry &LabelTable::Allocate(uint32_t id)
+{
+    std::atomic<Entry *> &chunk = chunks_[id >> kChunkBits];
+    if (!chunk.load(std::memory_order_acquire)) {
+        std::lock_guard<std::mutex> lock(chunks_mutex_);
+        if (!chunk.load(std::memory_order_relaxed)) {
+            chunk.store(new Entry[size_t{1} << kChunkBits], std::memory_order_release);
+        }
+    }
+    return chunk.load(std::memory_order_acquire)[id & ((1 << kChunkBits) - 1)];
+}
+
+uint32_t LabelTable::Intern(std::string_view label)
+{
+    size_t hash = std::hash<std::string_view>()(label);
+    Shard &shard = shards_[hash % kLabelTableShards];
+    {
+        std::shared_lock<std::shared_mutex> lock(shard.mutex);
+        auto it = shard.ids.find(label);
+        if (it != shard.ids.end()) {
+            return it->second;
+        }
+    }
+    // The lower case form is interned first, outside of this shard's lock.
+    std::string lower(label);
+    for (char &c : lower) {
+        if (c >= 'A' && c <= 'Z') {
+            c += 'a' - 'A';
+        }
+    }
+    bool has_lowercase = lower != label;
+    uint32_t lowercase = has_lowercase ? Intern(lower) : 0;
+
+    std::unique_lock<std::shared_mutex> lock(shard.mutex);
+    auto it = shard.ids.find(label);
+    if (it != shard.ids.end()) {
+        return it->second;
+    }
+    uint32_t id = size_.fetch_add(1, std::memory_order_relaxed);
+    if (id == std::numeric_limits<uint32_t>::max()) {
+        Logger->critical("node-label.cpp (Intern) - Ran out of label ids");
+        std::exit(EXIT_FAILURE);
+    }
+    Entry &entry = Allocate(id);
+    entry.value = std::string(label);
+    entry.lowercase = has_lowercase ? lowercase : id;
+    shard.ids.emplace(entry.value, id);
+    return id;
+}
+
+size_t LabelTable::size() const
 {
-    return n.get();
+    return size_.load(std::memory_order_relaxed);
 }
 
-void NodeLabel::set(const std::string s)
+NodeLabel NodeLabel::lowercase() const
 {
-    n = s;
+    NodeLabel nl;
+    nl.id = LabelTable::getInstance()[id].lowercase;
+    return nl;
 }
 
-bool NodeLabel::operator==(const NodeLabel &nl) const
+void NodeLabel::set(const std::string &s)
 {
-    return nl.n == n;
+    id = LabelTable::getInstance().Intern(s);
 }
 
 std::size_t hash_value(const NodeLabel &nl)
 {
-    boost::hash<boost::flyweight<std::string, boost::flyweights::tag<Empty>, boost::flyweights::no_tracking>> hasher;
-    return hasher(nl.n);
+    return boost::hash<uint32_t>()(nl.id);
 }
@@ -11,13 +11,22 @@
 #include <boost/graph/adjacency_list.hpp>
 #include <boost/graph/graphviz.hpp>
 #include <boost/serialization/access.hpp>
+#include <boost/serialization/base_object.hpp>
 #include <boost/serialization/bitset.hpp>
 #include <boost/serialization/optional.hpp>
+#include <boost/serialization/split_member.hpp>
 #include <boost/serialization/string.hpp>
 #include <boost/serialization/vector.hpp>
+#include <atomic>
 #include <iostream>
+#include <memory>
+#include <mutex>
 #include <nlohmann/json.hpp>
+#include <shared_mutex>
 #include <string>
+#include <string_view>
+#include <type_traits>
+#include <unordered_map>
 #include <vector>
 
 #include "../concurrentqueue/concurrentqueue.h"
@@ -30,25 +39,107 @@ using json = nlohmann::json;
 #define kMaxLabelLength 63
 #define kMaxDomainLength 253
 
-struct Empty {
+// Process wide intern table of the labels. Every distinct label is stored once, never moves and is identified by a
+// dense 32-bit id, so NodeLabel only holds the id. Looking up a label by id takes no lock; interning takes a shared
+// lock on one of the kLabelTableShards shards, and an exclusive one only to add a new label.
+class LabelTable
+{
+  public:
+    struct Entry {
+        std::string value;
+        // Id of the lower case form of the label (its own id if it has no upper case letters).
+        uint32_t lowercase = 0;
+    };
+
+  private:
+    static const int kLabelTableShards = 64;
+    static const int kChunkBits = 16;
+    struct Shard {
+        std::shared_mutex mutex;
+        std::unordered_map<std::string_view, uint32_t> ids;
+    };
+    Shard shards_[kLabelTableShards];
+    // Entries are allocated in chunks of 1 << kChunkBits that are never reallocated.
+    std::unique_ptr<std::atomic<Entry *>[]> chunks_;
+    std::mutex chunks_mutex_;
+    std::atomic<uint32_t> size_{0};
+
+    LabelTable();
+    Entry &Allocate(uint32_t);
+
+  public:
+    LabelTable(const LabelTable &) = delete;
+    LabelTable &operator=(const LabelTable &) = delete;
+
+    static LabelTable &getInstance()
+    {
+        static LabelTable instance;
+        return instance;
+    }
+    uint32_t Intern(std::string_view);
+    const Entry &operator[](uint32_t id) const
+    {
+        return chunks_[id >> kChunkBits].load(std::memory_order_acquire)[id & ((1 << kChunkBits) - 1)];
+    }
+    size_t size() const;
 };
 
 struct NodeLabel {
-    boost::flyweight<std::string, boost::flyweights::tag<Empty>, boost::flyweights::no_tracking> n;
-    NodeLabel(const std::string s) : n{s} {};
-    NodeLabel() : n{""} {};
-    std::string get() const;
-    void set(const std::string);
-    bool operator==(const NodeLabel &) const;
+    uint32_t id;
+    NodeLabel(const std::string &s) : id{LabelTable::getInstance().Intern(s)} {};
+    // The empty label is the first one interned.
+    NodeLabel() : id{0} {};
+    const std::string &get() const
+    {
+        return LabelTable::getInstance()[id].value;
+    }
+    size_t length() const
+    {
+        return get().length();
+    }
+    NodeLabel lowercase() const;
+    void set(const std::string &);
+    bool operator==(const NodeLabel &nl) const
+    {
+        return id == nl.id;
+    }
+    bool operator!=(const NodeLabel &nl) const
+    {
+        return id != nl.id;
+    }
 
   private:
+    // Ids are only meaningful within a process, so archives hold the label itself.
     friend class boost::serialization::access;
-    template <typename Archive> void serialize(Archive &ar, const unsigned int version)
+    template <typename Archive> void save(Archive &ar, const unsigned int version) const
+    {
+        std::string s = get();
+        ar &s;
+    }
+    template <typename Archive> void load(Archive &ar, const unsigned int version)
     {
-        ar &n;
+        std::string s;
+        ar &s;
+        id = LabelTable::getInstance().Intern(s);
     }
+    BOOST_SERIALIZATION_SPLIT_MEMBER()
 };
 
+static_assert(std::is_trivially_copyable<NodeLabel>::value, "NodeLabel has to stay a plain id");
+
 std::size_t hash_value(const NodeLabel &);
 
+namespace boost
+{
+namespace serialization
+{
+// Serializes a std::tuple (e.g. the zone id and vertex pairs of the label graph) element by element.
+template <typename Archive, typename... Types>
+void serialize(Archive &ar, std::tuple<Types...> &t, const unsigned int version)
+{
+    std::apply([&ar](auto &... element) { (ar & ... & element); }, t);
+}
+} // namespace serialization
+} // namespace boost
+
 #endif
\ No newline at end of file
@@ -15,17 +15,17 @@ void interpretation::Graph::Properties::PrettyPrintResponseValue(
     json j;
     j["Found"] = std::accumulate(response.begin(), response.end(), std::string{});
     j["Query"] = graph[node].query.ToString();
-    j["Nameserver"] = graph[node].ns;
+    j["Nameserver"] = graph.NameserverName(graph[node].ns);
     tmp["Mismatches"].push_back(j);
 }
 
 tuple<vector<ResourceRecord>, vector<ResourceRecord>> interpretation::Graph::Properties::GetNSGlueRecords(
-    const vector<ResourceRecord> &records)
+    const RRSetView &records)
 {
     // From the input set of records, return the NS records and IP records
     vector<ResourceRecord> nsRecords;
     vector<ResourceRecord> glueRecords;
-    for (auto r : records) {
+    for (auto &r : records) {
         if (r.get_type() == RRType::NS)
             nsRecords.push_back(r);
         if (r.get_type() == RRType::A || r.get_type() == RRType::AAAA)
@@ -50,8 +50,8 @@ void interpretation::Graph::Properties::CheckResponseReturned(
         if (graph[vd].query.nonExistent) {
             return;
         }
-        if ((graph[vd].query.rrTypes & types_req).count() > 0 && graph[vd].ns != "") {
-            boost::optional<vector<zone::LookUpAnswer>> answer = graph[vd].answer;
+        if ((graph[vd].query.rrTypes & types_req).count() > 0 && graph[vd].ns != kStartNameserver) {
+            const boost::optional<vector<zone::LookUpAnswer>> &answer = graph[vd].answer;
             if (answer) {
                 if (std::get<0>(answer.get()[0]) == ReturnTag::REFUSED ||
                     std::get<0>(answer.get()[0]) == ReturnTag::NSNOTFOUND) {
@@ -63,7 +63,7 @@ void interpretation::Graph::Properties::CheckResponseReturned(
                             tmp["Property"] = "ResponseReturned";
                             tmp["Query"] = graph[vd].query.ToString();
                             tmp["Violation"]["Types"] = TypeUtils::TypesToString(std::get<1>(a) & types_req);
-                            tmp["Violation"]["Nameserver"] = graph[vd].ns;
+                            tmp["Violation"]["Nameserver"] = graph.NameserverName(graph[vd].ns);
                             json_queue.enqueue(tmp);
                         }
                     }
@@ -143,8 +143,8 @@ void interpretation::Graph::Properties::CheckSameResponseReturned(
     */
     vector<VertexDescriptor> cname_end_nodes{};
     for (auto vd : end_nodes) {
-        if ((graph[vd].query.rrTypes & typesReq).count() > 0 && graph[vd].ns != "") {
-            boost::optional<vector<zone::LookUpAnswer>> answer = graph[vd].answer;
+        if ((graph[vd].query.rrTypes & typesReq).count() > 0 && graph[vd].ns != kStartNameserver) {
+            const boost::optional<vector<zone::LookUpAnswer>> &answer = graph[vd].answer;
             if (answer) {
                 if (std::get<0>(answer.get()[0]) == ReturnTag::REFUSED ||
                     std::get<0>(answer.get()[0]) == ReturnTag::NSNOTFOUND) {
@@ -156,8 +156,8 @@ void interpretation::Graph::Properties::CheckSameResponseReturned(
                     if (!response) {
                         response = answer;
                     } else {
-                        CommonSymDiff diff =
-                            RRUtils::CompareRRs(std::get<2>(answer.get()[0]), std::get<2>(response.get()[0]));
+                        CommonSymDiff diff = RRUtils::CompareRRs(
+                            std::get<2>(answer.get()[0]).ToVector(), std::get<2>(response.get()[0]).ToVector());
                         if (std::get<1>(diff).size() || std::get<2>(diff).size()) {
                             foundDiff = true;
                         }
@@ -181,8 +181,8 @@ void interpretation::Graph::Properties::CheckSameResponseReturned(
             } else {
                 // If only CNAME is requested then the answer will only have one element
                 // If CNAME and other types are requested then there might be a node with Rewrite
-                CommonSymDiff diff =
-                    RRUtils::CompareRRs(std::get<2>(graph[vd].answer.get()[0]), std::get<2>(response.get()[0]));
+                CommonSymDiff diff = RRUtils::CompareRRs(
+                    std::get<2>(graph[vd].answer.get()[0]).ToVector(), std::get<2>(response.get()[0]).ToVector());
                 if (std::get<1>(diff).size() || std::get<2>(diff).size()) {
                     foundDiff = true;
                 }
@@ -209,8 +209,8 @@ void interpretation::Graph::Properties::ZeroTTL(
       for the given types.
     */
     for (auto &vd : end_nodes) {
-        if ((graph[vd].query.rrTypes & typesReq).count() > 0 && graph[vd].ns != "") {
-            boost::optional<vector<zone::LookUpAnswer>> answer = graph[vd].answer;
+        if ((graph[vd].query.rrTypes & typesReq).count() > 0 && graph[vd].ns != kStartNameserver) {
+            const boost::optional<vector<zone::LookUpAnswer>> &answer = graph[vd].answer;
             if (answer) {
                 if (std::get<0>(answer.get()[0]) == ReturnTag::REFUSED ||
                     std::get<0>(answer.get()[0]) == ReturnTag::NSNOTFOUND) {
@@ -222,7 +222,7 @@ void interpretation::Graph::Properties::ZeroTTL(
                             json tmp;
                             tmp["Property"] = "Zero TTL";
                             tmp["Query"] = graph[end_nodes[0]].query.ToString();
-                            tmp["Violation"]["Nameserver"] = graph[vd].ns;
+                            tmp["Violation"]["Nameserver"] = graph.NameserverName(graph[vd].ns);
                             tmp["Violation"]["Record"] = r.toString();
                             json_queue.enqueue(tmp);
                         }
@@ -242,7 +242,7 @@ void interpretation::Graph::Properties::AllAliases(
     const interpretation::Graph &graph,
     const Path &p,
     moodycamel::ConcurrentQueue<json> &json_queue,
-    vector<vector<NodeLabel>> canonical_names)
+    vector<DomainName> canonical_names)
 {
     /*
       If there is a node with answer tag as REWRITE then there should be a node with query name in the input
@@ -278,10 +278,10 @@ void interpretation::Graph::Properties::InfiniteDName(
     for (int i = 0; i < p.size(); i++) {
         if (graph[p[i]].answer && std::get<0>(graph[p[i]].answer.get()[0]) == ReturnTag::REWRITE) {
             // Rewrite happened at this node and it can be CNAME or DNAME
-            vector<zone::LookUpAnswer> answers = graph[p[i]].answer.get();
-            for (zone::LookUpAnswer ans : answers) {
-                auto RRList = std::get<2>(ans);
-                for (const ResourceRecord rr : RRList) {
+            const vector<zone::LookUpAnswer> &answers = graph[p[i]].answer.get();
+            for (const zone::LookUpAnswer &ans : answers) {
+                const RRSetView &RRList = std::get<2>(ans);
+                for (const ResourceRecord &rr : RRList) {
                     if (DMap.find(rr) != DMap.end()) {
                         if (graph[p[i]].query.name.size() >= std::get<0>(DMap[rr])) {
                             json tmp;
@@ -328,7 +328,7 @@ void interpretation::Graph::Properties::CheckDelegationConsistency(
       same domain_name.
     */
     if (p.size() > 2) {
-        if (graph[p[0]].ns == "") {
+        if (graph[p[0]].ns == kStartNameserver) {
             const EC &query = graph[p[0]].query;
             int parentIndex = -1;
             for (int i = 0; i < p.size(); i++) {
@@ -360,7 +360,7 @@ void interpretation::Graph::Properties::CheckDelegationConsistency(
 
                 // Remove glue records that are required by parent but not child
                 if (std::get<0>(child_records).size()) {
-                    vector<NodeLabel> child_domain = std::get<0>(child_records)[0].get_name();
+                    const DomainName &child_domain = std::get<0>(child_records)[0].get_name();
                     vector<ResourceRecord> &parent_glue_records = std::get<1>(parent_records);
                     for (auto it = parent_glue_records.begin(); it != parent_glue_records.end();) {
                         if (!LabelUtils::SubDomainCheck(child_domain, it->get_name())) {
@@ -377,8 +377,9 @@ void interpretation::Graph::Properties::CheckDelegationConsistency(
                     json tmp;
                     tmp["Property"] = "Delegation Consistency";
                     tmp["Query"] = query.ToString();
-                    tmp["Violation"]["Nameserver1"] = graph[p[parentIndex]].ns;
-                    tmp["Violation"]["Nameserver2"] = graph[p[static_cast<long long>(parentIndex) + 1]].ns;
+                    tmp["Violation"]["Nameserver1"] = graph.NameserverName(graph[p[parentIndex]].ns);
+                    tmp["Violation"]["Nameserver2"] =
+                        graph.NameserverName(graph[p[static_cast<long long>(parentIndex) + 1]].ns);
                     tmp["Violation"]["InconsistencyType"] = "NS";
                     json_queue.enqueue(tmp);
                 }
@@ -386,8 +387,9 @@ void interpretation::Graph::Properties::CheckDelegationConsistency(
                     json tmp;
                     tmp["Property"] = "Delegation Consistency";
                     tmp["Query"] = query.ToString();
-                    tmp["Violation"]["Nameserver1"] = graph[p[parentIndex]].ns;
-                    tmp["Violation"]["Nameserver2"] = graph[p[static_cast<long long>(parentIndex) + 1]].ns;
+                    tmp["Violation"]["Nameserver1"] = graph.NameserverName(graph[p[parentIndex]].ns);
+                    tmp["Violation"]["Nameserver2"] =
+                        graph.NameserverName(graph[p[static_cast<long long>(parentIndex) + 1]].ns);
                     tmp["Violation"]["InconsistencyType"] = "Glue";
                     json_queue.enqueue(tmp);
                 }
@@ -413,7 +415,7 @@ void interpretation::Graph::Properties::CheckLameDelegation(
       lame delegation which may be a false positive if we didn't have access to all zone files at the child NS.
     */
     if (p.size() > 2) {
-        if (graph[p[0]].ns == "") {
+        if (graph[p[0]].ns == kStartNameserver) {
             const EC &query = graph[p[0]].query;
             int parentIndex = -1;
             for (int i = 0; i < p.size(); i++) {
@@ -429,8 +431,9 @@ void interpretation::Graph::Properties::CheckLameDelegation(
                             json tmp;
                             tmp["Property"] = "Lame Delegation";
                             tmp["Query"] = query.ToString();
-                            tmp["Violation"]["Nameserver1"] = graph[p[i]].ns;
-                            tmp["Violation"]["Nameserver2"] = graph[p[static_cast<long long>(i) + 1]].ns;
+                            tmp["Violation"]["Nameserver1"] = graph.NameserverName(graph[p[i]].ns);
+                            tmp["Violation"]["Nameserver2"] =
+                                graph.NameserverName(graph[p[static_cast<long long>(i) + 1]].ns);
                             json_queue.enqueue(tmp);
                         }
                     }
@@ -457,7 +460,7 @@ void interpretation::Graph::Properties::DNAMESubstitutionExceedesLength(
             tmp["Property"] = "DNAME Substitution exceeds length";
             tmp["Query"] = graph[p[0]].query.ToString();
             tmp["Violation"]["RewriteTarget"] = graph[p[p.size() - 1]].query.ToString();
-            tmp["Violation"]["Nameserver"] = graph[p[p.size() - 1]].ns;
+            tmp["Violation"]["Nameserver"] = graph.NameserverName(graph[p[p.size() - 1]].ns);
             json_queue.enqueue(tmp);
         }
     }
@@ -467,18 +470,25 @@ void interpretation::Graph::Properties::NameServerContact(
     const interpretation::Graph &graph,
     const Path &p,
     moodycamel::ConcurrentQueue<json> &json_queue,
-    vector<vector<NodeLabel>> allowed_domains)
+    vector<DomainName> allowed_domains)
 {
     /*
      At any point in the resolution process, the query should not be sent to a name server outside the domain.
     */
+    // Consecutive nodes of a path are mostly answered by the same name server, so its name is parsed once per run.
+    NameserverId ns = kStartNameserver;
+    DomainName ns_name;
     for (int i = 0; i < p.size(); i++) {
-        if (graph[p[i]].ns != "") {
-            if (!LabelUtils::SubDomainCheck(allowed_domains, LabelUtils::StringToLabels(graph[p[i]].ns))) {
+        if (graph[p[i]].ns != kStartNameserver) {
+            if (graph[p[i]].ns != ns) {
+                ns = graph[p[i]].ns;
+                ns_name = LabelUtils::StringToLabels(graph.NameserverName(ns));
+            }
+            if (!LabelUtils::SubDomainCheck(allowed_domains, ns_name)) {
                 json tmp;
                 tmp["Property"] = "Name Server Contact";
                 tmp["Query"] = graph[p[i]].query.ToString();
-                tmp["Violation"]["ExternalNameserver"] = graph[p[i]].ns;
+                tmp["Violation"]["ExternalNameserver"] = graph.NameserverName(graph[p[i]].ns);
                 tmp["Violation"]["AllowedDomains"] = LabelUtils::LabelsToString(allowed_domains);
                 json_queue.enqueue(tmp);
             }
@@ -496,10 +506,10 @@ void interpretation::Graph::Properties::NumberOfHops(
         Number of Hops = Number of name servers in the path.
         We may encounter a Node with Refused/NSnotfound in which case we have incomplete information.
     */
-    vector<string> nameServers;
+    vector<NameserverId> nameServers;
     bool incomplete = false;
     for (auto vd : p) {
-        if (graph[vd].ns != "" && (!nameServers.size() || graph[vd].ns != nameServers.back())) {
+        if (graph[vd].ns != kStartNameserver && (!nameServers.size() || graph[vd].ns != nameServers.back())) {
             nameServers.push_back(graph[vd].ns);
             if (std::get<0>(graph[vd].answer.get()[0]) == ReturnTag::NSNOTFOUND ||
                 std::get<0>(graph[vd].answer.get()[0]) == ReturnTag::REFUSED) {
@@ -529,7 +539,7 @@ void interpretation::Graph::Properties::NumberOfRewrites(
     bool incomplete = false;
     int rewrites = 0;
     for (auto vd : p) {
-        if (graph[vd].ns != "") {
+        if (graph[vd].ns != kStartNameserver) {
             if (std::get<0>(graph[vd].answer.get()[0]) == ReturnTag::REWRITE) {
                 rewrites++;
             } else if (
@@ -554,7 +564,7 @@ void interpretation::Graph::Properties::QueryRewrite(
     const interpretation::Graph &graph,
     const Path &p,
     moodycamel::ConcurrentQueue<json> &json_queue,
-    vector<vector<NodeLabel>> domain)
+    vector<DomainName> domain)
 {
     /*
       If there is a node with answer tag as AnsQ then the new query should be under the subdomain of domain.
@@ -570,7 +580,7 @@ void interpretation::Graph::Properties::QueryRewrite(
                     tmp["Property"] = "Query Rewrite";
                     tmp["Query"] = graph[p[i]].query.ToString();
                     tmp["Violation"]["RewriteTarget"] = graph[p[static_cast<long long>(i) + 1]].query.ToString();
-                    tmp["Violation"]["Nameserver"] = graph[p[i]].ns;
+                    tmp["Violation"]["Nameserver"] = graph.NameserverName(graph[p[i]].ns);
                     tmp["Violation"]["ExpectedUnder"] = LabelUtils::LabelsToString(domain);
                     json_queue.enqueue(tmp);
                 }
@@ -605,7 +615,7 @@ void interpretation::Graph::Properties::RewriteBlackholing(
                     tmp["Property"] = "Rewrite Blackholing";
                     tmp["Query"] = graph[p[i]].query.ToString();
                     tmp["Violation"]["RewriteTarget"] = targetNode.query.ToString();
-                    tmp["Violation"]["BlackholeNameserver"] = targetNode.ns;
+                    tmp["Violation"]["BlackholeNameserver"] = graph.NameserverName(targetNode.ns);
                     json_queue.enqueue(tmp);
                     /*	stringstream ss;
                         ss << std::this_thread::get_id();
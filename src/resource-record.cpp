@@ -1,35 +1,185 @@
 #include "resource-record.h"
 #include "utils.h"
 
+#include <boost/functional/hash.hpp>
+
+namespace
+{
+
+bool ParseIPv4(string_view text, uint8_t *address)
+{
+    int octets = 0;
+    size_t i = 0;
+    while (octets < 4) {
+        unsigned value = 0;
+        size_t digits = 0;
+        for (; i < text.size() && isdigit(static_cast<unsigned char>(text[i])) && digits < 3; i++, digits++) {
+            value = value * 10 + (text[i] - '0');
+        }
+        if (digits == 0 || value > 255) {
+            return false;
+        }
+        address[octets++] = static_cast<uint8_t>(value);
+        if (octets < 4) {
+            if (i == text.size() || text[i] != '.') {
+                return false;
+            }
+            i++;
+        }
+    }
+    return i == text.size();
+}
+
+bool ParseIPv6(string_view text, uint8_t *address)
+{
+    // Groups before and after the "::" (if any); an IPv4 address may stand for the last two groups.
+    uint16_t groups[8];
+    int count = 0;
+    int gap = -1;
+    size_t i = 0;
+    if (text.substr(0, 2) == "::") {
+        gap = 0;
+        i = 2;
+    }
+    while (i < text.size()) {
+        if (count == 8) {
+            return false;
+        }
+        size_t end = text.find(':', i);
+        string_view group = text.substr(i, end == string_view::npos ? string_view::npos : end - i);
+        if (group.find('.') != string_view::npos) {
+            uint8_t v4[4];
+            if (end != string_view::npos || count > 6 || !ParseIPv4(group, v4)) {
+                return false;
+            }
+            groups[count++] = static_cast<uint16_t>(v4[0] << 8 | v4[1]);
+            groups[count++] = static_cast<uint16_t>(v4[2] << 8 | v4[3]);
+            i = text.size();
+            break;
+        }
+        if (group.empty() || group.size() > 4) {
+            return false;
+        }
+        uint16_t value = 0;
+        for (char c : group) {
+            if (!isxdigit(static_cast<unsigned char>(c))) {
+                return false;
+            }
+            int digit = isdigit(static_cast<unsigned char>(c)) ? c - '0' : tolower(c) - 'a' + 10;
+            value = static_cast<uint16_t>(value << 4 | digit);
+        }
+        groups[count++] = value;
+        if (end == string_view::npos) {
+            i = text.size();
+        } else if (text.substr(end, 2) == "::") {
+            if (gap != -1) {
+                return false;
+            }
+            gap = count;
+            i = end + 2;
+        } else if (end + 1 == text.size()) {
+            return false;
+        } else {
+            i = end + 1;
+        }
+    }
+    if ((gap == -1 && count != 8) || (gap != -1 && count > 7)) {
+        return false;
+    }
+    int zeros = 8 - count;
+    for (int g = 0, out = 0; g <= count; g++) {
+        if (g == gap) {
+            for (int z = 0; z < zeros; z++, out++) {
+                address[2 * out] = 0;
+                address[2 * out + 1] = 0;
+            }
+        }
+        if (g < count) {
+            address[2 * out] = static_cast<uint8_t>(groups[g] >> 8);
+            address[2 * out + 1] = static_cast<uint8_t>(groups[g]);
+            out++;
+        }
+    }
+    return true;
+}
+
+} // namespace
+
+bool RDataKey::operator==(const RDataKey &key) const
+{
+    return type == key.type && text == key.text;
+}
+
+size_t hash_value(const RDataKey &key)
+{
+    size_t seed = boost::hash_value(key.text);
+    boost::hash_combine(seed, static_cast<int>(key.type));
+    return seed;
+}
+
+RData::RData(const RDataKey &key) : key(key)
+{
+    switch (key.type) {
+    case RRType::NS:
+    case RRType::CNAME:
+    case RRType::DNAME:
+        target = LabelUtils::StringToLabels(key.text);
+        break;
+    case RRType::MX: {
+        // The exchange follows the preference.
+        size_t start = key.text.find_last_of(" \t");
+        target = LabelUtils::StringToLabels(start == string::npos ? key.text : key.text.substr(start + 1));
+        break;
+    }
+    case RRType::A:
+        if (ParseIPv4(key.text, address.data())) {
+            address_length = 4;
+        }
+        break;
+    case RRType::AAAA:
+        if (ParseIPv6(key.text, address.data())) {
+            address_length = 16;
+        }
+        break;
+    default:
+        break;
+    }
+}
+
 ResourceRecord::ResourceRecord(string name, string type, uint16_t class_, uint32_t ttl, string rdata)
     : name_(LabelUtils::StringToLabels(name)), type_(TypeUtils::StringToType(type)), class_(class_), ttl_(ttl),
-      rdata_(rdata)
+      rdata_(RDataKey{type_, std::move(rdata)})
+{
+}
+
+ResourceRecord::ResourceRecord(DomainName name, RRType type, uint16_t class_, uint32_t ttl, string rdata)
+    : name_(std::move(name)), type_(type), class_(class_), ttl_(ttl), rdata_(RDataKey{type, std::move(rdata)})
 {
 }
 
 bool ResourceRecord::operator==(const ResourceRecord &l1) const
 {
-    if (name_ == l1.get_name() && rdata_ == l1.get_rdata() && type_ == l1.get_type()) {
-        // ignoring ttl_ == l1.get_ttl()
-        return true;
+    if (name_ == l1.name_ && type_ == l1.type_) {
+        // ignoring ttl_ == l1.get_ttl(); addresses written differently are still the same address.
+        return rdata_ == l1.rdata_ || (get_address().size() && get_address() == l1.get_address());
     }
     return false;
 }
 
 ostream &operator<<(ostream &os, const ResourceRecord &rr)
 {
-    os << LabelUtils::LabelsToString(rr.name_) << '\t' << rr.type_ << '\t' << rr.rdata_ << endl;
+    os << LabelUtils::LabelsToString(rr.name_) << '\t' << rr.type_ << '\t' << rr.get_rdata() << endl;
     return os;
 }
 
-string ResourceRecord::toString()
+string ResourceRecord::toString() const
 {
     std::bitset<RRType::N> rrTypes;
     rrTypes.set(type_);
-    return LabelUtils::LabelsToString(name_) + "   " + TypeUtils::TypesToString(rrTypes) + "   " + rdata_.get();
+    return LabelUtils::LabelsToString(name_) + "   " + TypeUtils::TypesToString(rrTypes) + "   " + get_rdata();
 }
 
-vector<NodeLabel> ResourceRecord::get_name() const
+const DomainName &ResourceRecord::get_name() const
 {
     return name_;
 }
@@ -49,9 +199,20 @@ uint32_t ResourceRecord::get_ttl() const
     return ttl_;
 }
 
-string ResourceRecord::get_rdata() const
+const string &ResourceRecord::get_rdata() const
+{
+    return rdata_.get().key.text;
+}
+
+const DomainName &ResourceRecord::get_target() const
+{
+    return rdata_.get().target;
+}
+
+string_view ResourceRecord::get_address() const
 {
-    return rdata_;
+    const RData &rdata = rdata_.get();
+    return string_view(reinterpret_cast<const char *>(rdata.address.data()), rdata.address_length);
 }
 
 void ResourceRecord::set_name(string name)
@@ -62,6 +223,7 @@ void ResourceRecord::set_name(string name)
 void ResourceRecord::set_type(string type)
 {
     type_ = TypeUtils::StringToType(type);
+    rdata_ = SharedRData(RDataKey{type_, get_rdata()});
 }
 
 void ResourceRecord::set_class(uint16_t class_)
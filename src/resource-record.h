@@ -1,44 +1,99 @@
 #ifndef RESOURCE_RECORD_H_
 #define RESOURCE_RECORD_H_
 
-#include "node-label.h"
+#include <array>
+#include <boost/flyweight/key_value.hpp>
+
+#include "domain-name.h"
 
 enum RRClass { CLASS_IN = 1, CLASS_CH = 3 };
 
 enum RRType { A, NS, CNAME, DNAME, SOA, PTR, MX, TXT, AAAA, SRV, RRSIG, NSEC, SPF, N };
 
+struct RDataKey {
+    RRType type = RRType::N;
+    string text;
+
+    bool operator==(const RDataKey &) const;
+};
+
+size_t hash_value(const RDataKey &);
+
+// The rdata of a record as written in the zone file, along with the parts of it groot reads: the target name of an NS,
+// CNAME, DNAME or MX record and the address of an A or AAAA record in network byte order (address_length is 0 for the
+// other types and for an address that does not parse).
+struct RData {
+    RDataKey key;
+    DomainName target;
+    std::array<uint8_t, 16> address{};
+    uint8_t address_length = 0;
+
+    explicit RData(const RDataKey &);
+};
+
+struct RDataKeyExtractor {
+    const RDataKey &operator()(const RData &rdata) const
+    {
+        return rdata.key;
+    }
+};
+
 class ResourceRecord
 {
   public:
     ResourceRecord(string name, string type, uint16_t class_, uint32_t ttl, string rdata);
+    ResourceRecord(DomainName name, RRType type, uint16_t class_, uint32_t ttl, string rdata);
     bool operator==(const ResourceRecord &l1) const;
-    vector<NodeLabel> get_name() const;
+    const DomainName &get_name() const;
     RRType get_type() const;
     uint16_t get_class() const;
     uint32_t get_ttl() const;
-    string get_rdata() const;
+    const string &get_rdata() const;
+    // The target name of an NS, CNAME, DNAME or MX record; empty for the other types.
+    const DomainName &get_target() const;
+    // The packed address of an A or AAAA record; empty for the other types.
+    string_view get_address() const;
     void set_name(string);
     void set_type(string);
     void set_class(uint16_t);
     void set_ttl(uint32_t);
-    string toString();
+    string toString() const;
     friend ostream &operator<<(ostream &os, const ResourceRecord &rr);
 
   private:
-    vector<NodeLabel> name_;
+    DomainName name_;
     RRType type_;
     uint16_t class_;
     uint32_t ttl_;
-    boost::flyweight<std::string, boost::flyweights::tag<string>, boost::flyweights::no_tracking> rdata_;
+    // Records with the same type and rdata share one parsed RData, so the rdata is parsed when it is first seen and two
+    // rdatas compare equal exactly when they are the same object.
+    using SharedRData = boost::flyweight<
+        boost::flyweights::key_value<RDataKey, RData, RDataKeyExtractor>,
+        boost::flyweights::tag<RData>,
+        boost::flyweights::no_tracking>;
+    SharedRData rdata_;
+    // Only used by boost::serialization to construct records before loading them.
+    ResourceRecord() = default;
     friend class boost::serialization::access;
-    template <typename Archive> void serialize(Archive &ar, const unsigned int version)
+    template <typename Archive> void save(Archive &ar, const unsigned int version) const
+    {
+        ar &name_;
+        ar &type_;
+        ar &class_;
+        ar &ttl_;
+        ar &rdata_.get().key.text;
+    }
+    template <typename Archive> void load(Archive &ar, const unsigned int version)
     {
         ar &name_;
         ar &type_;
         ar &class_;
         ar &ttl_;
-        ar &rdata_;
+        string rdata;
+        ar &rdata;
+        rdata_ = SharedRData(RDataKey{type_, std::move(rdata)});
     }
+    BOOST_SERIALIZATION_SPLIT_MEMBER()
 };
 
 class rrHash
@@ -46,11 +101,11 @@ class rrHash
   public:
     size_t operator()(const ResourceRecord &l1) const
     {
-        vector<NodeLabel> labels = l1.get_name();
+        const DomainName &labels = l1.get_name();
         int hash = 0;
         int err = 1;
         for (NodeLabel n : labels) {
-            hash = hash + n.get().size() * err;
+            hash = hash + n.length() * err;
             err++;
         }
         return hash % 32;
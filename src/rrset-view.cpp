@@ -0,0 +1,138 @@
+#include "rrset-view.h"
+
+RRSetView::const_iterator::const_iterator(const RRSetView *view, size_t part) : view_(view), part_(part)
+{
+    if (part_ < view_->parts_.size()) {
+        position_ = view_->parts_[part_].begin;
+        SkipUnselected();
+    }
+}
+
+void RRSetView::const_iterator::SkipUnselected()
+{
+    while (part_ < view_->parts_.size()) {
+        const Part &part = view_->parts_[part_];
+        if (position_ == part.end) {
+            part_++;
+            position_ = part_ < view_->parts_.size() ? view_->parts_[part_].begin : 0;
+        } else if (part.Selects((*part.records)[position_])) {
+            return;
+        } else {
+            position_++;
+        }
+    }
+}
+
+RRSetView::const_iterator::reference RRSetView::const_iterator::operator*() const
+{
+    return (*view_->parts_[part_].records)[position_];
+}
+
+RRSetView::const_iterator::pointer RRSetView::const_iterator::operator->() const
+{
+    return &**this;
+}
+
+RRSetView::const_iterator &RRSetView::const_iterator::operator++()
+{
+    position_++;
+    SkipUnselected();
+    return *this;
+}
+
+RRSetView::const_iterator RRSetView::const_iterator::operator++(int)
+{
+    const_iterator it = *this;
+    ++*this;
+    return it;
+}
+
+bool RRSetView::const_iterator::operator==(const const_iterator &it) const
+{
+    return part_ == it.part_ && position_ == it.position_;
+}
+
+bool RRSetView::const_iterator::operator!=(const const_iterator &it) const
+{
+    return !(*this == it);
+}
+
+RRSetView::RRSetView(vector<ResourceRecord> records)
+{
+    size_t size = records.size();
+    AddPart({std::make_shared<const vector<ResourceRecord>>(std::move(records)), 0, static_cast<uint32_t>(size), false,
+             {}});
+}
+
+RRSetView::RRSetView(Storage records, size_t begin, size_t end)
+{
+    AddPart({std::move(records), static_cast<uint32_t>(begin), static_cast<uint32_t>(end), false, {}});
+}
+
+RRSetView::RRSetView(Storage records, size_t begin, size_t end, std::bitset<RRType::N> types)
+{
+    AddPart({std::move(records), static_cast<uint32_t>(begin), static_cast<uint32_t>(end), true, types});
+}
+
+void RRSetView::AddPart(Part part)
+{
+    size_t count = 0;
+    for (uint32_t i = part.begin; i < part.end; i++) {
+        if (part.Selects((*part.records)[i])) {
+            count++;
+        }
+    }
+    // Parts without records would only slow the iteration down.
+    if (count) {
+        size_ += count;
+        parts_.push_back(std::move(part));
+    }
+}
+
+void RRSetView::Append(const RRSetView &view)
+{
+    for (const Part &part : view.parts_) {
+        parts_.push_back(part);
+    }
+    size_ += view.size_;
+}
+
+size_t RRSetView::size() const
+{
+    return size_;
+}
+
+bool RRSetView::empty() const
+{
+    return size_ == 0;
+}
+
+const ResourceRecord &RRSetView::front() const
+{
+    return *begin();
+}
+
+RRSetView::const_iterator RRSetView::begin() const
+{
+    return const_iterator(this, 0);
+}
+
+RRSetView::const_iterator RRSetView::end() const
+{
+    return const_iterator(this, parts_.size());
+}
+
+vector<ResourceRecord> RRSetView::ToVector() const
+{
+    return vector<ResourceRecord>(begin(), end());
+}
+
+bool RRSetView::operator==(const RRSetView &view) const
+{
+    return size_ == view.size_ && std::equal(begin(), end(), view.begin());
+}
+
+bool RRSetView::operator!=(const RRSetView &view) const
+{
+    return !(*this == view);
+}
@@ -0,0 +1,98 @@
+#ifndef RRSET_VIEW_H_
+#define RRSET_VIEW_H_
+
+#include <bitset>
+#include <boost/container/small_vector.hpp>
+#include <iterator>
+
+#include "resource-record.h"
+
+// Read-only records of a lookup answer. The records stay in the immutable storage the zone graph shares out, so copying
+// an answer copies a few pointers and not the records. A view is a sequence of parts, each a contiguous run of some
+// storage that may be restricted to the records whose type is in a mask; the requested types of a node are selected
+// that way without copying its records.
+class RRSetView
+{
+  public:
+    using Storage = std::shared_ptr<const vector<ResourceRecord>>;
+
+  private:
+    struct Part {
+        Storage records;
+        uint32_t begin;
+        uint32_t end;
+        bool filtered;
+        std::bitset<RRType::N> types;
+
+        bool Selects(const ResourceRecord &rr) const
+        {
+            return !filtered || (rr.get_type() != RRType::N && types[rr.get_type()]);
+        }
+    };
+
+    boost::container::small_vector<Part, 2> parts_;
+    size_t size_ = 0;
+
+    void AddPart(Part);
+
+    friend class boost::serialization::access;
+    template <typename Archive> void save(Archive &ar, const unsigned int version) const
+    {
+        vector<ResourceRecord> records = ToVector();
+        ar &records;
+    }
+    template <typename Archive> void load(Archive &ar, const unsigned int version)
+    {
+        vector<ResourceRecord> records;
+        ar &records;
+        *this = RRSetView(std::move(records));
+    }
+    BOOST_SERIALIZATION_SPLIT_MEMBER()
+
+  public:
+    class const_iterator
+    {
+        const RRSetView *view_ = nullptr;
+        size_t part_ = 0;
+        uint32_t position_ = 0;
+
+        void SkipUnselected();
+
+      public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = ResourceRecord;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const ResourceRecord *;
+        using reference = const ResourceRecord &;
+
+        const_iterator() = default;
+        const_iterator(const RRSetView *, size_t);
+        reference operator*() const;
+        pointer operator->() const;
+        const_iterator &operator++();
+        const_iterator operator++(int);
+        bool operator==(const const_iterator &) const;
+        bool operator!=(const const_iterator &) const;
+    };
+
+    RRSetView() = default;
+    // Owns a copy of records that no zone graph holds.
+    explicit RRSetView(vector<ResourceRecord>);
+    // The records begin to end - 1 of the storage, all of them or only those with a type in types.
+    RRSetView(Storage, size_t begin, size_t end);
+    RRSetView(Storage, size_t begin, size_t end, std::bitset<RRType::N> types);
+
+    // Adds the records of the view after the records of this one.
+    void Append(const RRSetView &);
+
+    size_t size() const;
+    bool empty() const;
+    const ResourceRecord &front() const;
+    const_iterator begin() const;
+    const_iterator end() const;
+    vector<ResourceRecord> ToVector() const;
+    bool operator==(const RRSetView &) const;
+    bool operator!=(const RRSetView &) const;
+};
+
+#endif
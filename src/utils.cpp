@@ -1,6 +1,7 @@
 #include "utils.h"
+#include "lint-sink.h"
 
-string LabelUtils::LabelsToString(vector<NodeLabel> domain_name)
+string LabelUtils::LabelsToString(const DomainName &domain_name)
 {
     string domain = "";
     if (domain_name.size() == 0) {
@@ -13,7 +14,7 @@ string LabelUtils::LabelsToString(vector<NodeLabel> domain_name)
     return domain;
 }
 
-string LabelUtils::LabelsToString(vector<vector<NodeLabel>> domains)
+string LabelUtils::LabelsToString(const vector<DomainName> &domains)
 {
     string result = "[";
     for (auto &d : domains) {
@@ -24,11 +25,10 @@ string LabelUtils::LabelsToString(vector<vector<NodeLabel>> domains)
     return result + "]";
 }
 
-tuple<bool, string> LabelUtils::LengthCheck(vector<NodeLabel> domain_labels, int level)
+tuple<bool, string> LabelUtils::LengthCheck(const DomainName &domain_labels, int level)
 {
-    int length = 0;
-    for (NodeLabel &l : domain_labels) {
-        if (l.get().length() > kMaxLabelLength) {
+    for (const NodeLabel &l : domain_labels) {
+        if (l.length() > kMaxLabelLength) {
             if (level == 2) {
                 Logger->warn(fmt::format(
                     "label-graph.cpp (GenerateECs) - Userinput, {}, has a label, {}, exceedeing the valid label length",
@@ -36,9 +36,9 @@ tuple<bool, string> LabelUtils::LengthCheck(vector<NodeLabel> domain_labels, int
             }
             return {false, l.get()};
         }
-        length += l.get().length() + 1;
     }
-    if (length > kMaxDomainLength) {
+    // The length of the name with a dot after every label, which is one less than its wire format length.
+    if (domain_labels.wire_length() - 1 > kMaxDomainLength) {
         if (level == 2) {
             Logger->warn(fmt::format(
                 "label-graph.cpp (GenerateECs) - Userinput, {}, exceedes the valid domain length",
@@ -49,11 +49,11 @@ tuple<bool, string> LabelUtils::LengthCheck(vector<NodeLabel> domain_labels, int
     return {true, ""};
 }
 
-vector<NodeLabel> LabelUtils::StringToLabels(string domain_name)
+DomainName LabelUtils::StringToLabels(string domain_name)
 {
-    vector<NodeLabel> tokens;
+    DomainName::Labels tokens;
     if (domain_name.length() == 0) {
-        return tokens;
+        return DomainName();
     }
     if (domain_name[domain_name.length() - 1] != '.') {
         domain_name += ".";
@@ -66,31 +66,22 @@ vector<NodeLabel> LabelUtils::StringToLabels(string domain_name)
             if (previous.back() == '\\') {
                 previous += *it;
             } else {
-                tokens.push_back(std::move(previous));
+                tokens.push_back(NodeLabel(previous));
                 previous = "";
             }
         } else {
             previous += *it;
         }
     }
-    std::reverse(tokens.begin(), tokens.end());
-    return tokens;
+    return DomainName(tokens.rbegin(), tokens.rend());
 }
 
-bool LabelUtils::SubDomainCheck(const vector<NodeLabel> &domain, const vector<NodeLabel> &subdomain)
+bool LabelUtils::SubDomainCheck(const DomainName &domain, const DomainName &subdomain)
 {
-    if (domain.size() > subdomain.size()) {
-        return false;
-    }
-    for (int i = 0; i < domain.size(); i++) {
-        if (!(domain[i] == subdomain[i])) {
-            return false;
-        }
-    }
-    return true;
+    return subdomain.IsSubDomainOf(domain);
 }
 
-bool LabelUtils::SubDomainCheck(const vector<vector<NodeLabel>> &allowed_domains, const vector<NodeLabel> &subdomain)
+bool LabelUtils::SubDomainCheck(const vector<DomainName> &allowed_domains, const DomainName &subdomain)
 {
     bool any_subdomain = false;
     for (auto &d : allowed_domains) {
@@ -185,28 +176,23 @@ CommonSymDiff RRUtils::CompareRRs(vector<ResourceRecord> res_a, vector<ResourceR
     return std::make_tuple(common, res_a, res_b);
 }
 
+json LintUtils::RRIssue(string file_name, size_t line, string current_rr, string violation, string previous_rr)
+{
+    json tmp;
+    tmp["File Name"] = file_name;
+    tmp["Line Number"] = line;
+    tmp["Current Record"] = current_rr;
+    tmp["Violation"] = violation;
+    if (previous_rr.length()) {
+        tmp["Previous Record"] = previous_rr;
+    }
+    return tmp;
+}
+
 void LintUtils::WriteIssueToFile(json &log_line, bool lint)
 {
-    int i = 0;
     if (lint) {
-        std::fstream in("lint.json", ios::in);
-        if (in.is_open()) {
-            string tp;
-
-            while (getline(in, tp)) {
-                i++;
-                if (i > 3)
-                    break;
-            }
-            in.close();
-        } else {
-            Logger->error("Linting enabled but unable to open the lint.txt file for reading");
-        }
-        std::ofstream out("lint.json", ios::app);
-        if (i > 3)
-            out << ",\n";
-        out << log_line.dump(4);
-        out.close();
+        Lint->Write(log_line);
     }
 }
 
@@ -219,14 +205,7 @@ void LintUtils::WriteRRIssueToFile(
     string previous_rr)
 {
     if (lint) {
-        json tmp;
-        tmp["File Name"] = file_name;
-        tmp["Line Number"] = line;
-        tmp["Current Record"] = current_rr;
-        tmp["Violation"] = violation;
-        if (previous_rr.length()) {
-            tmp["Previous Record"] = previous_rr;
-        }
+        json tmp = RRIssue(file_name, line, current_rr, violation, previous_rr);
         WriteIssueToFile(tmp, lint);
     }
 }
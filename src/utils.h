@@ -8,12 +8,12 @@
 class LabelUtils
 {
   public:
-    static string LabelsToString(vector<NodeLabel>);
-    static string LabelsToString(vector<vector<NodeLabel>>);
-    static tuple<bool, string> LengthCheck(vector<NodeLabel>, int);
-    static vector<NodeLabel> StringToLabels(string);
-    static bool SubDomainCheck(const vector<NodeLabel> &, const vector<NodeLabel> &);
-    static bool SubDomainCheck(const vector<vector<NodeLabel>> &, const vector<NodeLabel> &);
+    static string LabelsToString(const DomainName &);
+    static string LabelsToString(const vector<DomainName> &);
+    static tuple<bool, string> LengthCheck(const DomainName &, int);
+    static DomainName StringToLabels(string);
+    static bool SubDomainCheck(const DomainName &, const DomainName &);
+    static bool SubDomainCheck(const vector<DomainName> &, const DomainName &);
 };
 
 class TypeUtils
@@ -35,6 +35,7 @@ class RRUtils
 class LintUtils
 {
   public:
+    static json RRIssue(string, size_t, string, string, string);
     static void WriteIssueToFile(json &, bool);
     static void WriteRRIssueToFile(bool, string, size_t, string, string, string);
 };
@@ -0,0 +1,303 @@
+#include "zone-cache.h"
+
+#include <boost/filesystem.hpp>
+#include <cstring>
+#include <fstream>
+
+#include "driver.h"
+#include "utils.h"
+#include "zone-file-buffer.h"
+
+namespace
+{
+
+const uint32_t kZoneCacheMagic = 0x43525a47; // "GZRC"
+// Bump whenever the entry layout or the parser output changes.
+const uint32_t kZoneCacheVersion = 1;
+
+inline uint64_t RotateLeft(uint64_t x, int r)
+{
+    return (x << r) | (x >> (64 - r));
+}
+
+inline uint64_t Mix(uint64_t k)
+{
+    k *= 0x87c37b91114253d5ULL;
+    k = RotateLeft(k, 31);
+    return k * 0x4cf5ad432745937fULL;
+}
+
+template <typename T> void Put(std::string &out, T value)
+{
+    out.append(reinterpret_cast<const char *>(&value), sizeof(T));
+}
+
+void PutString(std::string &out, const std::string &s)
+{
+    Put<uint32_t>(out, static_cast<uint32_t>(s.size()));
+    out += s;
+}
+
+// Bounds checked reader over a cache entry. Once a read runs past the end every further read returns zero values and
+// ok() is false.
+class EntryReader
+{
+  private:
+    std::string_view data_;
+    size_t position_ = 0;
+    bool ok_ = true;
+
+  public:
+    explicit EntryReader(std::string_view data) : data_(data)
+    {
+    }
+
+    template <typename T> T Get()
+    {
+        T value{};
+        if (ok_ && data_.size() - position_ >= sizeof(T)) {
+            std::memcpy(&value, data_.data() + position_, sizeof(T));
+            position_ += sizeof(T);
+        } else {
+            ok_ = false;
+        }
+        return value;
+    }
+
+    std::string GetString()
+    {
+        uint32_t length = Get<uint32_t>();
+        if (ok_ && data_.size() - position_ >= length) {
+            position_ += length;
+            return std::string(data_.substr(position_ - length, length));
+        }
+        ok_ = false;
+        return "";
+    }
+
+    bool ok() const
+    {
+        return ok_;
+    }
+
+    bool AtEnd() const
+    {
+        return position_ == data_.size();
+    }
+};
+
+bool CorruptedEntry(const boost::filesystem::path &path, const MiniContext &mc)
+{
+    Logger->warn(fmt::format(
+        "zone-cache.cpp (Load) - Cache entry {} is corrupted, parsing zone file {} instead", path.string(),
+        mc.file_name));
+    return false;
+}
+
+} // namespace
+
+ZoneCache::ZoneCache(std::string directory) : directory_(directory)
+{
+    boost::system::error_code ec;
+    boost::filesystem::create_directories(directory_, ec);
+    if (ec || !boost::filesystem::is_directory(directory_)) {
+        Logger->critical(
+            fmt::format("zone-cache.cpp (ZoneCache) - Unable to use {} as the zone cache directory", directory));
+        std::exit(EXIT_FAILURE);
+    }
+}
+
+uint64_t ZoneCache::Hash(std::string_view data)
+{
+    // 64-bit MurmurHash3 style hash of the contents, eight bytes at a time.
+    const char *p = data.data();
+    size_t n = data.size();
+    uint64_t h = n * 0x9e3779b97f4a7c15ULL;
+    for (; n >= 8; p += 8, n -= 8) {
+        uint64_t k;
+        std::memcpy(&k, p, 8);
+        h ^= Mix(k);
+        h = RotateLeft(h, 27) * 5 + 0x52dce729;
+    }
+    if (n > 0) {
+        uint64_t k = 0;
+        std::memcpy(&k, p, n);
+        h ^= Mix(k);
+    }
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdULL;
+    h ^= h >> 33;
+    h *= 0xc4ceb9fe1a85ec53ULL;
+    h ^= h >> 33;
+    return h;
+}
+
+boost::filesystem::path ZoneCache::GetEntryPath(uint64_t contents_hash, const std::string &origin, bool lint) const
+{
+    return directory_ / fmt::format(
+                            "{:016x}-{:08x}{}.zone", contents_hash, static_cast<uint32_t>(Hash(origin)),
+                            lint ? "-lint" : "");
+}
+
+bool ZoneCache::Load(
+    uint64_t contents_hash,
+    size_t contents_size,
+    const std::string &origin,
+    zone::Graph &zone_graph,
+    MiniContext &mc) const
+{
+    boost::filesystem::path path = GetEntryPath(contents_hash, origin, mc.lint);
+    boost::system::error_code ec;
+    if (!boost::filesystem::is_regular_file(path, ec)) {
+        return false;
+    }
+    ZoneFileBuffer buffer(path.string());
+    EntryReader reader(buffer.get_contents());
+    if (reader.Get<uint32_t>() != kZoneCacheMagic || reader.Get<uint32_t>() != kZoneCacheVersion ||
+        reader.Get<uint64_t>() != contents_size || reader.Get<uint64_t>() != contents_hash ||
+        reader.GetString() != origin || reader.Get<uint8_t>() != mc.lint) {
+        Logger->debug(fmt::format(
+            "zone-cache.cpp (Load) - Cache entry {} does not match zone file {}", path.string(), mc.file_name));
+        return false;
+    }
+
+    bool found_SOA = reader.Get<uint8_t>();
+    bool parsed_completely = reader.Get<uint8_t>();
+    uint64_t lines = reader.Get<uint64_t>();
+    int32_t rrs_parsed = reader.Get<int32_t>();
+    std::unordered_map<string, long> type_to_count;
+    for (uint32_t i = reader.Get<uint32_t>(); i > 0 && reader.ok(); i--) {
+        string type = reader.GetString();
+        type_to_count[type] = static_cast<long>(reader.Get<int64_t>());
+    }
+    // Every distinct label is interned once instead of once per record.
+    vector<NodeLabel> labels;
+    for (uint32_t i = reader.Get<uint32_t>(); i > 0 && reader.ok(); i--) {
+        labels.emplace_back(reader.GetString());
+    }
+    vector<ResourceRecord> records;
+    for (uint64_t i = reader.Get<uint64_t>(); i > 0 && reader.ok(); i--) {
+        DomainName name;
+        for (uint8_t j = reader.Get<uint8_t>(); j > 0 && reader.ok(); j--) {
+            uint32_t index = reader.Get<uint32_t>();
+            if (index >= labels.size()) {
+                return CorruptedEntry(path, mc);
+            }
+            name.push_back(labels[index]);
+        }
+        uint8_t type = reader.Get<uint8_t>();
+        uint16_t class_ = reader.Get<uint16_t>();
+        uint32_t ttl = reader.Get<uint32_t>();
+        string rdata = reader.GetString();
+        // RRType::N stands for the types groot does not model (DS for instance).
+        if (type > RRType::N) {
+            return CorruptedEntry(path, mc);
+        }
+        records.emplace_back(std::move(name), static_cast<RRType>(type), class_, ttl, rdata);
+    }
+    vector<json> lint_issues;
+    for (uint64_t i = reader.Get<uint64_t>(); i > 0 && reader.ok(); i--) {
+        size_t line = reader.Get<uint64_t>();
+        string current_rr = reader.GetString();
+        string violation = reader.GetString();
+        string previous_rr = reader.GetString();
+        lint_issues.push_back(LintUtils::RRIssue(mc.file_name, line, current_rr, violation, previous_rr));
+    }
+    if (!reader.ok() || !reader.AtEnd()) {
+        return CorruptedEntry(path, mc);
+    }
+
+    // The records are exactly the ones the parser added, in the same order, so they add up to the same zone graph.
+    auto results = zone_graph.AddResourceRecords(records);
+    for (size_t i = 0; i < records.size(); i++) {
+        auto [code, vertexid] = results[i];
+        if (code != zone::RRAddCode::SUCCESS) {
+            Logger->critical(fmt::format(
+                "zone-cache.cpp (Load) - Unable to add a cached record of zone file {} from {}", mc.file_name,
+                path.string()));
+            std::exit(EXIT_FAILURE);
+        }
+        mc.label_graph_records.push_back({std::move(records[i]), vertexid.get()});
+    }
+    mc.found_SOA = found_SOA;
+    mc.parsed_completely = parsed_completely;
+    mc.lines = lines;
+    mc.rrs_parsed = rrs_parsed;
+    mc.type_to_count = std::move(type_to_count);
+    mc.lint_issues = std::move(lint_issues);
+    Logger->debug(fmt::format("zone-cache.cpp (Load) - Loaded zone file {} from the cache", mc.file_name));
+    return true;
+}
+
+void ZoneCache::Store(
+    uint64_t contents_hash,
+    size_t contents_size,
+    const std::string &origin,
+    const MiniContext &mc) const
+{
+    string entry;
+    Put<uint32_t>(entry, kZoneCacheMagic);
+    Put<uint32_t>(entry, kZoneCacheVersion);
+    Put<uint64_t>(entry, contents_size);
+    Put<uint64_t>(entry, contents_hash);
+    PutString(entry, origin);
+    Put<uint8_t>(entry, mc.lint);
+
+    Put<uint8_t>(entry, mc.found_SOA);
+    Put<uint8_t>(entry, mc.parsed_completely);
+    Put<uint64_t>(entry, mc.lines);
+    Put<int32_t>(entry, mc.rrs_parsed);
+    Put<uint32_t>(entry, static_cast<uint32_t>(mc.type_to_count.size()));
+    for (auto &[type, count] : mc.type_to_count) {
+        PutString(entry, type);
+        Put<int64_t>(entry, count);
+    }
+    std::unordered_map<string, uint32_t> label_index;
+    string labels;
+    string records;
+    Put<uint64_t>(records, mc.label_graph_records.size());
+    for (auto &[record, vertexid] : mc.label_graph_records) {
+        const DomainName &name = record.get_name();
+        Put<uint8_t>(records, static_cast<uint8_t>(name.size()));
+        for (auto &label : name) {
+            auto [it, inserted] = label_index.insert({label.get(), static_cast<uint32_t>(label_index.size())});
+            if (inserted) {
+                PutString(labels, it->first);
+            }
+            Put<uint32_t>(records, it->second);
+        }
+        Put<uint8_t>(records, static_cast<uint8_t>(record.get_type()));
+        Put<uint16_t>(records, record.get_class());
+        Put<uint32_t>(records, record.get_ttl());
+        PutString(records, record.get_rdata());
+    }
+    Put<uint32_t>(entry, static_cast<uint32_t>(label_index.size()));
+    entry += labels;
+    entry += records;
+    Put<uint64_t>(entry, mc.lint_issues.size());
+    for (auto &issue : mc.lint_issues) {
+        Put<uint64_t>(entry, issue["Line Number"].get<uint64_t>());
+        PutString(entry, issue["Current Record"].get<string>());
+        PutString(entry, issue["Violation"].get<string>());
+        PutString(entry, issue.value("Previous Record", ""));
+    }
+
+    // Written under a unique name and renamed into place so that concurrent writers never leave a partial entry.
+    boost::filesystem::path path = GetEntryPath(contents_hash, origin, mc.lint);
+    boost::filesystem::path temporary = directory_ / boost::filesystem::unique_path("%%%%-%%%%-%%%%-%%%%.tmp");
+    boost::system::error_code ec;
+    std::ofstream out(temporary.string(), std::ios::binary | std::ios::trunc);
+    out.write(entry.data(), static_cast<std::streamsize>(entry.size()));
+    out.close();
+    if (!out) {
+        Logger->warn(fmt::format("zone-cache.cpp (Store) - Unable to write cache entry {}", temporary.string()));
+        boost::filesystem::remove(temporary, ec);
+        return;
+    }
+    boost::filesystem::rename(temporary, path, ec);
+    if (ec) {
+        Logger->warn(fmt::format(
+            "zone-cache.cpp (Store) - Unable to store zone file {} in the cache ({})", mc.file_name, ec.message()));
+        boost::filesystem::remove(temporary, ec);
+    }
+}
@@ -0,0 +1,33 @@
+#ifndef ZONE_CACHE_H_
+#define ZONE_CACHE_H_
+
+#include <boost/filesystem/path.hpp>
+#include <string>
+#include <string_view>
+
+#include "zone-graph.h"
+
+struct MiniContext;
+
+// On-disk cache of parsed zone files. Each entry is keyed by a hash of the zone file contents (together with the
+// origin and the lint flag the file was parsed with) and holds the records that were added to the zone graph, the
+// lint issues and the parse statistics, so an unchanged zone file is rebuilt without lexing it again.
+class ZoneCache
+{
+  private:
+    boost::filesystem::path directory_;
+
+    boost::filesystem::path GetEntryPath(uint64_t, const std::string &, bool) const;
+
+  public:
+    explicit ZoneCache(std::string);
+
+    static uint64_t Hash(std::string_view);
+    // Rebuilds the zone graph and the parse summary of a zone file with the given contents hash and size. Returns
+    // false (leaving both untouched) if there is no usable entry. The file name and the lint flag are taken from the
+    // MiniContext.
+    bool Load(uint64_t, size_t, const std::string &, zone::Graph &, MiniContext &) const;
+    void Store(uint64_t, size_t, const std::string &, const MiniContext &) const;
+};
+
+#endif
@@ -0,0 +1,57 @@
+#include "zone-file-buffer.h"
+
+#include <boost/filesystem.hpp>
+#include <fstream>
+#include <iterator>
+
+#include "my-logger.h"
+
+ZoneFileBuffer::ZoneFileBuffer(const std::string &file)
+{
+    boost::system::error_code ec;
+    if (!boost::filesystem::is_regular_file(file, ec)) {
+        ReadFromStream(file);
+        return;
+    }
+    if (boost::filesystem::file_size(file, ec) == 0 || ec) {
+        // An empty file cannot be mapped.
+        ReadFromStream(file);
+        return;
+    }
+    try {
+        boost::interprocess::file_mapping mapping(file.c_str(), boost::interprocess::read_only);
+        boost::interprocess::mapped_region region(mapping, boost::interprocess::read_only);
+        region.advise(boost::interprocess::mapped_region::advice_sequential);
+        mapping_.swap(mapping);
+        region_.swap(region);
+        view_ = std::string_view(static_cast<const char *>(region_.get_address()), region_.get_size());
+    } catch (const boost::interprocess::interprocess_exception &e) {
+        Logger->debug(fmt::format(
+            "zone-file-buffer.cpp (ZoneFileBuffer) - Unable to map file {} ({}), reading it instead", file, e.what()));
+        ReadFromStream(file);
+    }
+}
+
+void ZoneFileBuffer::ReadFromStream(const std::string &file)
+{
+    std::ifstream instream(file, std::ios::binary);
+    if (!instream.is_open()) {
+        Logger->critical(fmt::format("zone-file-buffer.cpp (ReadFromStream) - couldn't open file {}", file));
+        exit(-1);
+    }
+    instream.unsetf(std::ios::skipws);
+    contents_.assign(std::istreambuf_iterator<char>(instream.rdbuf()), std::istreambuf_iterator<char>());
+    view_ = contents_;
+}
+
+std::string_view ZoneFileBuffer::get_contents() const
+{
+    return view_;
+}
+
+void ZoneFileBuffer::Prefetch()
+{
+    if (region_.get_size()) {
+        region_.advise(boost::interprocess::mapped_region::advice_willneed);
+    }
+}
@@ -0,0 +1,30 @@
+#ifndef ZONE_FILE_BUFFER_H_
+#define ZONE_FILE_BUFFER_H_
+
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+#include <string>
+#include <string_view>
+
+// Read-only contents of a zone file. Regular files are memory mapped so that the parser can hand out string_views
+// into the file without copying it; pipes and other non-regular files are read into an owned buffer instead.
+class ZoneFileBuffer
+{
+  private:
+    boost::interprocess::file_mapping mapping_;
+    boost::interprocess::mapped_region region_;
+    std::string contents_;
+    std::string_view view_;
+
+    void ReadFromStream(const std::string &);
+
+  public:
+    explicit ZoneFileBuffer(const std::string &);
+    ZoneFileBuffer(const ZoneFileBuffer &) = delete;
+    ZoneFileBuffer &operator=(const ZoneFileBuffer &) = delete;
+
+    std::string_view get_contents() const;
+    void Prefetch();
+};
+
+#endif
@@ -0,0 +1,60 @@
+#include "zone-file-decompressor.h"
+
+#include <boost/iostreams/device/array.hpp>
+#include <boost/iostreams/filter/gzip.hpp>
+#include <boost/iostreams/filter/zstd.hpp>
+
+#include "my-logger.h"
+
+ZoneFileDecompressor::ZoneFileDecompressor(
+    std::string_view contents,
+    Format format,
+    std::string file,
+    size_t chunk_size)
+    : file_(file), chunk_size_(chunk_size)
+{
+    if (format == Format::GZIP) {
+        in_.push(boost::iostreams::gzip_decompressor());
+    } else if (format == Format::ZSTD) {
+        in_.push(boost::iostreams::zstd_decompressor());
+    }
+    in_.push(boost::iostreams::array_source(contents.data(), contents.size()));
+    // Otherwise a decompression error would only end the stream early.
+    in_.exceptions(std::ios::badbit);
+}
+
+ZoneFileDecompressor::Format ZoneFileDecompressor::DetectFormat(std::string_view contents)
+{
+    if (contents.size() >= 2 && contents.compare(0, 2, "\x1f\x8b") == 0) {
+        return Format::GZIP;
+    }
+    if (contents.size() >= 4 && contents.compare(0, 4, "\x28\xb5\x2f\xfd") == 0) {
+        return Format::ZSTD;
+    }
+    return Format::NONE;
+}
+
+std::string_view ZoneFileDecompressor::NextChunk(size_t unused)
+{
+    // The partial line left over from the previous chunk and its unused bytes start the next one.
+    buffer_.erase(0, consumed_ - unused);
+    try {
+        while (!eof_) {
+            size_t previous_size = buffer_.size();
+            buffer_.resize(previous_size + chunk_size_);
+            in_.read(&buffer_[previous_size], static_cast<std::streamsize>(chunk_size_));
+            buffer_.resize(previous_size + static_cast<size_t>(in_.gcount()));
+            eof_ = !in_;
+            if (buffer_.find('\n', previous_size) != std::string::npos) {
+                break;
+            }
+        }
+    } catch (const std::ios_base::failure &e) {
+        // Corrupted or truncated input (gzip_error, zlib_error or zstd_error).
+        Logger->critical(fmt::format(
+            "zone-file-decompressor.cpp (NextChunk) - Unable to decompress zone file {} ({})", file_, e.what()));
+        std::exit(EXIT_FAILURE);
+    }
+    consumed_ = eof_ ? buffer_.size() : buffer_.rfind('\n') + 1;
+    return std::string_view(buffer_.data(), consumed_);
+}
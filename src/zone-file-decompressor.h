@@ -0,0 +1,44 @@
+#ifndef ZONE_FILE_DECOMPRESSOR_H_
+#define ZONE_FILE_DECOMPRESSOR_H_
+
+#include <boost/iostreams/filtering_stream.hpp>
+#include <string>
+#include <string_view>
+
+// Amount of uncompressed zone file text read at a time from a compressed zone file.
+const size_t kZoneFileStreamChunkSize = 1 << 22;
+
+// Incremental reader of a gzip or zstd compressed zone file. The compressed contents are decompressed as a stream and
+// handed out in chunks of whole lines, so only about one chunk of the uncompressed zone file is in memory at any time.
+class ZoneFileDecompressor
+{
+  public:
+    enum class Format { NONE, GZIP, ZSTD };
+
+  private:
+    boost::iostreams::filtering_istream in_;
+    std::string file_;
+    std::string buffer_;
+    size_t chunk_size_;
+    size_t consumed_ = 0;
+    bool eof_ = false;
+
+  public:
+    ZoneFileDecompressor(std::string_view, Format, std::string, size_t = kZoneFileStreamChunkSize);
+    ZoneFileDecompressor(const ZoneFileDecompressor &) = delete;
+    ZoneFileDecompressor &operator=(const ZoneFileDecompressor &) = delete;
+
+    // Recognizes the compression format from the magic number at the start of the contents.
+    static Format DetectFormat(std::string_view);
+    // Returns the next lines of the zone file, ending with a line break unless it is the last chunk. The given number
+    // of bytes at the end of the previous chunk were not used and start the next one, which always has new lines
+    // after them. The returned view is only valid until the next call and is empty once the whole file was read.
+    std::string_view NextChunk(size_t = 0);
+    // Whether the last chunk returned reaches the end of the zone file.
+    bool LastChunk() const
+    {
+        return eof_;
+    }
+};
+
+#endif
@@ -1,58 +1,137 @@
 #include <boost/algorithm/string.hpp>
 #include <boost/algorithm/string/predicate.hpp>
-#include <boost/bind.hpp>
-#include <boost/config/warning_disable.hpp>
-#include <boost/ref.hpp>
-#include <boost/spirit/include/lex_lexertl.hpp>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
 
 #include "driver.h"
 #include "utils.h"
+#include "zone-file-buffer.h"
+#include "zone-file-decompressor.h"
+#include "zone-file-tokenizer.h"
+#include "zone-file-wire-reader.h"
 
 using namespace std;
-namespace lex = boost::spirit::lex;
-
-struct MiniContext {
-    string file_name = "";
-    bool found_SOA = false;
-    bool lint = false;
-    int rrs_parsed = 0;
-    std::unordered_map<string, long> type_to_count;
+
+inline void AddLintIssue(MiniContext &mc, size_t line, string current_rr, string violation, string previous_rr)
+{
+    if (mc.lint) {
+        mc.lint_issues.push_back(LintUtils::RRIssue(mc.file_name, line, current_rr, violation, previous_rr));
+    }
+}
+
+inline void ToLowerAscii(string &s)
+{
+    for (char &c : s) {
+        if (c >= 'A' && c <= 'Z') {
+            c += 'a' - 'A';
+        }
+    }
+}
+
+inline void ToUpperAscii(string &s)
+{
+    for (char &c : s) {
+        if (c >= 'a' && c <= 'z') {
+            c -= 'a' - 'A';
+        }
+    }
+}
+
+// Case insensitive comparison against an upper case keyword.
+inline bool EqualsKeyword(string_view field, string_view keyword)
+{
+    if (field.size() != keyword.size()) {
+        return false;
+    }
+    for (size_t i = 0; i < field.size(); i++) {
+        char c = field[i];
+        if (c >= 'a' && c <= 'z') {
+            c -= 'a' - 'A';
+        }
+        if (c != keyword[i]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// A record built by the parser that is yet to be added to the zone graph.
+// Whether the text has at least the given number of lines, counting the last one even without a line break. Stops
+// looking once it has found them.
+inline bool HasAtLeastLines(string_view text, size_t lines)
+{
+    const char *p = text.data();
+    const char *end = p + text.size();
+    for (size_t found = 1; found < lines; found++) {
+        p = static_cast<const char *>(std::memchr(p, '\n', end - p));
+        if (!p) {
+            return false;
+        }
+        ++p;
+    }
+    return true;
+}
+
+struct ParsedRecord {
+    size_t line;
+    string type;
+    bool wildcard;
+    ResourceRecord RR;
+    // Set (with the lint message) when the record fails a length check and is not added to the zone.
+    string count_key;
+    string violation;
 };
 
-enum TokenIds {
-    ID_COMMENT = 1000, // a comment block
-    ID_LPAREN,         // a left open parenthesis
-    ID_RPAREN,         // a right close parenthesis
-    ID_TEXT_WORD,      // TXT rdata
-    ID_WORD,           // a collection of non-space/newline characters
-    ID_EOL,            // a newline token
-    ID_WHITESPACE,     // some collection of whitespace
-    ID_OTHER           // any other character
+// The part of the parser state that is carried from one record to the next.
+struct ParserState {
+    string relative_domain_suffix;
+    // Owner name and TTL for the records which do not specify them.
+    string default_owner = ".";
+    uint32_t default_ttl = 0;
 };
 
-template <typename Lexer> struct zone_file_tokens : lex::lexer<Lexer> {
-    zone_file_tokens()
+// Bits for the parts of ParserState.
+const unsigned kSuffixState = 1;
+const unsigned kOwnerState = 2;
+const unsigned kTtlState = 4;
+
+struct Parser {
+    // mutable state that will be updated by the parser.
+    size_t l = 0;
+    int paren_count = 0;
+    string relative_domain_suffix;
+    // Owner name and TTL for the records which do not specify them.
+    string default_owner = ".";
+    uint32_t default_ttl = 0;
+    // The parts of the state set so far, and those read before they were set. ParseZoneFileInChunks builds the records
+    // of a chunk from a guess of the state at its start, which only has to be right for the parts in state_read.
+    unsigned state_set = 0;
+    unsigned state_read = 0;
+    vector<string_view> current_record;
+    zone::Graph &z;
+    MiniContext &mc;
+    // When set, the records are collected there instead of being added to the zone graph, and the messages are kept
+    // in deferred_logs instead of being logged.
+    vector<ParsedRecord> *parsed_records = nullptr;
+    vector<pair<spdlog::level::level_enum, string>> *deferred_logs = nullptr;
+    // Owned copies of the fields of a record that continues past the end of a chunk of a compressed zone file.
+    std::deque<string> detached_fields;
+    // When set, the records added to the zone graph go straight into this label graph instead of being collected in
+    // mc.label_graph_records for Driver::MergeZone.
+    label::Graph *label_graph = nullptr;
+    // For every vertex, the type of the first record added to it (-1 for none). The zone graph keeps the records of a
+    // node sorted by type and those of a type in order, so this is how a conflict is reported against the record that
+    // came first.
+    vector<int8_t> first_types;
+
+    Parser(zone::Graph &z, MiniContext &mc, const string &origin, label::Graph *label_graph = nullptr)
+        : relative_domain_suffix(origin), z(z), mc(mc), label_graph(label_graph)
     {
-        this->self.add("\\\"[^\\\"]*\\\"", ID_TEXT_WORD)(";[^\n]+", ID_COMMENT)(
-            "((\\\\\\()*(\\\\\\))*[^ ;\t\r\n\\(\\)\\\"]+)+",
-            ID_WORD)("\\(", ID_LPAREN)("\\)", ID_RPAREN)("\n", ID_EOL)("[ \t]+", ID_WHITESPACE)(".", ID_OTHER);
     }
-};
 
-struct Parser {
-    typedef bool result_type;
-    // Can only take at max ten parameters
-    template <typename Token>
-    bool operator()(
-        Token const &t,
-        size_t &l,
-        int &paren_count,
-        string &relative_domain_suffix,
-        ResourceRecord &default_values,
-        vector<string> &current_record,
-        label::Graph &label_graph,
-        zone::Graph &z,
-        MiniContext &mc)
+    bool operator()(const ZoneFileToken &t)
     {
         switch (t.id()) {
         case ID_LPAREN:
@@ -61,22 +140,18 @@ struct Parser {
         case ID_RPAREN:
             --paren_count;
             if (paren_count < 0) {
-                Logger->error(fmt::format(
-                    "zone-file-parser.cpp (Parser()) - Unmatched right parenthesis at line - {} in file - {}", l,
-                    mc.file_name));
+                Log(spdlog::level::err,
+                    fmt::format(
+                        "zone-file-parser.cpp (Parser()) - Unmatched right parenthesis at line - {} in file - {}", l,
+                        mc.file_name));
                 return false;
             }
             break;
-        case ID_TEXT_WORD: {
-            std::string tokenvalue(t.value().begin(), t.value().end());
-            current_record.push_back(std::move(tokenvalue));
+        case ID_TEXT_WORD:
+        case ID_WORD:
+            // The token is a view into the zone file and is only copied once the record is built.
+            current_record.push_back(t.value());
             break;
-        }
-        case ID_WORD: {
-            std::string tokenvalue(t.value().begin(), t.value().end());
-            current_record.push_back(std::move(tokenvalue));
-            break;
-        }
         case ID_WHITESPACE: {
             if (current_record.size() == 0)
                 current_record.push_back("");
@@ -95,314 +170,907 @@ struct Parser {
         case ID_EOL:
             ++l;
             if (paren_count == 0 && current_record.size() > 0) {
-                // Control entry $ORIGIN - Sets the origin for relative domain names
-                if (current_record[0].compare("$ORIGIN") == 0) {
-                    relative_domain_suffix = current_record[1];
-                    boost::to_lower(relative_domain_suffix);
-                    current_record.clear();
-                    return true;
-                }
-                // Control entry $INCLUDE - Inserts the named file( currently unhandled)
-                if (current_record[0].compare("$INCLUDE") == 0) {
-                    Logger->error(fmt::format(
-                        "zone-file-parser.cpp (Parser()) - Found $INCLUDE entry at line - {} in file - {}", l,
-                        mc.file_name));
-                    return false;
+                bool keep_going = ProcessRecord();
+                current_record.clear();
+                if (!detached_fields.empty()) {
+                    detached_fields.clear();
                 }
-                // Control entry $TTL - The TTL for records without explicit TTL value
-                if (current_record[0].compare("$TTL") == 0) {
-                    default_values.set_ttl(std::stoi(current_record[1]));
-                    current_record.clear();
-                    return true;
+                if (Logger->should_log(spdlog::level::trace)) {
+                    Log(spdlog::level::trace,
+                        fmt::format("zone-file-parser.cpp (Parser()) - Parsed line {} in file {}", l, mc.file_name));
                 }
+                return keep_going;
+            }
+            break;
+        case ID_COMMENT:
+        case ID_OTHER:
+            break;
+        }
+        // continue on
+        return true;
+    }
 
-                std::string name;
-                // First symbol is "@" implies the owner name is the relative domain name.
-                if (current_record[0].compare("@") == 0) {
-                    if (relative_domain_suffix.length() > 0) {
-                        current_record[0] = relative_domain_suffix;
-                        default_values.set_name(relative_domain_suffix);
-                    } else {
-                        Logger->error(fmt::format(
-                            "zone-file-parser.cpp (Parser()) - Encountered @ symbol but relative "
-                            "domain is empty at line - {} in file - {}",
-                            l, mc.file_name));
-                        return false;
-                    }
-                }
+    // Makes the fields read so far independent of the chunk they were read from.
+    void DetachCurrentRecord()
+    {
+        for (auto &field : current_record) {
+            detached_fields.emplace_back(field);
+            field = detached_fields.back();
+        }
+    }
 
-                // Search for the index where the RR type is found
-                int typeIndex = GetTypeIndex(current_record);
-                if (typeIndex == -1) {
-                    // Logger->warn(fmt::format("RR type not handled for the RR at line- {} in file- {}", l,
-                    // mc.file_name));
-                    current_record.clear();
-                    return true;
-                }
-                string type = current_record[typeIndex];
-                boost::to_upper(type);
-                string rdata = "";
-                uint16_t class_ = 1;
-                uint32_t ttl = default_values.get_ttl();
-                int i = 0;
-                if (typeIndex > 3) {
-                    Logger->warn(fmt::format(
-                        "zone-file-parser.cpp (Parser()) - RR at line {} in file {} is not "
-                        "following the DNS grammar (typeIndex > 3)",
+    void Log(spdlog::level::level_enum level, string message)
+    {
+        if (deferred_logs) {
+            deferred_logs->emplace_back(level, std::move(message));
+        } else {
+            Logger->log(level, message);
+        }
+    }
+
+    ParserState GetState() const
+    {
+        return {relative_domain_suffix, default_owner, default_ttl};
+    }
+
+    void SetState(const ParserState &state)
+    {
+        relative_domain_suffix = state.relative_domain_suffix;
+        default_owner = state.default_owner;
+        default_ttl = state.default_ttl;
+    }
+
+    void NoteRead(unsigned parts)
+    {
+        state_read |= parts & ~state_set;
+    }
+
+    // Whether starting from the guessed state instead of the actual one made no difference.
+    bool GuessHolds(const ParserState &guess, const ParserState &actual) const
+    {
+        return (!(state_read & kSuffixState) || guess.relative_domain_suffix == actual.relative_domain_suffix) &&
+               (!(state_read & kOwnerState) || guess.default_owner == actual.default_owner) &&
+               (!(state_read & kTtlState) || guess.default_ttl == actual.default_ttl);
+    }
+
+    // The state after the records parsed so far, had they started from the given state.
+    ParserState StateAfter(const ParserState &before) const
+    {
+        return {
+            state_set & kSuffixState ? relative_domain_suffix : before.relative_domain_suffix,
+            state_set & kOwnerState ? default_owner : before.default_owner,
+            state_set & kTtlState ? default_ttl : before.default_ttl};
+    }
+
+    void SetDefaultOwner(const string &owner)
+    {
+        state_set |= kOwnerState;
+        // Same normalization as storing the owner as labels and printing them back.
+        if (owner.empty()) {
+            default_owner = ".";
+        } else if (owner.back() != '.') {
+            default_owner = owner + ".";
+        } else {
+            default_owner = owner;
+        }
+    }
+
+    bool ProcessRecord()
+    {
+        // Control entry $ORIGIN - Sets the origin for relative domain names
+        if (current_record[0].compare("$ORIGIN") == 0) {
+            relative_domain_suffix = current_record[1];
+            ToLowerAscii(relative_domain_suffix);
+            state_set |= kSuffixState;
+            return true;
+        }
+        // Control entry $INCLUDE - Inserts the named file( currently unhandled)
+        if (current_record[0].compare("$INCLUDE") == 0) {
+            Log(spdlog::level::err,
+                fmt::format(
+                    "zone-file-parser.cpp (Parser()) - Found $INCLUDE entry at line - {} in file - {}", l,
+                    mc.file_name));
+            return false;
+        }
+        // Control entry $TTL - The TTL for records without explicit TTL value
+        if (current_record[0].compare("$TTL") == 0) {
+            default_ttl = std::stoi(string(current_record[1]));
+            state_set |= kTtlState;
+            return true;
+        }
+
+        std::string name;
+        // First symbol is "@" implies the owner name is the relative domain name.
+        if (current_record[0].compare("@") == 0) {
+            NoteRead(kSuffixState);
+            if (relative_domain_suffix.length() > 0) {
+                current_record[0] = relative_domain_suffix;
+                SetDefaultOwner(relative_domain_suffix);
+            } else {
+                Log(spdlog::level::err,
+                    fmt::format(
+                        "zone-file-parser.cpp (Parser()) - Encountered @ symbol but relative "
+                        "domain is empty at line - {} in file - {}",
                         l, mc.file_name));
-                    current_record.clear();
-                    return true;
-                }
-                for (auto &field : current_record) {
-                    if (i > typeIndex) {
-                        rdata += field + " ";
-                    }
-                    if (i < typeIndex) {
-                        if (i == 0) {
-                            if (field.size() > 0) {
-                                name = field;
-                                default_values.set_name(field);
-                            }
-                        } else if (boost::iequals(field, "CH")) {
-                            Logger->warn(fmt::format(
-                                "zone-file-parser.cpp (Parser()) - Found CH class for the RR at line {} in file {}", l,
-                                mc.file_name));
-                            class_ = 3;
-                        } else if (boost::iequals(field, "IN")) {
-                            class_ = 1;
-                        } else if (isInteger(field)) {
-                            ttl = std::stoi(field);
-                            if (default_values.get_ttl() == 0)
-                                default_values.set_ttl(ttl);
-                        } else {
-                            Logger->warn(fmt::format(
-                                "zone-file-parser.cpp (Parser()) - RR at line {} in file {} is "
-                                "not following the DNS grammar",
-                                l, mc.file_name));
-                            current_record.clear();
-                            return true;
-                        }
-                    }
-                    i++;
-                }
-                rdata = rdata.substr(0, rdata.size() - 1);
-                if (name.length() == 0) {
-                    name = LabelUtils::LabelsToString(default_values.get_name());
-                } else if (type == "SOA") {
-                    mc.found_SOA = true;
-                    if (relative_domain_suffix.size() == 0) {
-                        relative_domain_suffix = name;
-                    }
-                }
-                if (!boost::algorithm::ends_with(name, ".")) {
-                    name = name + "." + relative_domain_suffix;
-                    default_values.set_name(name);
+                return false;
+            }
+        }
+
+        // Search for the index where the RR type is found
+        int typeIndex = GetTypeIndex(current_record);
+        if (typeIndex == -1) {
+            // Logger->warn(fmt::format("RR type not handled for the RR at line- {} in file- {}", l,
+            // mc.file_name));
+            return true;
+        }
+        string type(current_record[typeIndex]);
+        ToUpperAscii(type);
+        uint16_t class_ = 1;
+        uint32_t ttl = default_ttl;
+        bool explicit_ttl = false;
+        if (typeIndex > 3) {
+            Log(spdlog::level::warn,
+                fmt::format(
+                    "zone-file-parser.cpp (Parser()) - RR at line {} in file {} is not "
+                    "following the DNS grammar (typeIndex > 3)",
+                    l, mc.file_name));
+            return true;
+        }
+        for (int i = 0; i < typeIndex; i++) {
+            string_view field = current_record[i];
+            if (i == 0) {
+                if (field.size() > 0) {
+                    name = field;
+                    SetDefaultOwner(name);
                 }
-                // compare returns zero when equal
-                if (!type.compare("NS") || !type.compare("CNAME") || !type.compare("DNAME") || !type.compare("MX")) {
-                    if (!boost::algorithm::ends_with(rdata, ".")) {
-                        // if (relativeDomainSuffix.length() > 0) {
-                        //	if (rdata.compare("@") == 0) {
-                        //		rdata = relativeDomainSuffix;
-                        //	}
-                        //	else {
-                        //		rdata = rdata + "." + relativeDomainSuffix;
-                        //	}
-                        //}
-                        // else {
-                        //	cout << "Encountered @ symbol but relative domain is empty for rdata";
-                        //	currentRecord.clear();
-                        //	return false;
-                        //}
-                        rdata = rdata + "." + relative_domain_suffix;
-                    }
+            } else if (EqualsKeyword(field, "CH")) {
+                Log(spdlog::level::warn,
+                    fmt::format(
+                        "zone-file-parser.cpp (Parser()) - Found CH class for the RR at line {} in file {}", l,
+                        mc.file_name));
+                class_ = 3;
+            } else if (EqualsKeyword(field, "IN")) {
+                class_ = 1;
+            } else if (isInteger(field)) {
+                ttl = std::stoi(string(field));
+                explicit_ttl = true;
+                NoteRead(kTtlState);
+                if (default_ttl == 0) {
+                    default_ttl = ttl;
+                    state_set |= kTtlState;
                 }
-                boost::to_lower(rdata);
-                boost::to_lower(name);
-                mc.rrs_parsed++;
-                ResourceRecord RR(name, type, class_, ttl, rdata);
-                auto [valid, violation_label] = LabelUtils::LengthCheck(RR.get_name(), 0);
-                if (!valid) {
-                    if (violation_label.length() > 0) {
-                        mc.type_to_count["Label Length Exceeded"]++;
-                        LintUtils::WriteRRIssueToFile(
-                            mc.lint, mc.file_name, l, RR.toString(),
-                            violation_label + " - length exceedes max length (63)", "");
-                    } else {
-                        mc.type_to_count["Domain Length Exceeded"]++;
-                        LintUtils::WriteRRIssueToFile(
-                            mc.lint, mc.file_name, l, RR.toString(), "Domain length exceedes max length (255)", "");
-                    }
+            } else {
+                Log(spdlog::level::warn,
+                    fmt::format(
+                        "zone-file-parser.cpp (Parser()) - RR at line {} in file {} is "
+                        "not following the DNS grammar",
+                        l, mc.file_name));
+                return true;
+            }
+        }
+        if (!explicit_ttl) {
+            NoteRead(kTtlState);
+        }
+        if (name.length() == 0) {
+            NoteRead(kOwnerState);
+            name = default_owner;
+        } else if (type == "SOA") {
+            mc.found_SOA = true;
+            NoteRead(kSuffixState);
+            if (relative_domain_suffix.size() == 0) {
+                relative_domain_suffix = name;
+                state_set |= kSuffixState;
+            }
+        }
+        if (!boost::algorithm::ends_with(name, ".")) {
+            NoteRead(kSuffixState);
+            name = name + "." + relative_domain_suffix;
+            SetDefaultOwner(name);
+        }
+        // The rdata fields are joined by a single space.
+        size_t rdata_length = 0;
+        for (size_t i = typeIndex + 1; i < current_record.size(); i++) {
+            rdata_length += current_record[i].size() + 1;
+        }
+        string rdata;
+        rdata.reserve(rdata_length + relative_domain_suffix.size() + 1);
+        for (size_t i = typeIndex + 1; i < current_record.size(); i++) {
+            if (i != static_cast<size_t>(typeIndex) + 1) {
+                rdata += ' ';
+            }
+            rdata += current_record[i];
+        }
+        // compare returns zero when equal
+        if (!type.compare("NS") || !type.compare("CNAME") || !type.compare("DNAME") || !type.compare("MX")) {
+            if (!boost::algorithm::ends_with(rdata, ".")) {
+                NoteRead(kSuffixState);
+                rdata += '.';
+                rdata += relative_domain_suffix;
+            }
+        }
+        AddRecord(name, type, class_, ttl, rdata);
+        return true;
+    }
+
+    // Builds the record with an absolute owner name and checks the length of its names. It is then either collected
+    // in parsed_records or added to the zone graph right away.
+    void AddRecord(string &name, const string &type, uint16_t class_, uint32_t ttl, string &rdata)
+    {
+        ToLowerAscii(rdata);
+        ToLowerAscii(name);
+        ParsedRecord record{
+            l, type, boost::algorithm::starts_with(name, "*."), ResourceRecord(name, type, class_, ttl, rdata), "", ""};
+        auto [valid, violation_label] = LabelUtils::LengthCheck(record.RR.get_name(), 0);
+        if (!valid) {
+            if (violation_label.length() > 0) {
+                record.count_key = "Label Length Exceeded";
+                record.violation = violation_label + " - length exceedes max length (63)";
+            } else {
+                record.count_key = "Domain Length Exceeded";
+                record.violation = "Domain length exceedes max length (255)";
+            }
+        } else if (
+            record.RR.get_type() == RRType::NS || record.RR.get_type() == RRType::CNAME ||
+            record.RR.get_type() == RRType::DNAME) {
+            std::tie(valid, violation_label) = LabelUtils::LengthCheck(record.RR.get_target(), 0);
+            if (!valid) {
+                if (violation_label.length() > 0) {
+                    record.count_key = "Label Length Exceeded";
+                    record.violation = violation_label + " - length exceedes 63";
                 } else {
-                    if (RR.get_type() == RRType::NS || RR.get_type() == RRType::CNAME ||
-                        RR.get_type() == RRType::DNAME) {
-                        std::tie( valid, violation_label ) =
-                            LabelUtils::LengthCheck(LabelUtils::StringToLabels(RR.get_rdata()), 0);
-                        if (!valid) {
-                            if (violation_label.length() > 0) {
-                                mc.type_to_count["Label Length Exceeded"]++;
-                                LintUtils::WriteRRIssueToFile(
-                                    mc.lint, mc.file_name, l, RR.toString(), violation_label + " - length exceedes 63",
-                                    "");
-                            } else {
-                                mc.type_to_count["Domain Length Exceeded"]++;
-                                LintUtils::WriteRRIssueToFile(
-                                    mc.lint, mc.file_name, l, RR.toString(),
-                                    "Target domain length exceedes max length (255)", "");
-                            }
-                        }
-                    } else {
-                        valid = true;
-                    }
-                    if (valid) {
-                        if (z.CheckZoneMembership(RR, mc.file_name)) {
-                            auto [code, vertexid] = z.AddResourceRecord(RR);
-                            if (code == zone::RRAddCode::SUCCESS) {
-                                label_graph.AddResourceRecord(RR, z.get_id(), vertexid.get());
-                                mc.type_to_count[type]++;
-                                if (boost::algorithm::starts_with(name, "*.")) {
-                                    mc.type_to_count["Wildcard"]++;
-                                }
-                            } else {
-                                string log_line = "";
-                                if (code == zone::RRAddCode::DUPLICATE) {
-                                    mc.type_to_count["Duplicate-Records"]++;
-                                    log_line = fmt::format(
-                                        "zone-file-parser.cpp (Parser()) - Duplicate record found on line {} in file "
-                                        "{}",
-                                        l, mc.file_name);
-                                    LintUtils::WriteRRIssueToFile(
-                                        mc.lint, mc.file_name, l, RR.toString(), "Duplicate Record", "");
-                                } else if (code == zone::RRAddCode::CNAME_MULTIPLE) {
-                                    mc.type_to_count["CNAME/DNAME Errors"]++;
-                                    log_line = fmt::format(
-                                        "zone-file-parser.cpp (Parser()) - |{}| record exists but trying to add "
-                                        "another "
-                                        "record |{}| from line {} in file {}",
-                                        z[vertexid.get()].rrs[0].toString(), RR.toString(), l, mc.file_name);
-                                    LintUtils::WriteRRIssueToFile(
-                                        mc.lint, mc.file_name, l, RR.toString(), "MULTIPLE CNAMEs",
-                                        z[vertexid.get()].rrs[0].toString());
-                                } else if (code == zone::RRAddCode::CNAME_OTHER) {
-                                    mc.type_to_count["CNAME/DNAME Errors"]++;
-                                    log_line = fmt::format(
-                                        "zone-file-parser.cpp (Parser()) - CNAME record is not allowed to coexist "
-                                        "with any other "
-                                        "data type but adding another record from line {} in file {}",
-                                        l, mc.file_name);
-                                    LintUtils::WriteRRIssueToFile(
-                                        mc.lint, mc.file_name, l, RR.toString(), "CNAME AND OTHER TYPES",
-                                        z[vertexid.get()].rrs[0].toString());
-                                } else if (code == zone::RRAddCode::DNAME_MULTIPLE) {
-                                    mc.type_to_count["CNAME/DNAME Errors"]++;
-                                    log_line = fmt::format(
-                                        "zone-file-parser.cpp (Parser()) - |{}| record exists but trying to add "
-                                        "another DNAME "
-                                        "record |{}| from line {} in file {}",
-                                        z[vertexid.get()].rrs[0].toString(), RR.toString(), l, mc.file_name);
-                                    LintUtils::WriteRRIssueToFile(
-                                        mc.lint, mc.file_name, l, RR.toString(), "MULTIPLE DNAMEs",
-                                        z[vertexid.get()].rrs[0].toString());
-                                }
-                                if (log_line.length()) {
-                                    Logger->debug(log_line);
-                                }
-                            }
-                        } else {
-                            mc.type_to_count["Out-of-Zone-Records"]++;
-                            Logger->debug(fmt::format(
-                                "zone-file-parser.cpp (Parser()) - Ignoring out of zone record on line {} in file {}",
-                                l, mc.file_name));
-                            LintUtils::WriteRRIssueToFile(
-                                mc.lint, mc.file_name, l, RR.toString(), "OUT OF ZONE RECORD", "");
-                        }
-                    }
+                    record.count_key = "Domain Length Exceeded";
+                    record.violation = "Target domain length exceedes max length (255)";
                 }
-                current_record.clear();
-                Logger->trace(
-                    fmt::format("zone-file-parser.cpp (Parser()) - Parsed line {} in file {}", l, mc.file_name));
             }
-            break;
-        case ID_OTHER:
-            break;
         }
-        // continue on
-        return true;
+        if (parsed_records) {
+            parsed_records->push_back(std::move(record));
+        } else {
+            InsertRecord(record);
+        }
+    }
+
+    // Adds a record to the zone graph (or reports why it can not be added).
+    void InsertRecord(ParsedRecord &record)
+    {
+        mc.rrs_parsed++;
+        if (record.count_key.length()) {
+            ReportInvalidRecord(record);
+        } else if (z.CheckZoneMembership(record.RR, mc.file_name)) {
+            auto [code, vertexid] = z.AddResourceRecord(record.RR);
+            ReportAddition(record, record.RR, code, vertexid);
+        } else {
+            ReportOutOfZoneRecord(record);
+        }
+    }
+
+    // Same as calling InsertRecord on every record in turn, but the records of the zone are added with
+    // zone::Graph::AddResourceRecords, also when the zone already has records. That needs the zone membership of every
+    // record upfront, which is only known when the zone already has its origin or the first record is the SOA record,
+    // and every SOA record has the same owner; other records (including the invalid files that InsertRecord rejects)
+    // are inserted one record at a time.
+    void InsertRecords(vector<ParsedRecord> &records)
+    {
+        boost::optional<DomainName> origin;
+        if (z.get_origin().size()) {
+            origin = z.get_origin();
+        }
+        bool bulk = true;
+        for (auto &record : records) {
+            if (!bulk) {
+                break;
+            }
+            if (record.count_key.length()) {
+                continue;
+            }
+            if (!origin) {
+                bulk = record.RR.get_type() == RRType::SOA;
+                origin = record.RR.get_name();
+            } else if (record.RR.get_type() == RRType::SOA) {
+                bulk = record.RR.get_name() == *origin;
+            }
+        }
+        if (!bulk || !origin) {
+            for (auto &record : records) {
+                InsertRecord(record);
+            }
+            return;
+        }
+
+        vector<char> in_zone(records.size());
+        vector<ResourceRecord> zone_records;
+        for (size_t i = 0; i < records.size(); i++) {
+            if (!records[i].count_key.length() && LabelUtils::SubDomainCheck(*origin, records[i].RR.get_name())) {
+                in_zone[i] = true;
+                zone_records.push_back(records[i].RR);
+            }
+        }
+        auto results = z.AddResourceRecords(zone_records);
+        auto result = results.begin();
+        auto zone_record = zone_records.begin();
+        for (size_t i = 0; i < records.size(); i++) {
+            mc.rrs_parsed++;
+            if (records[i].count_key.length()) {
+                ReportInvalidRecord(records[i]);
+            } else if (in_zone[i]) {
+                auto [code, vertexid] = *result++;
+                ReportAddition(records[i], *zone_record++, code, vertexid);
+            } else {
+                ReportOutOfZoneRecord(records[i]);
+            }
+        }
+    }
+
+    void ReportInvalidRecord(ParsedRecord &record)
+    {
+        mc.type_to_count[record.count_key]++;
+        AddLintIssue(mc, record.line, record.RR.toString(), record.violation, "");
+    }
+
+    void ReportOutOfZoneRecord(ParsedRecord &record)
+    {
+        mc.type_to_count["Out-of-Zone-Records"]++;
+        Logger->debug(fmt::format(
+            "zone-file-parser.cpp (Parser()) - Ignoring out of zone record on line {} in file {}", record.line,
+            mc.file_name));
+        AddLintIssue(mc, record.line, record.RR.toString(), "OUT OF ZONE RECORD", "");
+    }
+
+    void ReportAddition(
+        const ParsedRecord &record,
+        ResourceRecord &RR,
+        zone::RRAddCode code,
+        boost::optional<zone::Graph::VertexDescriptor> vertexid)
+    {
+        size_t l = record.line;
+        if (code == zone::RRAddCode::SUCCESS) {
+            mc.type_to_count[record.type]++;
+            if (record.wildcard) {
+                mc.type_to_count["Wildcard"]++;
+            }
+            if (first_types.size() <= vertexid.get()) {
+                first_types.resize(vertexid.get() + 1, -1);
+            }
+            if (first_types[vertexid.get()] == -1) {
+                first_types[vertexid.get()] = static_cast<int8_t>(RR.get_type());
+            }
+            if (label_graph) {
+                label_graph->AddResourceRecord(RR, z.get_id(), vertexid.get());
+            } else {
+                mc.label_graph_records.push_back({std::move(RR), vertexid.get()});
+            }
+            return;
+        }
+        string log_line = "";
+        auto first_record = [&]() {
+            auto records = z.Records(vertexid.get());
+            return std::find_if(records.begin(), records.end(), [&](const ResourceRecord &rr) {
+                       return rr.get_type() == first_types[vertexid.get()];
+                   })->toString();
+        };
+        if (code == zone::RRAddCode::DUPLICATE) {
+            mc.type_to_count["Duplicate-Records"]++;
+            log_line = fmt::format(
+                "zone-file-parser.cpp (Parser()) - Duplicate record found on line {} in file "
+                "{}",
+                l, mc.file_name);
+            AddLintIssue(mc, l, RR.toString(), "Duplicate Record", "");
+        } else if (code == zone::RRAddCode::CNAME_MULTIPLE) {
+            mc.type_to_count["CNAME/DNAME Errors"]++;
+            log_line = fmt::format(
+                "zone-file-parser.cpp (Parser()) - |{}| record exists but trying to add "
+                "another "
+                "record |{}| from line {} in file {}",
+                first_record(), RR.toString(), l, mc.file_name);
+            AddLintIssue(mc, l, RR.toString(), "MULTIPLE CNAMEs", first_record());
+        } else if (code == zone::RRAddCode::CNAME_OTHER) {
+            mc.type_to_count["CNAME/DNAME Errors"]++;
+            log_line = fmt::format(
+                "zone-file-parser.cpp (Parser()) - CNAME record is not allowed to coexist "
+                "with any other "
+                "data type but adding another record from line {} in file {}",
+                l, mc.file_name);
+            AddLintIssue(mc, l, RR.toString(), "CNAME AND OTHER TYPES", first_record());
+        } else if (code == zone::RRAddCode::DNAME_MULTIPLE) {
+            mc.type_to_count["CNAME/DNAME Errors"]++;
+            log_line = fmt::format(
+                "zone-file-parser.cpp (Parser()) - |{}| record exists but trying to add "
+                "another DNAME "
+                "record |{}| from line {} in file {}",
+                first_record(), RR.toString(), l, mc.file_name);
+            AddLintIssue(mc, l, RR.toString(), "MULTIPLE DNAMEs", first_record());
+        }
+        if (log_line.length()) {
+            Logger->debug(log_line);
+        }
     }
 
-    int GetTypeIndex(vector<string> &current_record) const
+    int GetTypeIndex(const vector<string_view> &current_record) const
     {
-        std::vector<string> types{"A",    "MX",  "NS",    "CNAME", "SOA",  "PTR", "TXT",
-                                  "AAAA", "SRV", "DNAME", "RRSIG", "NSEC", "DS",  "SPF"};
+        static const string_view types[] = {"A",   "MX",    "NS",    "CNAME", "SOA", "PTR", "TXT",
+                                            "AAAA", "SRV", "DNAME", "RRSIG", "NSEC", "DS",  "SPF"};
 
-        int index = -1;
         int i = 0;
         for (auto &field : current_record) {
-            string f(field);
-            if (f.length() < 6) {
-                boost::to_upper(f);
-                if (std::find(std::begin(types), std::end(types), f) != std::end(types)) {
-                    return i;
+            if (field.length() < 6) {
+                for (auto &type : types) {
+                    if (EqualsKeyword(field, type)) {
+                        return i;
+                    }
                 }
             }
             i++;
         }
-        return index;
+        return -1;
     }
 
-    inline bool isInteger(const std::string &s) const
+    inline bool isInteger(string_view s) const
     {
         if (s.empty() || ((!isdigit(s[0])) && (s[0] != '-') && (s[0] != '+')))
             return false;
-        char *p;
-        strtol(s.c_str(), &p, 10);
-        return (*p == 0);
+        size_t i = isdigit(s[0]) ? 0 : 1;
+        if (i == s.size())
+            return false;
+        for (; i < s.size(); i++) {
+            if (!isdigit(s[i]))
+                return false;
+        }
+        return true;
     }
 };
 
-inline string ReadFromFile(char const *infile)
+MiniContext Driver::ParseZoneFile(
+    string_view contents,
+    zone::Graph &zone_graph,
+    const string &file,
+    const string &origin,
+    bool lint,
+    size_t bulk_load_threshold,
+    label::Graph *label_graph)
 {
-    ifstream instream(infile);
-    if (!instream.is_open()) {
-        // cerr << "Couldn't open file: " << infile << endl;
-        Logger->critical(fmt::format("zone-file-parser.cpp (Parser()) - couldn't open file {}", infile));
-        exit(-1);
-    }
-    instream.unsetf(ios::skipws);
-    return string(std::istreambuf_iterator<char>(instream.rdbuf()), istreambuf_iterator<char>());
+    MiniContext mc;
+    mc.file_name = file;
+    mc.lint = lint;
+
+    // The records of a file that may reach the bulk load threshold are collected first so that they can be added to
+    // the zone graph in bulk. There is at most one record per line, so smaller files are added while parsing.
+    vector<ParsedRecord> records;
+    Parser parser(zone_graph, mc, origin, label_graph);
+    if (HasAtLeastLines(contents, bulk_load_threshold)) {
+        parser.parsed_records = &records;
+    }
+    bool r = ZoneFileTokenizer::Tokenize(contents, parser);
+    if (records.size() >= bulk_load_threshold) {
+        parser.InsertRecords(records);
+    } else {
+        for (auto &record : records) {
+            parser.InsertRecord(record);
+        }
+    }
+
+    mc.lines = parser.l;
+    mc.parsed_completely = r && parser.paren_count == 0;
+    return mc;
 }
 
-int Driver::ParseZoneFileAndExtendGraphs(string file, string nameserver, string origin, bool lint)
+MiniContext Driver::ParseCompressedZoneFile(
+    string_view contents,
+    ZoneFileDecompressor::Format format,
+    zone::Graph &zone_graph,
+    const string &file,
+    const string &origin,
+    bool lint,
+    size_t chunk_size,
+    label::Graph *label_graph)
 {
+    MiniContext mc;
+    mc.file_name = file;
+    mc.lint = lint;
 
-    context_.zoneId_counter_++;
-    int &zoneId = context_.zoneId_counter_;
-    zone::Graph zone_graph(zoneId);
+    // Each chunk ends with a line break, and only a quoted string can span lines. A quote that is not closed within
+    // the chunk may be closed in the next one, so the chunk is only tokenized up to it and the next one starts there.
+    // The fields of a record in parentheses can also be spread over several chunks; they are copied before the chunk
+    // is released. The records are added to the zone graph chunk by chunk, so only the records of one chunk are held
+    // at any time; those of a large enough chunk in bulk, merged under the nodes of the earlier chunks.
+    ZoneFileDecompressor decompressor(contents, format, file, chunk_size);
+    vector<ParsedRecord> records;
+    Parser parser(zone_graph, mc, origin, label_graph);
+    parser.parsed_records = &records;
+    bool r = true;
+    size_t unused = 0;
+    for (string_view chunk = decompressor.NextChunk(); r && chunk.size(); chunk = decompressor.NextChunk(unused)) {
+        const char *open_quote = nullptr;
+        bool last = decompressor.LastChunk();
+        r = ZoneFileTokenizer::Tokenize(chunk, [&](const ZoneFileToken &t) {
+            if (!last && t.id() == ID_OTHER && t.value() == "\"") {
+                open_quote = t.value().data();
+                return false;
+            }
+            return parser(t);
+        });
+        parser.DetachCurrentRecord();
+        if (open_quote) {
+            r = true;
+            unused = chunk.data() + chunk.size() - open_quote;
+        } else {
+            unused = 0;
+        }
+        if (records.size() >= kBulkLoadThreshold) {
+            parser.InsertRecords(records);
+        } else {
+            for (auto &record : records) {
+                parser.InsertRecord(record);
+            }
+        }
+        records.clear();
+    }
+
+    mc.lines = parser.l;
+    mc.parsed_completely = r && parser.paren_count == 0;
+    return mc;
+}
 
+MiniContext Driver::ParseWireZoneFile(
+    string_view contents,
+    zone::Graph &zone_graph,
+    const string &file,
+    bool lint,
+    size_t bulk_load_threshold,
+    label::Graph *label_graph)
+{
     MiniContext mc;
     mc.file_name = file;
     mc.lint = lint;
 
-    // get the zone file input as a string.
-    string str(ReadFromFile(file.c_str()));
-    char const *first = str.c_str();
-    char const *last = &first[str.size()];
+    // Wire-format names are always absolute, so there is no origin. Records are numbered in place of line numbers.
+    vector<ParsedRecord> records;
+    Parser parser(zone_graph, mc, "", label_graph);
+    parser.parsed_records = &records;
+    ZoneFileWireReader reader(contents);
+    ZoneFileWireReader::Record record;
+    while (reader.Next(record)) {
+        parser.l++;
+        if (record.type == "SOA") {
+            mc.found_SOA = true;
+        }
+        parser.AddRecord(record.name, record.type, record.class_, record.ttl, record.rdata);
+    }
+    if (reader.error().size()) {
+        Logger->error(fmt::format(
+            "zone-file-parser.cpp (ParseWireZoneFile) - Malformed wire-format zone file {} ({})", file,
+            reader.error()));
+    }
+    // A zone transfer ends with the SOA record it started with.
+    if (records.size() > 1 && records.front().type == "SOA" && records.back().type == "SOA" &&
+        records.front().RR == records.back().RR) {
+        records.pop_back();
+    }
+    if (records.size() >= bulk_load_threshold) {
+        parser.InsertRecords(records);
+    } else {
+        for (auto &parsed_record : records) {
+            parser.InsertRecord(parsed_record);
+        }
+    }
+
+    mc.lines = parser.l;
+    mc.parsed_completely = reader.error().empty();
+    return mc;
+}
 
-    string file_name = file;
+MiniContext Driver::ParseZoneFileInChunks(
+    string_view contents,
+    zone::Graph &zone_graph,
+    const string &file,
+    const string &origin,
+    bool lint,
+    int thread_count,
+    size_t chunk_size,
+    label::Graph *label_graph)
+{
+    // A scanner thread cuts the file into chunks at record boundaries. It only follows the tokens for the parenthesis
+    // depth, the line count and the $ORIGIN and $TTL entries, and once a chunk is past chunk_size bytes it cuts before
+    // the next record with an owner name. The workers build the records of the chunks, each from a guess of the parser
+    // state at its start: the state after the first chunk, with the $ORIGIN and $TTL entries the scanner saw since.
+    // The calling thread takes the chunks in order and knows the actual state at the start of each one. It keeps the
+    // records and the log messages of a chunk if the guess was right about every part of the state the chunk read
+    // before setting it, and parses the chunk again itself otherwise. It then adds the records of the chunk to the
+    // zone graph right away, while the workers parse the next chunks, so the zone graph, the lint issues and the label
+    // graph records come out exactly as with ParseZoneFile. The log messages are the same too, only those about adding
+    // the records of a chunk come before the ones of parsing the next chunk. At most kZoneFileReadAheadPerThread
+    // chunks per worker are in flight at any time.
+    struct Chunk {
+        string_view text;
+        size_t first_line = 0;
+        bool first = false;
+        // The last $ORIGIN and $TTL entries between the end of the first chunk and the start of this one.
+        boost::optional<string> origin;
+        boost::optional<uint32_t> ttl;
+        ParserState guess;
+        MiniContext mc;
+        boost::optional<Parser> parser;
+        vector<ParsedRecord> records;
+        vector<pair<spdlog::level::level_enum, string>> logs;
+        bool completed = false;
+        bool parsed = false;
+    };
 
-    // mutable state that will be updated by the parser.
-    size_t l = 0;
-    int parenCount = 0;
-    string relative_domain = origin;
-    ResourceRecord defaultValues("", "", 0, 0, "");
-    vector<string> currentRecord;
+    MiniContext mc;
+    mc.file_name = file;
+    mc.lint = lint;
+    size_t read_ahead = static_cast<size_t>(thread_count) * kZoneFileReadAheadPerThread;
+    ParserState initial_state;
+    initial_state.relative_domain_suffix = origin;
 
-    zone_file_tokens<lex::lexertl::lexer<>> zone_functor;
-    auto parserCallback = boost::bind(
-        Parser(), _1, boost::ref(l), boost::ref(parenCount), boost::ref(relative_domain), boost::ref(defaultValues),
-        boost::ref(currentRecord), boost::ref(label_graph_), boost::ref(zone_graph), boost::ref(mc));
+    std::deque<Chunk> chunks;
+    std::deque<Chunk *> to_parse;
+    bool finished_scanning = false;
+    // Set once a chunk stops the parse; the chunks after it are skipped.
+    bool stopped = false;
+    boost::optional<ParserState> first_state;
+    std::mutex m;
+    std::condition_variable cv;
 
-    auto r = lex::tokenize(first, last, zone_functor, parserCallback);
+    auto parse = [&](Chunk &chunk, const ParserState &state) {
+        chunk.guess = state;
+        chunk.records.clear();
+        chunk.logs.clear();
+        chunk.parser.emplace(zone_graph, chunk.mc, "");
+        chunk.mc = MiniContext();
+        chunk.mc.file_name = file;
+        Parser &parser = chunk.parser.get();
+        parser.SetState(state);
+        parser.l = chunk.first_line;
+        parser.parsed_records = &chunk.records;
+        parser.deferred_logs = &chunk.logs;
+        chunk.completed = ZoneFileTokenizer::Tokenize(chunk.text, parser);
+    };
+
+    std::thread scanner = thread([&]() {
+        const char *chunk_start = contents.data();
+        size_t chunk_first_line = 0;
+        boost::optional<string> chunk_origin;
+        boost::optional<uint32_t> chunk_ttl;
+        size_t chunk_count = 0;
+        // The end of the last line of the chunk once it is past chunk_size, until the next record shows whether it
+        // has an owner name.
+        const char *cut = nullptr;
+        size_t cut_line = 0;
+        size_t line = 0;
+        int paren_count = 0;
+        // The number of fields of the current record and its first one.
+        size_t fields = 0;
+        string_view entry;
+        boost::optional<string> origin_entry;
+        boost::optional<uint32_t> ttl_entry;
+        auto add_chunk = [&](const char *chunk_end) {
+            std::unique_lock<std::mutex> lock(m);
+            cv.wait(lock, [&]() { return chunks.size() < read_ahead || stopped; });
+            if (stopped) {
+                return false;
+            }
+            chunks.emplace_back();
+            Chunk &chunk = chunks.back();
+            chunk.text = string_view(chunk_start, chunk_end - chunk_start);
+            chunk.first_line = chunk_first_line;
+            chunk.first = chunk_count++ == 0;
+            chunk.origin = chunk_origin;
+            chunk.ttl = chunk_ttl;
+            to_parse.push_back(&chunk);
+            cv.notify_all();
+            return true;
+        };
+        bool added = true;
+        ZoneFileTokenizer::Tokenize(contents, [&](const ZoneFileToken &t) {
+            switch (t.id()) {
+            case ID_EOL:
+                ++line;
+                if (paren_count == 0) {
+                    fields = 0;
+                    const char *line_end = t.value().data() + t.value().size();
+                    if (static_cast<size_t>(line_end - chunk_start) >= chunk_size) {
+                        cut = line_end;
+                        cut_line = line;
+                    }
+                }
+                return true;
+            case ID_COMMENT:
+                return true;
+            case ID_LPAREN:
+                ++paren_count;
+                break;
+            case ID_RPAREN:
+                // The parse stops at an unmatched parenthesis, so the rest of the file goes into the last chunk.
+                if (--paren_count < 0) {
+                    return false;
+                }
+                break;
+            case ID_TEXT_WORD:
+            case ID_WORD:
+                if (cut && fields == 0) {
+                    added = add_chunk(cut);
+                    if (!added) {
+                        return false;
+                    }
+                    chunk_start = cut;
+                    chunk_first_line = cut_line;
+                    chunk_origin = origin_entry;
+                    chunk_ttl = ttl_entry;
+                }
+                if (fields == 0) {
+                    entry = t.value();
+                } else if (fields == 1 && chunk_count > 0) {
+                    // Only a guess: the workers do not depend on it being right.
+                    if (entry == "$ORIGIN") {
+                        origin_entry = string(t.value());
+                        ToLowerAscii(*origin_entry);
+                    } else if (entry == "$TTL") {
+                        ttl_entry = static_cast<uint32_t>(std::strtol(string(t.value()).c_str(), nullptr, 10));
+                    }
+                }
+                ++fields;
+                break;
+            case ID_WHITESPACE:
+                if (fields == 0) {
+                    entry = string_view();
+                    fields = 1;
+                }
+                break;
+            case ID_OTHER:
+                break;
+            }
+            cut = nullptr;
+            return true;
+        });
+        if (added && chunk_start != contents.data() + contents.size()) {
+            add_chunk(contents.data() + contents.size());
+        }
+        std::lock_guard<std::mutex> lock(m);
+        finished_scanning = true;
+        cv.notify_all();
+    });
+
+    vector<std::thread> workers;
+    for (int t = 0; t < thread_count; t++) {
+        workers.push_back(thread([&]() {
+            while (true) {
+                Chunk *chunk;
+                ParserState guess = initial_state;
+                bool skip;
+                {
+                    std::unique_lock<std::mutex> lock(m);
+                    cv.wait(lock, [&]() { return !to_parse.empty() || finished_scanning; });
+                    if (to_parse.empty()) {
+                        return;
+                    }
+                    chunk = to_parse.front();
+                    to_parse.pop_front();
+                    if (!chunk->first) {
+                        cv.wait(lock, [&]() { return first_state || stopped; });
+                        if (first_state) {
+                            guess = first_state.get();
+                        }
+                    }
+                    skip = stopped;
+                }
+                if (chunk->origin) {
+                    guess.relative_domain_suffix = chunk->origin.get();
+                }
+                if (chunk->ttl) {
+                    guess.default_ttl = chunk->ttl.get();
+                }
+                if (!skip) {
+                    parse(*chunk, guess);
+                }
+                std::lock_guard<std::mutex> lock(m);
+                if (chunk->first) {
+                    first_state = chunk->parser.get().GetState();
+                }
+                chunk->parsed = true;
+                cv.notify_all();
+            }
+        }));
+    }
+
+    Parser inserter(zone_graph, mc, origin, label_graph);
+    ParserState state = initial_state;
+    bool r = true;
+    size_t lines = 0;
+    int paren_count = 0;
+    while (true) {
+        Chunk *chunk;
+        {
+            std::unique_lock<std::mutex> lock(m);
+            cv.wait(lock, [&]() {
+                return (!chunks.empty() && chunks.front().parsed) || (finished_scanning && chunks.empty());
+            });
+            if (chunks.empty()) {
+                break;
+            }
+            chunk = &chunks.front();
+        }
+        if (r) {
+            if (!chunk->parser.get().GuessHolds(chunk->guess, state)) {
+                parse(*chunk, state);
+            }
+            Parser &parser = chunk->parser.get();
+            for (auto &[level, message] : chunk->logs) {
+                Logger->log(level, message);
+            }
+            if (chunk->records.size() >= kBulkLoadThreshold) {
+                inserter.InsertRecords(chunk->records);
+            } else {
+                for (auto &record : chunk->records) {
+                    inserter.InsertRecord(record);
+                }
+            }
+            state = parser.StateAfter(state);
+            mc.found_SOA = mc.found_SOA || chunk->mc.found_SOA;
+            lines = parser.l;
+            paren_count = parser.paren_count;
+            r = chunk->completed;
+        }
+        std::lock_guard<std::mutex> lock(m);
+        stopped = !r;
+        chunks.pop_front();
+        cv.notify_all();
+    }
+
+    scanner.join();
+    for (auto &t : workers) {
+        t.join();
+    }
+    mc.lines = lines;
+    mc.parsed_completely = r && paren_count == 0;
+    return mc;
+}
+
+MiniContext Driver::ParseOrLoadZoneFile(
+    string_view contents,
+    zone::Graph &zone_graph,
+    const string &file,
+    const string &origin,
+    bool lint,
+    int parser_threads,
+    size_t chunk_size,
+    label::Graph *label_graph) const
+{
+    uint64_t contents_hash = 0;
+    if (zone_cache_) {
+        // The cache stores the label graph records of the zone, so they are collected even on the serial path.
+        label_graph = nullptr;
+        contents_hash = ZoneCache::Hash(contents);
+        MiniContext mc;
+        mc.file_name = file;
+        mc.lint = lint;
+        if (zone_cache_->Load(contents_hash, contents.size(), origin, zone_graph, mc)) {
+            return mc;
+        }
+    }
+    MiniContext mc;
+    auto format = ZoneFileDecompressor::DetectFormat(contents);
+    if (format != ZoneFileDecompressor::Format::NONE) {
+        mc = ParseCompressedZoneFile(
+            contents, format, zone_graph, file, origin, lint, kZoneFileStreamChunkSize, label_graph);
+    } else if (parser_threads > 1 && contents.size() >= 2 * chunk_size) {
+        mc = ParseZoneFileInChunks(
+            contents, zone_graph, file, origin, lint, parser_threads, chunk_size, label_graph);
+    } else {
+        mc = ParseZoneFile(contents, zone_graph, file, origin, lint, kBulkLoadThreshold, label_graph);
+    }
+    if (zone_cache_) {
+        zone_cache_->Store(contents_hash, contents.size(), origin, mc);
+    }
+    return mc;
+}
+
+int Driver::MergeZone(zone::Graph &zone_graph, MiniContext &mc, const string &nameserver)
+{
+    int zoneId = zone_graph.get_id();
+
+    for (auto &issue : mc.lint_issues) {
+        LintUtils::WriteIssueToFile(issue, mc.lint);
+    }
 
     for (auto &[k, v] : mc.type_to_count) {
         if (context_.type_to_rr_count.find(k) == context_.type_to_rr_count.end()) {
@@ -412,21 +1080,24 @@ int Driver::ParseZoneFileAndExtendGraphs(string file, string nameserver, string
         }
     }
 
+    label_graph_.AddResourceRecords(mc.label_graph_records, zoneId, zone_graph);
+
     if (mc.found_SOA) {
         // check if parsing was successful.
-        if (!r || parenCount != 0) {
+        if (!mc.parsed_completely) {
             Logger->error(fmt::format(
                 "zone-file-parser.cpp (ParseZoneFileAndExtendGraphs) - Failed to completely parse zone file {} "
                 "containing {} lines",
-                file, l));
+                mc.file_name, mc.lines));
         } else {
             Logger->debug(fmt::format(
                 "zone-file-parser.cpp (ParseZoneFileAndExtendGraphs) - Successfully parsed zone file {} containing {} "
                 "lines",
-                file, l));
+                mc.file_name, mc.lines));
         }
 
         // Add the new zone graph to the context
+        zone_graph.BuildIndexes();
         context_.zoneId_to_zone.insert({zoneId, std::move(zone_graph)});
         auto it = context_.nameserver_zoneIds_map.find(nameserver);
         if (it == context_.nameserver_zoneIds_map.end()) {
@@ -444,7 +1115,127 @@ int Driver::ParseZoneFileAndExtendGraphs(string file, string nameserver, string
     } else {
         Logger->error(fmt::format(
             "zone-file-parser.cpp (ParseZoneFileAndExtendGraphs) - {} file doesn't have a SOA record and is ignored.",
-            file));
+            mc.file_name));
     }
     return mc.rrs_parsed;
 }
+
+int Driver::ParseZoneFileAndExtendGraphs(
+    string file,
+    string nameserver,
+    string origin,
+    bool lint,
+    int parser_threads,
+    size_t chunk_size)
+{
+    context_.zoneId_counter_++;
+    zone::Graph zone_graph(context_.zoneId_counter_);
+
+    ZoneFileBuffer buffer(file);
+    MiniContext mc = ParseOrLoadZoneFile(
+        buffer.get_contents(), zone_graph, file, origin, lint, parser_threads, chunk_size, &label_graph_);
+    return MergeZone(zone_graph, mc, nameserver);
+}
+
+int Driver::ParseWireZoneFileAndExtendGraphs(string file, string nameserver, bool lint)
+{
+    context_.zoneId_counter_++;
+    zone::Graph zone_graph(context_.zoneId_counter_);
+
+    ZoneFileBuffer buffer(file);
+    MiniContext mc =
+        ParseWireZoneFile(buffer.get_contents(), zone_graph, file, lint, kBulkLoadThreshold, &label_graph_);
+    return MergeZone(zone_graph, mc, nameserver);
+}
+
+long Driver::ParseZoneFilesInParallel(
+    const vector<tuple<string, string, string, ZoneFileFormat>> &zone_files,
+    bool lint,
+    int thread_count)
+{
+    // Zone ids are handed out in metadata order and every zone is merged in that same order, so the label graph and
+    // the context end up exactly as they would with the serial parser. A reader thread opens (and prefetches) at most
+    // kZoneFileReadAheadPerThread files per parser thread ahead of the merge point.
+    size_t n = zone_files.size();
+    int first_zoneId = context_.zoneId_counter_ + 1;
+    size_t read_ahead = static_cast<size_t>(thread_count) * kZoneFileReadAheadPerThread;
+
+    vector<unique_ptr<ZoneFileBuffer>> buffers(n);
+    vector<boost::optional<zone::Graph>> zone_graphs(n);
+    vector<MiniContext> mini_contexts(n);
+    vector<bool> parsed(n, false);
+    std::deque<size_t> to_parse;
+    bool finished_reading = false;
+    size_t merged = 0;
+    std::mutex m;
+    std::condition_variable cv;
+
+    std::thread reader = thread([&]() {
+        for (size_t i = 0; i < n; i++) {
+            {
+                std::unique_lock<std::mutex> lock(m);
+                cv.wait(lock, [&]() { return i < merged + read_ahead; });
+            }
+            buffers[i] = std::make_unique<ZoneFileBuffer>(std::get<0>(zone_files[i]));
+            buffers[i]->Prefetch();
+            std::lock_guard<std::mutex> lock(m);
+            to_parse.push_back(i);
+            cv.notify_all();
+        }
+        std::lock_guard<std::mutex> lock(m);
+        finished_reading = true;
+        cv.notify_all();
+    });
+
+    vector<std::thread> parsers;
+    for (int t = 0; t < thread_count; t++) {
+        parsers.push_back(thread([&]() {
+            while (true) {
+                size_t i;
+                {
+                    std::unique_lock<std::mutex> lock(m);
+                    cv.wait(lock, [&]() { return !to_parse.empty() || finished_reading; });
+                    if (to_parse.empty()) {
+                        return;
+                    }
+                    i = to_parse.front();
+                    to_parse.pop_front();
+                }
+                auto &[file, nameserver, origin, format] = zone_files[i];
+                zone::Graph zone_graph(first_zoneId + static_cast<int>(i));
+                MiniContext mc = format == ZoneFileFormat::WIRE
+                                     ? ParseWireZoneFile(buffers[i]->get_contents(), zone_graph, file, lint)
+                                     : ParseOrLoadZoneFile(
+                                           buffers[i]->get_contents(), zone_graph, file, origin, lint, 1,
+                                           kZoneFileChunkSize);
+                buffers[i].reset();
+                std::lock_guard<std::mutex> lock(m);
+                zone_graphs[i].emplace(std::move(zone_graph));
+                mini_contexts[i] = std::move(mc);
+                parsed[i] = true;
+                cv.notify_all();
+            }
+        }));
+    }
+
+    long rr_count = 0;
+    for (size_t i = 0; i < n; i++) {
+        {
+            std::unique_lock<std::mutex> lock(m);
+            cv.wait(lock, [&]() { return parsed[i]; });
+        }
+        context_.zoneId_counter_++;
+        rr_count += MergeZone(zone_graphs[i].get(), mini_contexts[i], std::get<1>(zone_files[i]));
+        zone_graphs[i] = boost::none;
+        mini_contexts[i] = MiniContext();
+        std::lock_guard<std::mutex> lock(m);
+        merged = i + 1;
+        cv.notify_all();
+    }
+
+    reader.join();
+    for (auto &t : parsers) {
+        t.join();
+    }
+    return rr_count;
+}
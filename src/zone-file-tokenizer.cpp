@@ -0,0 +1,167 @@
+#include "zone-file-tokenizer.h"
+
+#include <array>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define ZONE_TOKENIZER_AVX2
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define ZONE_TOKENIZER_SSE2
+#endif
+
+namespace
+{
+
+// Characters that end a word: whitespace, comments, parentheses, quotes and the escape character.
+constexpr std::array<bool, 256> MakeWordDelimiterTable()
+{
+    std::array<bool, 256> table{};
+    for (unsigned char c : {' ', '\t', '\r', '\n', ';', '(', ')', '"', '\\'}) {
+        table[c] = true;
+    }
+    return table;
+}
+
+constexpr std::array<bool, 256> kWordDelimiter = MakeWordDelimiterTable();
+
+inline bool IsWordDelimiter(char c)
+{
+    return kWordDelimiter[static_cast<unsigned char>(c)];
+}
+
+inline unsigned CountTrailingZeros(unsigned mask)
+{
+#if defined(_MSC_VER)
+    unsigned long index;
+    _BitScanForward(&index, mask);
+    return static_cast<unsigned>(index);
+#else
+    return static_cast<unsigned>(__builtin_ctz(mask));
+#endif
+}
+
+#if defined(ZONE_TOKENIZER_AVX2)
+constexpr size_t kBlock = 32;
+
+// Bit i is set if byte i may be a word delimiter. Bytes up to 0x20 are flagged together with one comparison and then
+// confirmed with the table since other control characters are rare.
+inline unsigned CandidateDelimiters(const char *p)
+{
+    __m256i chunk = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(p));
+    __m256i mask = _mm256_cmpeq_epi8(_mm256_min_epu8(chunk, _mm256_set1_epi8(0x20)), chunk);
+    mask = _mm256_or_si256(mask, _mm256_cmpeq_epi8(chunk, _mm256_set1_epi8(';')));
+    mask = _mm256_or_si256(mask, _mm256_cmpeq_epi8(chunk, _mm256_set1_epi8('(')));
+    mask = _mm256_or_si256(mask, _mm256_cmpeq_epi8(chunk, _mm256_set1_epi8(')')));
+    mask = _mm256_or_si256(mask, _mm256_cmpeq_epi8(chunk, _mm256_set1_epi8('"')));
+    mask = _mm256_or_si256(mask, _mm256_cmpeq_epi8(chunk, _mm256_set1_epi8('\\')));
+    return static_cast<unsigned>(_mm256_movemask_epi8(mask));
+}
+
+inline unsigned QuoteOrEscape(const char *p)
+{
+    __m256i chunk = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(p));
+    __m256i mask = _mm256_or_si256(
+        _mm256_cmpeq_epi8(chunk, _mm256_set1_epi8('"')), _mm256_cmpeq_epi8(chunk, _mm256_set1_epi8('\\')));
+    return static_cast<unsigned>(_mm256_movemask_epi8(mask));
+}
+#elif defined(ZONE_TOKENIZER_SSE2)
+constexpr size_t kBlock = 16;
+
+inline unsigned CandidateDelimiters(const char *p)
+{
+    __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p));
+    __m128i mask = _mm_cmpeq_epi8(_mm_min_epu8(chunk, _mm_set1_epi8(0x20)), chunk);
+    mask = _mm_or_si128(mask, _mm_cmpeq_epi8(chunk, _mm_set1_epi8(';')));
+    mask = _mm_or_si128(mask, _mm_cmpeq_epi8(chunk, _mm_set1_epi8('(')));
+    mask = _mm_or_si128(mask, _mm_cmpeq_epi8(chunk, _mm_set1_epi8(')')));
+    mask = _mm_or_si128(mask, _mm_cmpeq_epi8(chunk, _mm_set1_epi8('"')));
+    mask = _mm_or_si128(mask, _mm_cmpeq_epi8(chunk, _mm_set1_epi8('\\')));
+    return static_cast<unsigned>(_mm_movemask_epi8(mask));
+}
+
+inline unsigned QuoteOrEscape(const char *p)
+{
+    __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p));
+    __m128i mask = _mm_or_si128(_mm_cmpeq_epi8(chunk, _mm_set1_epi8('"')), _mm_cmpeq_epi8(chunk, _mm_set1_epi8('\\')));
+    return static_cast<unsigned>(_mm_movemask_epi8(mask));
+}
+#endif
+
+// Returns the first word delimiter in [p, end) or end.
+inline const char *FindDelimiter(const char *p, const char *end)
+{
+#if defined(ZONE_TOKENIZER_AVX2) || defined(ZONE_TOKENIZER_SSE2)
+    while (static_cast<size_t>(end - p) >= kBlock) {
+        unsigned mask = CandidateDelimiters(p);
+        while (mask) {
+            const char *candidate = p + CountTrailingZeros(mask);
+            if (IsWordDelimiter(*candidate)) {
+                return candidate;
+            }
+            mask &= mask - 1;
+        }
+        p += kBlock;
+    }
+#endif
+    while (p < end && !IsWordDelimiter(*p)) {
+        ++p;
+    }
+    return p;
+}
+
+// Returns the first '"' or '\' in [p, end) or end.
+inline const char *FindQuoteOrEscape(const char *p, const char *end)
+{
+#if defined(ZONE_TOKENIZER_AVX2) || defined(ZONE_TOKENIZER_SSE2)
+    while (static_cast<size_t>(end - p) >= kBlock) {
+        unsigned mask = QuoteOrEscape(p);
+        if (mask) {
+            return p + CountTrailingZeros(mask);
+        }
+        p += kBlock;
+    }
+#endif
+    while (p < end && *p != '"' && *p != '\\') {
+        ++p;
+    }
+    return p;
+}
+
+} // namespace
+
+const char *ZoneFileTokenizer::FindWordEnd(const char *p, const char *end)
+{
+    while (p < end) {
+        p = FindDelimiter(p, end);
+        if (p == end || *p != '\\') {
+            return p;
+        }
+        // A backslash escapes the next character unless it ends the line.
+        if (p + 1 < end && p[1] != '\n' && p[1] != '\r') {
+            p += 2;
+        } else {
+            ++p;
+        }
+    }
+    return end;
+}
+
+const char *ZoneFileTokenizer::FindQuoteEnd(const char *p, const char *end)
+{
+    while (p < end) {
+        p = FindQuoteOrEscape(p, end);
+        if (p == end || *p == '"') {
+            return p;
+        }
+        if (p + 1 == end) {
+            return end;
+        }
+        p += 2;
+    }
+    return end;
+}
@@ -0,0 +1,114 @@
+#ifndef ZONE_FILE_TOKENIZER_H_
+#define ZONE_FILE_TOKENIZER_H_
+
+#include <cstring>
+#include <string_view>
+
+enum TokenIds {
+    ID_COMMENT = 1000, // a comment block
+    ID_LPAREN,         // a left open parenthesis
+    ID_RPAREN,         // a right close parenthesis
+    ID_TEXT_WORD,      // TXT rdata
+    ID_WORD,           // a collection of non-space/newline characters
+    ID_EOL,            // a newline token
+    ID_WHITESPACE,     // some collection of whitespace
+    ID_OTHER           // any other character
+};
+
+struct ZoneFileToken {
+    TokenIds id_;
+    std::string_view value_;
+
+    TokenIds id() const
+    {
+        return id_;
+    }
+    std::string_view value() const
+    {
+        return value_;
+    }
+};
+
+// Single pass zone file tokenizer producing the same tokens as the regular expressions of the Spirit lexer it replaced
+// (zone_file_tokens in test/spirit-tokenizer.h). Word and quoted string boundaries are found with SSE2 (or AVX2 when the compiler targets it)
+// instead of a character by character DFA. Unlike the Spirit lexer a backslash escapes the following character
+// (RFC 1035 section 5.1), so "\;", "\(" or "\"" never terminate a word or a quoted string.
+class ZoneFileTokenizer
+{
+  private:
+    static const char *FindWordEnd(const char *, const char *);
+    static const char *FindQuoteEnd(const char *, const char *);
+
+  public:
+    // Invokes the callback for each token in order until it returns false. Returns false if the callback stopped the
+    // tokenization.
+    template <typename Callback> static bool Tokenize(std::string_view, Callback &&);
+};
+
+template <typename Callback> bool ZoneFileTokenizer::Tokenize(std::string_view input, Callback &&callback)
+{
+    const char *p = input.data();
+    const char *end = p + input.size();
+    while (p < end) {
+        const char *start = p;
+        TokenIds id;
+        switch (*p) {
+        case '\n':
+            id = ID_EOL;
+            ++p;
+            break;
+        case ' ':
+        case '\t':
+            id = ID_WHITESPACE;
+            while (++p < end && (*p == ' ' || *p == '\t')) {
+            }
+            break;
+        case '(':
+            id = ID_LPAREN;
+            ++p;
+            break;
+        case ')':
+            id = ID_RPAREN;
+            ++p;
+            break;
+        case ';': {
+            const char *eol = static_cast<const char *>(std::memchr(p, '\n', end - p));
+            eol = eol ? eol : end;
+            if (eol - p > 1) {
+                id = ID_COMMENT;
+                p = eol;
+            } else {
+                id = ID_OTHER;
+                ++p;
+            }
+            break;
+        }
+        case '"': {
+            const char *close = FindQuoteEnd(p + 1, end);
+            if (close != end) {
+                id = ID_TEXT_WORD;
+                p = close + 1;
+            } else {
+                // An unterminated quote is a single character token, exactly like the Spirit lexer.
+                id = ID_OTHER;
+                ++p;
+            }
+            break;
+        }
+        case '\r':
+            id = ID_OTHER;
+            ++p;
+            break;
+        default:
+            id = ID_WORD;
+            p = FindWordEnd(p, end);
+            break;
+        }
+        if (!callback(ZoneFileToken{id, std::string_view(start, p - start)})) {
+            return false;
+        }
+    }
+    return true;
+}
+
+#endif
@@ -0,0 +1,351 @@
+#include "zone-file-wire-reader.h"
+
+#include "spdlog/fmt/fmt.h"
+
+namespace
+{
+
+uint16_t Get16(std::string_view data, size_t offset)
+{
+    return static_cast<uint16_t>(static_cast<uint8_t>(data[offset]) << 8 | static_cast<uint8_t>(data[offset + 1]));
+}
+
+uint32_t Get32(std::string_view data, size_t offset)
+{
+    return static_cast<uint32_t>(Get16(data, offset)) << 16 | Get16(data, offset + 2);
+}
+
+// Name of the types the zone file parser reads (see GetTypeIndex in zone-file-parser.cpp), empty for the others.
+std::string TypeName(uint16_t type)
+{
+    switch (type) {
+    case 1:
+        return "A";
+    case 2:
+        return "NS";
+    case 5:
+        return "CNAME";
+    case 6:
+        return "SOA";
+    case 12:
+        return "PTR";
+    case 15:
+        return "MX";
+    case 16:
+        return "TXT";
+    case 28:
+        return "AAAA";
+    case 33:
+        return "SRV";
+    case 39:
+        return "DNAME";
+    case 43:
+        return "DS";
+    case 46:
+        return "RRSIG";
+    case 47:
+        return "NSEC";
+    case 99:
+        return "SPF";
+    default:
+        return "";
+    }
+}
+
+// Appends a byte of a label or of a character string, escaped as in RFC 1035 section 5.1.
+void AppendEscaped(std::string &out, uint8_t c, bool quoted)
+{
+    if (c < 0x21 || c > 0x7e) {
+        if (c == ' ' && quoted) {
+            out += ' ';
+        } else {
+            out += fmt::format("\\{:03d}", c);
+        }
+        return;
+    }
+    bool special = c == '"' || c == '\\';
+    if (!quoted) {
+        special = special || c == '.' || c == '(' || c == ')' || c == ';' || c == '@' || c == '$';
+    }
+    if (special) {
+        out += '\\';
+    }
+    out += static_cast<char>(c);
+}
+
+// RFC 5952 text form: lower case hexadecimal groups and the longest run of two or more zero groups shortened to "::".
+std::string FormatIPv6(std::string_view address)
+{
+    uint16_t groups[8];
+    for (int i = 0; i < 8; i++) {
+        groups[i] = Get16(address, 2 * i);
+    }
+    int best_start = -1, best_length = 1;
+    for (int i = 0; i < 8;) {
+        int j = i;
+        while (j < 8 && groups[j] == 0) {
+            j++;
+        }
+        if (j - i > best_length) {
+            best_start = i;
+            best_length = j - i;
+        }
+        i = j == i ? i + 1 : j;
+    }
+    std::string out;
+    for (int i = 0; i < 8; i++) {
+        if (i == best_start) {
+            out += "::";
+            i += best_length - 1;
+            continue;
+        }
+        if (!out.empty() && out.back() != ':') {
+            out += ':';
+        }
+        out += fmt::format("{:x}", groups[i]);
+    }
+    return out;
+}
+
+} // namespace
+
+ZoneFileWireReader::ZoneFileWireReader(std::string_view contents) : contents_(contents)
+{
+}
+
+bool ZoneFileWireReader::Fail(std::string reason)
+{
+    error_ = fmt::format("{} in the message at byte {}", reason, next_message_ - message_.size());
+    return false;
+}
+
+bool ZoneFileWireReader::ReadMessage()
+{
+    if (contents_.size() - next_message_ < 2) {
+        error_ = fmt::format("Truncated message length at byte {}", next_message_);
+        return false;
+    }
+    size_t length = Get16(contents_, next_message_);
+    if (contents_.size() - next_message_ - 2 < length) {
+        error_ = fmt::format("Truncated message at byte {}", next_message_);
+        return false;
+    }
+    message_ = contents_.substr(next_message_ + 2, length);
+    next_message_ += 2 + length;
+    if (message_.size() < 12) {
+        return Fail("Truncated header");
+    }
+    if (uint8_t rcode = message_[3] & 0x0f) {
+        return Fail(fmt::format("Response code {}", rcode));
+    }
+    uint16_t questions = Get16(message_, 4);
+    answers_ = Get16(message_, 6);
+    offset_ = 12;
+    std::string name;
+    for (; questions > 0; questions--) {
+        if (!ReadName(offset_, message_.size(), name)) {
+            return false;
+        }
+        if (message_.size() - offset_ < 4) {
+            return Fail("Truncated question");
+        }
+        offset_ += 4;
+    }
+    return true;
+}
+
+bool ZoneFileWireReader::ReadName(size_t &offset, size_t end, std::string &name)
+{
+    name.clear();
+    size_t position = offset;
+    // Every compression pointer has to point before the previous one, which rules out loops.
+    size_t pointer_limit = offset;
+    bool followed_pointer = false;
+    while (true) {
+        if (position >= end) {
+            return Fail("Name runs past the end of its field");
+        }
+        uint8_t length = message_[position];
+        if ((length & 0xc0) == 0xc0) {
+            if (position + 1 >= end) {
+                return Fail("Truncated compression pointer");
+            }
+            size_t target = (length & 0x3f) << 8 | static_cast<uint8_t>(message_[position + 1]);
+            if (target >= pointer_limit) {
+                return Fail("Compression pointer does not point backwards");
+            }
+            if (!followed_pointer) {
+                offset = position + 2;
+                followed_pointer = true;
+            }
+            pointer_limit = target;
+            position = target;
+            // The rest of the name may lie anywhere before the pointer.
+            end = message_.size();
+            continue;
+        }
+        if (length & 0xc0) {
+            return Fail("Unknown label type");
+        }
+        if (length == 0) {
+            if (!followed_pointer) {
+                offset = position + 1;
+            }
+            break;
+        }
+        if (end - position - 1 < length) {
+            return Fail("Label runs past the end of its field");
+        }
+        for (size_t i = position + 1; i <= position + length; i++) {
+            AppendEscaped(name, message_[i], false);
+        }
+        name += '.';
+        position += 1 + length;
+    }
+    if (name.empty()) {
+        name = ".";
+    }
+    return true;
+}
+
+bool ZoneFileWireReader::ReadRdata(uint16_t type, size_t position, size_t end, std::string &rdata)
+{
+    rdata.clear();
+    std::string name;
+    switch (type) {
+    case 1:
+        if (end - position != 4) {
+            return Fail("A record with rdata length other than 4");
+        }
+        rdata = fmt::format(
+            "{}.{}.{}.{}", static_cast<uint8_t>(message_[position]), static_cast<uint8_t>(message_[position + 1]),
+            static_cast<uint8_t>(message_[position + 2]), static_cast<uint8_t>(message_[position + 3]));
+        position = end;
+        break;
+    case 28:
+        if (end - position != 16) {
+            return Fail("AAAA record with rdata length other than 16");
+        }
+        rdata = FormatIPv6(message_.substr(position, 16));
+        position = end;
+        break;
+    case 2:
+    case 5:
+    case 12:
+    case 39:
+        if (!ReadName(position, end, rdata)) {
+            return false;
+        }
+        break;
+    case 15:
+        if (end - position < 2) {
+            return Fail("Truncated MX record");
+        }
+        rdata = fmt::format("{} ", Get16(message_, position));
+        position += 2;
+        if (!ReadName(position, end, name)) {
+            return false;
+        }
+        rdata += name;
+        break;
+    case 33:
+        if (end - position < 6) {
+            return Fail("Truncated SRV record");
+        }
+        rdata = fmt::format(
+            "{} {} {} ", Get16(message_, position), Get16(message_, position + 2), Get16(message_, position + 4));
+        position += 6;
+        if (!ReadName(position, end, name)) {
+            return false;
+        }
+        rdata += name;
+        break;
+    case 6:
+        if (!ReadName(position, end, rdata)) {
+            return false;
+        }
+        if (!ReadName(position, end, name)) {
+            return false;
+        }
+        if (end - position != 20) {
+            return Fail("Truncated SOA record");
+        }
+        rdata += ' ' + name;
+        for (int i = 0; i < 5; i++, position += 4) {
+            rdata += fmt::format(" {}", Get32(message_, position));
+        }
+        break;
+    case 16:
+    case 99:
+        while (position < end) {
+            size_t length = static_cast<uint8_t>(message_[position]);
+            if (end - position - 1 < length) {
+                return Fail("Truncated character string");
+            }
+            if (!rdata.empty()) {
+                rdata += ' ';
+            }
+            rdata += '"';
+            for (size_t i = position + 1; i <= position + length; i++) {
+                AppendEscaped(rdata, message_[i], true);
+            }
+            rdata += '"';
+            position += 1 + length;
+        }
+        break;
+    default:
+        // DS, RRSIG and NSEC are only stored, so they are kept in the generic format of RFC 3597.
+        rdata = fmt::format("\\# {}", end - position);
+        if (position < end) {
+            rdata += ' ';
+        }
+        for (; position < end; position++) {
+            rdata += fmt::format("{:02x}", static_cast<uint8_t>(message_[position]));
+        }
+        break;
+    }
+    if (position != end) {
+        return Fail("Record data is longer than its fields");
+    }
+    return true;
+}
+
+bool ZoneFileWireReader::Next(Record &record)
+{
+    while (error_.empty()) {
+        if (answers_ == 0) {
+            if (next_message_ == contents_.size() || !ReadMessage()) {
+                return false;
+            }
+            continue;
+        }
+        answers_--;
+        if (!ReadName(offset_, message_.size(), record.name)) {
+            return false;
+        }
+        if (message_.size() - offset_ < 10) {
+            return Fail("Truncated record");
+        }
+        uint16_t type = Get16(message_, offset_);
+        record.class_ = Get16(message_, offset_ + 2);
+        record.ttl = Get32(message_, offset_ + 4);
+        size_t rdata_length = Get16(message_, offset_ + 8);
+        offset_ += 10;
+        if (message_.size() - offset_ < rdata_length) {
+            return Fail("Truncated record data");
+        }
+        size_t rdata_start = offset_;
+        offset_ += rdata_length;
+        record.type = TypeName(type);
+        if (record.type.empty()) {
+            continue;
+        }
+        return ReadRdata(type, rdata_start, offset_, record.rdata);
+    }
+    return false;
+}
+
+const std::string &ZoneFileWireReader::error() const
+{
+    return error_;
+}
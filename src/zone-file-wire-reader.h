@@ -0,0 +1,46 @@
+#ifndef ZONE_FILE_WIRE_READER_H_
+#define ZONE_FILE_WIRE_READER_H_
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+// Reader of a zone transfer dump in the RFC 1035 wire format: the DNS messages of an AXFR response, each preceded by
+// its two byte length exactly as they arrive over TCP (section 4.2.2). The records of the answer sections are decoded,
+// following name compression pointers, into the same presentation format the zone file parser builds records from.
+class ZoneFileWireReader
+{
+  public:
+    struct Record {
+        std::string name;
+        std::string type;
+        uint16_t class_ = 1;
+        uint32_t ttl = 0;
+        std::string rdata;
+    };
+
+  private:
+    std::string_view contents_;
+    // Start of the next message in the dump.
+    size_t next_message_ = 0;
+    std::string_view message_;
+    // Offset of the next record in the current message and the number of records left in its answer section.
+    size_t offset_ = 0;
+    uint16_t answers_ = 0;
+    std::string error_;
+
+    bool Fail(std::string);
+    bool ReadMessage();
+    bool ReadName(size_t &, size_t, std::string &);
+    bool ReadRdata(uint16_t, size_t, size_t, std::string &);
+
+  public:
+    explicit ZoneFileWireReader(std::string_view);
+
+    // Reads the next record of a type that the zone file parser reads as well; the records of other types are skipped.
+    // Returns false at the end of the dump, or when the dump is malformed in which case error() tells why.
+    bool Next(Record &);
+    const std::string &error() const;
+};
+
+#endif
@@ -1,6 +1,13 @@
 ﻿#include "zone-graph.h"
 #include "utils.h"
 
+#include <boost/unordered_map.hpp>
+#include <boost/unordered_set.hpp>
+#include <numeric>
+
+// Number of records from which AddResourceRecords keeps a hash set of the records of a node.
+const size_t kLargeRRSet = 16;
+
 zone::Graph::Graph(int zoneId)
 {
     root_ = boost::add_vertex(*this);
@@ -13,25 +20,29 @@ const int &zone::Graph::get_id()
     return id_;
 }
 
-const vector<NodeLabel> &zone::Graph::get_origin() const
+const DomainName &zone::Graph::get_origin() const
 {
     return origin_;
 }
 
+const CanonicalIndex &zone::Graph::get_canonical_index() const
+{
+    return canonical_index_;
+}
+
 void zone::Graph::AddGlueRecords(vector<ResourceRecord> &ns_records) const
 {
     vector<ResourceRecord> merged_records;
     for (auto &record : ns_records) {
-        vector<NodeLabel> ns_name = LabelUtils::StringToLabels(record.get_rdata());
+        const DomainName &ns_name = record.get_target();
         int index = 0;
         merged_records.push_back(std::move(record));
         VertexDescriptor closest_encloser = GetAncestor(root_, ns_name, index);
         if (ns_name.size() == index) {
             // found the node
-            for (auto &noderecords : (*this)[closest_encloser].rrs) {
-                if (noderecords.get_type() == RRType::A || noderecords.get_type() == RRType::AAAA) {
-                    merged_records.push_back(noderecords);
-                }
+            for (RRType type : {RRType::A, RRType::AAAA}) {
+                RecordRange rrset = RRSet(closest_encloser, type);
+                merged_records.insert(merged_records.end(), rrset.begin(), rrset.end());
             }
         }
     }
@@ -40,9 +51,10 @@ void zone::Graph::AddGlueRecords(vector<ResourceRecord> &ns_records) const
 
 zone::Graph::VertexDescriptor zone::Graph::AddNodes(
     zone::Graph::VertexDescriptor closest_encloser,
-    const vector<NodeLabel> &labels,
+    const DomainName &labels,
     const int &index)
 {
+    static const NodeLabel wildcard("*");
     for (int i = index; i < labels.size(); i++) {
         VertexDescriptor u = boost::add_vertex(*this);
         (*this)[u].name = labels[i];
@@ -58,6 +70,9 @@ zone::Graph::VertexDescriptor zone::Graph::AddNodes(
             LabelToVertex &m = vertex_to_child_map_.find(closest_encloser)->second;
             m[labels[i]] = u;
         }
+        if (labels[i] == wildcard) {
+            (*this)[closest_encloser].wildcard_child = true;
+        }
         closest_encloser = u;
     }
     return closest_encloser;
@@ -65,20 +80,18 @@ zone::Graph::VertexDescriptor zone::Graph::AddNodes(
 
 void zone::Graph::CheckGlueRecordsPresence(zone::Graph::VertexDescriptor start, const Nameserver &ns)
 {
-    for (auto &rr : (*this)[start].rrs) {
-        if (rr.get_type() == RRType::NS) {
-            vector<ResourceRecord> tmp = {rr};
-            if (RequireGlueRecords(tmp)) {
-                AddGlueRecords(tmp);
-                if (tmp.size() == 1) {
-                    // missing the necessary glue record.
-                    json j;
-                    j["Server"] = ns.get();
-                    j["Zone"] = LabelUtils::LabelsToString(origin_);
-                    j["Violation"] = "Missing Glue Record";
-                    j["Resource Record"] = rr.toString();
-                    LintUtils::WriteIssueToFile(j, true);
-                }
+    for (ResourceRecord rr : RRSet(start, RRType::NS)) {
+        vector<ResourceRecord> tmp = {rr};
+        if (RequireGlueRecords(tmp)) {
+            AddGlueRecords(tmp);
+            if (tmp.size() == 1) {
+                // missing the necessary glue record.
+                json j;
+                j["Server"] = ns.get();
+                j["Zone"] = LabelUtils::LabelsToString(origin_);
+                j["Violation"] = "Missing Glue Record";
+                j["Resource Record"] = rr.toString();
+                LintUtils::WriteIssueToFile(j, true);
             }
         }
     }
@@ -100,7 +113,8 @@ tuple<zone::RRAddCode, boost::optional<zone::Graph::VertexDescriptor>> zone::Gra
        NO RRs should exist under a DNAME node but its harder to enforce at the time of addition as they may be added in
        any order. Such RRs are ignored during QueryLookUpAtZone.
    */
-    vector<NodeLabel> labels = record.get_name();
+    DropIndexes();
+    const DomainName &labels = record.get_name();
     int index = 0;
     vector<VertexDescriptor> vertices_to_create_maps{};
     VertexDescriptor closest_encloser = GetAncestor(root_, labels, vertices_to_create_maps, index);
@@ -111,7 +125,8 @@ tuple<zone::RRAddCode, boost::optional<zone::Graph::VertexDescriptor>> zone::Gra
 
     for (auto &rr : (*this)[node].rrs) {
         if (rr.get_type() == record.get_type()) {
-            if (rr.get_ttl() == record.get_ttl() && rr.get_rdata() == record.get_rdata()) {
+            // Records of the same type and rdata share their rdata.
+            if (rr.get_ttl() == record.get_ttl() && &rr.get_rdata() == &record.get_rdata()) {
                 return {RRAddCode::DUPLICATE, {}};
             }
             if (record.get_type() == RRType::CNAME) {
@@ -124,13 +139,295 @@ tuple<zone::RRAddCode, boost::optional<zone::Graph::VertexDescriptor>> zone::Gra
             return {RRAddCode::CNAME_OTHER, node};
         }
     }
-    (*this)[node].rrs.push_back(record);
+    InsertRecord(node, record);
     if (record.get_type() == RRType::SOA) {
         origin_ = record.get_name();
     }
     return {RRAddCode::SUCCESS, node};
 }
 
+vector<tuple<zone::RRAddCode, boost::optional<zone::Graph::VertexDescriptor>>> zone::Graph::AddResourceRecords(
+    const vector<ResourceRecord> &records)
+{
+    /*
+       Bulk version of AddResourceRecord. The result for every record, the vertex numbering and the order of the
+       children are the same as adding the records one by one, but the owner names are resolved in a single pass over
+       the records sorted in canonical order and the RRset checks use a hash set instead of scanning the records of the
+       node. The records may go into a zone that already has some; they are then merged under the existing nodes.
+   */
+    vector<tuple<RRAddCode, boost::optional<VertexDescriptor>>> results;
+    results.reserve(records.size());
+    DropIndexes();
+    if (num_vertices(*this) > 1) {
+        // Every node with many children gets its map, so that the existing children are not scanned below.
+        ConstructChildLabelsToVertexDescriptorMaps();
+    }
+    auto find_child = [this](VertexDescriptor v, const NodeLabel &label) -> boost::optional<VertexDescriptor> {
+        auto map = vertex_to_child_map_.find(v);
+        if (map != vertex_to_child_map_.end()) {
+            auto it = map->second.find(label);
+            return it != map->second.end() ? boost::make_optional(it->second) : boost::none;
+        }
+        for (VertexDescriptor u : boost::make_iterator_range(adjacent_vertices(v, *this))) {
+            if ((*this)[u].name == label) {
+                return u;
+            }
+        }
+        return {};
+    };
+
+    vector<DomainName> names;
+    names.reserve(records.size());
+    for (auto &record : records) {
+        names.push_back(record.get_name());
+    }
+    vector<size_t> order(records.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [&names](size_t a, size_t b) {
+        const DomainName &x = names[a];
+        const DomainName &y = names[b];
+        for (size_t i = 0; i < x.size() && i < y.size(); i++) {
+            // Equal labels have the same id, so only the first differing label is compared as a string.
+            if (x[i] != y[i]) {
+                return x[i].get() < y[i].get();
+            }
+        }
+        return x.size() < y.size();
+    });
+
+    // In canonical order the names below a node are contiguous, so a node is either on the path of the previous name
+    // or new. Node 0 is the root. A new node below an existing vertex may already have a vertex itself; the others
+    // only get one once a record (in file order) reaches them.
+    struct Node {
+        size_t parent;
+        NodeLabel label;
+        boost::optional<VertexDescriptor> vertex;
+    };
+    vector<Node> nodes{{0, (*this)[root_].name, root_}};
+    vector<size_t> record_node(records.size());
+    vector<size_t> path;
+    const DomainName *previous = nullptr;
+    for (size_t i : order) {
+        const DomainName &name = names[i];
+        size_t common = 0;
+        if (previous) {
+            while (common < path.size() && common < name.size() && (*previous)[common] == name[common]) {
+                common++;
+            }
+        }
+        path.resize(common);
+        for (size_t depth = common; depth < name.size(); depth++) {
+            size_t parent = path.empty() ? 0 : path.back();
+            boost::optional<VertexDescriptor> vertex;
+            if (nodes[parent].vertex) {
+                vertex = find_child(nodes[parent].vertex.get(), name[depth]);
+            }
+            nodes.push_back({parent, name[depth], vertex});
+            path.push_back(nodes.size() - 1);
+        }
+        record_node[i] = path.empty() ? 0 : path.back();
+        previous = &name;
+    }
+
+    // Small RRsets are scanned like AddResourceRecord does; once a node holds kLargeRRSet records its records are
+    // looked up in a hash set instead.
+    using RRKey = tuple<int, uint32_t, const string *>;
+    boost::unordered_map<VertexDescriptor, boost::unordered_set<RRKey>> large_rrsets;
+    vector<size_t> missing;
+    static const NodeLabel wildcard("*");
+    for (size_t i = 0; i < records.size(); i++) {
+        const ResourceRecord &record = records[i];
+        // Creates the missing ancestors top down, exactly as AddNodes does.
+        for (size_t n = record_node[i]; !nodes[n].vertex; n = nodes[n].parent) {
+            missing.push_back(n);
+        }
+        for (; !missing.empty(); missing.pop_back()) {
+            Node &n = nodes[missing.back()];
+            VertexDescriptor parent = nodes[n.parent].vertex.get();
+            VertexDescriptor u = boost::add_vertex(*this);
+            (*this)[u].name = n.label;
+            bool b;
+            boost::tie(std::ignore, b) = boost::add_edge(parent, u, *this);
+            if (!b) {
+                Logger->critical(fmt::format("zone-graph.cpp (AddResourceRecords) - Unable to add edge to the graph"));
+                exit(EXIT_FAILURE);
+            }
+            auto map = vertex_to_child_map_.find(parent);
+            if (map != vertex_to_child_map_.end()) {
+                map->second[n.label] = u;
+            }
+            if (n.label == wildcard) {
+                (*this)[parent].wildcard_child = true;
+            }
+            n.vertex = u;
+        }
+        VertexDescriptor node = nodes[record_node[i]].vertex.get();
+
+        // A node holding a CNAME holds nothing else and a node holds at most one DNAME, so the first conflicting
+        // record AddResourceRecord would find only depends on whether the record is a duplicate.
+        vector<ResourceRecord> &rrs = (*this)[node].rrs;
+        RRType type = record.get_type();
+        auto large_rrset = large_rrsets.find(node);
+        bool duplicate = false;
+        if (large_rrset != large_rrsets.end()) {
+            duplicate = large_rrset->second.count({type, record.get_ttl(), &record.get_rdata()}) > 0;
+        } else {
+            for (auto &rr : rrs) {
+                if (rr.get_type() == type && rr.get_ttl() == record.get_ttl() &&
+                    &rr.get_rdata() == &record.get_rdata()) {
+                    duplicate = true;
+                    break;
+                }
+            }
+        }
+        RRAddCode code = RRAddCode::SUCCESS;
+        if (!rrs.empty() && (type == RRType::CNAME || rrs[0].get_type() == RRType::CNAME)) {
+            if (rrs[0].get_type() != type) {
+                code = RRAddCode::CNAME_OTHER;
+            } else {
+                code = duplicate ? RRAddCode::DUPLICATE : RRAddCode::CNAME_MULTIPLE;
+            }
+        } else if (duplicate) {
+            code = RRAddCode::DUPLICATE;
+        } else if (type == RRType::DNAME) {
+            for (auto &rr : rrs) {
+                if (rr.get_type() == RRType::DNAME) {
+                    code = RRAddCode::DNAME_MULTIPLE;
+                }
+            }
+        }
+        if (code == RRAddCode::DUPLICATE) {
+            results.push_back({code, {}});
+            continue;
+        }
+        results.push_back({code, node});
+        if (code == RRAddCode::SUCCESS) {
+            InsertRecord(node, record);
+            if (large_rrset != large_rrsets.end()) {
+                large_rrset->second.insert({type, record.get_ttl(), &record.get_rdata()});
+            } else if (rrs.size() >= kLargeRRSet) {
+                auto &rrset = large_rrsets[node];
+                for (auto &rr : rrs) {
+                    rrset.insert({rr.get_type(), rr.get_ttl(), &rr.get_rdata()});
+                }
+            }
+            if (type == RRType::SOA) {
+                origin_ = names[i];
+            }
+        }
+    }
+    ConstructChildLabelsToVertexDescriptorMaps();
+    return results;
+}
+
+void zone::Graph::BuildCanonicalIndex()
+{
+    canonical_index_.clear();
+    if (num_vertices(*this) >= CanonicalIndex::kNone) {
+        Logger->critical(fmt::format("zone-graph.cpp (BuildCanonicalIndex) - The zone is too large to be indexed"));
+        exit(EXIT_FAILURE);
+    }
+    // Preorder walk with the children of every node visited in canonical order; a stack entry is a vertex and the
+    // index entry of its parent.
+    vector<tuple<VertexDescriptor, uint32_t>> stack{{root_, 0}};
+    vector<VertexDescriptor> children;
+    uint32_t next = 0;
+    while (!stack.empty()) {
+        auto [v, parent] = stack.back();
+        stack.pop_back();
+        canonical_index_.Append(parent, (*this)[v].name, static_cast<uint32_t>(v), (*this)[v].rr_types);
+        children.assign(adjacent_vertices(v, *this).first, adjacent_vertices(v, *this).second);
+        // Pushed in reverse so that the first child is visited first.
+        std::sort(children.begin(), children.end(), [this](VertexDescriptor a, VertexDescriptor b) {
+            return CanonicalIndex::LabelLess((*this)[b].name, (*this)[a].name);
+        });
+        for (VertexDescriptor u : children) {
+            stack.push_back({u, next});
+        }
+        next++;
+    }
+    canonical_index_.Finish();
+}
+
+void zone::Graph::BuildChildIndex()
+{
+    child_index_.Build(*this, [](EdgeDescriptor) { return true; });
+    vertex_to_child_map_.clear();
+}
+
+void zone::Graph::BuildIndexes()
+{
+    BuildChildIndex();
+    BuildRecordArena();
+    BuildCanonicalIndex();
+    BuildReferrals();
+}
+
+void zone::Graph::BuildRecordArena()
+{
+    if (records_packed_) {
+        return;
+    }
+    size_t count = 0;
+    for (VertexDescriptor v : boost::make_iterator_range(vertices(*this))) {
+        count += (*this)[v].rrs.size();
+    }
+    if (count >= std::numeric_limits<uint32_t>::max()) {
+        Logger->critical(
+            fmt::format("zone-graph.cpp (BuildRecordArena) - The zone has too many records to be indexed"));
+        exit(EXIT_FAILURE);
+    }
+    vector<ResourceRecord> arena;
+    arena.reserve(count);
+    (*this)[root_].authoritative = !(*this)[root_].zone_cut();
+    // A vertex is always created after its parent, so the parent is final when the flag is passed down.
+    for (VertexDescriptor v : boost::make_iterator_range(vertices(*this))) {
+        Vertex &vertex = (*this)[v];
+        for (VertexDescriptor u : boost::make_iterator_range(adjacent_vertices(v, *this))) {
+            (*this)[u].authoritative = vertex.authoritative && !(*this)[u].zone_cut();
+        }
+        vertex.rrsets = static_cast<uint32_t>(rrsets_.size());
+        for (auto &rr : vertex.rrs) {
+            uint32_t i = static_cast<uint32_t>(arena.size());
+            if (rrsets_.size() == vertex.rrsets || arena.back().get_type() != rr.get_type()) {
+                rrsets_.push_back({i, i});
+            }
+            arena.push_back(std::move(rr));
+            rrsets_.back().end++;
+        }
+        vertex.rrs = {};
+    }
+    record_arena_ = std::make_shared<const vector<ResourceRecord>>(std::move(arena));
+    records_packed_ = true;
+}
+
+void zone::Graph::BuildReferrals()
+{
+    referrals_.clear();
+    for (VertexDescriptor v : boost::make_iterator_range(vertices(*this))) {
+        Vertex &vertex = (*this)[v];
+        vertex.referral = kNoReferral;
+        if (!vertex.rr_types[RRType::NS]) {
+            continue;
+        }
+        RecordRange rrset = RRSet(v, RRType::NS);
+        Referral referral;
+        vector<ResourceRecord> records(rrset.begin(), rrset.end());
+        referral.glue_required = RequireGlueRecords(records);
+        AddGlueRecords(records);
+        for (auto &record : records) {
+            if (record.get_type() == RRType::NS) {
+                referral.pairs.push_back({record, {}});
+            } else {
+                std::get<1>(referral.pairs.back()).push_back(record);
+            }
+        }
+        referral.records = RRSetView(std::move(records));
+        vertex.referral = static_cast<uint32_t>(referrals_.size());
+        referrals_.push_back(std::move(referral));
+    }
+}
+
 void zone::Graph::CheckGlueRecordsPresence(const Nameserver &ns)
 {
     CheckGlueRecordsPresence(root_, ns);
@@ -149,25 +446,78 @@ bool zone::Graph::CheckZoneMembership(const ResourceRecord &record, const string
     return LabelUtils::SubDomainCheck(origin_, record.get_name());
 }
 
+const zone::Referral *zone::Graph::FindReferral(const DomainName &name) const
+{
+    if (referrals_.empty()) {
+        return nullptr;
+    }
+    boost::optional<VertexDescriptor> v;
+    if (!canonical_index_.empty()) {
+        const CanonicalIndex::Entry *entry = canonical_index_.Find(name);
+        if (entry) {
+            v = entry->vertex;
+        }
+    } else {
+        int index = 0;
+        VertexDescriptor closest_encloser = GetAncestor(root_, name, index);
+        if (index == name.size()) {
+            v = closest_encloser;
+        }
+    }
+    return v ? ReferralAt(v.get()) : nullptr;
+}
+
+const zone::Referral *zone::Graph::ReferralAt(VertexDescriptor v) const
+{
+    if ((*this)[v].referral == kNoReferral) {
+        return nullptr;
+    }
+    return &referrals_[(*this)[v].referral];
+}
+
 vector<ResourceRecord> zone::Graph::LookUpGlueRecords(const vector<ResourceRecord> &ns_records) const
 {
     vector<ResourceRecord> ip_records;
     for (auto &record : ns_records) {
-        vector<NodeLabel> ns_name = LabelUtils::StringToLabels(record.get_rdata());
+        const DomainName &ns_name = record.get_target();
         int index = 0;
         VertexDescriptor closest_encloser = GetAncestor(root_, ns_name, index);
         if (ns_name.size() == index) {
             // found the node
-            for (auto &noderecords : (*this)[closest_encloser].rrs) {
-                if (noderecords.get_type() == RRType::A || noderecords.get_type() == RRType::AAAA) {
-                    ip_records.push_back(noderecords);
-                }
+            for (RRType type : {RRType::A, RRType::AAAA}) {
+                RecordRange rrset = RRSet(closest_encloser, type);
+                ip_records.insert(ip_records.end(), rrset.begin(), rrset.end());
             }
         }
     }
     return ip_records;
 }
 
+void zone::Graph::DropIndexes()
+{
+    canonical_index_.clear();
+    if (!referrals_.empty()) {
+        for (VertexDescriptor v : boost::make_iterator_range(vertices(*this))) {
+            (*this)[v].referral = kNoReferral;
+        }
+        referrals_ = {};
+    }
+    if (records_packed_) {
+        // Answers may still share the arena, so the records are copied out of it.
+        for (VertexDescriptor v : boost::make_iterator_range(vertices(*this))) {
+            RecordRange records = Records(v);
+            (*this)[v].rrs.assign(records.begin(), records.end());
+        }
+        record_arena_.reset();
+        rrsets_ = {};
+        records_packed_ = false;
+    }
+    if (!child_index_.empty()) {
+        child_index_.clear();
+        ConstructChildLabelsToVertexDescriptorMaps();
+    }
+}
+
 void zone::Graph::ConstructChildLabelsToVertexDescriptorMap(const zone::Graph::VertexDescriptor node)
 {
     zone::Graph::LabelToVertex m;
@@ -178,9 +528,19 @@ void zone::Graph::ConstructChildLabelsToVertexDescriptorMap(const zone::Graph::V
     vertex_to_child_map_.insert({node, std::move(m)});
 }
 
+void zone::Graph::ConstructChildLabelsToVertexDescriptorMaps()
+{
+    // Used after loading a snapshot or a bulk load: every node that may be searched through a map gets one upfront.
+    for (VertexDescriptor v : boost::make_iterator_range(vertices(*this))) {
+        if (out_degree(v, *this) > kHashMapThreshold) {
+            ConstructChildLabelsToVertexDescriptorMap(v);
+        }
+    }
+}
+
 zone::Graph::VertexDescriptor zone::Graph::GetAncestor(
     zone::Graph::VertexDescriptor closest_encloser,
-    const vector<NodeLabel> &labels,
+    const DomainName &labels,
     int &index) const
 {
     vector<VertexDescriptor> vertices_to_create_maps{};
@@ -189,7 +549,7 @@ zone::Graph::VertexDescriptor zone::Graph::GetAncestor(
 
 zone::Graph::VertexDescriptor zone::Graph::GetAncestor(
     zone::Graph::VertexDescriptor closest_encloser,
-    const vector<NodeLabel> &labels,
+    const DomainName &labels,
     vector<VertexDescriptor> &vertices_to_create_maps,
     int &index) const
 {
@@ -198,7 +558,13 @@ zone::Graph::VertexDescriptor zone::Graph::GetAncestor(
     if (labels.size() == index) {
         return closest_encloser;
     }
-    if (vertex_to_child_map_.find(closest_encloser) != vertex_to_child_map_.end()) {
+    if (!child_index_.empty()) {
+        auto child = child_index_.Find(closest_encloser, labels[index]);
+        if (child) {
+            index++;
+            return GetAncestor(child.get(), labels, vertices_to_create_maps, index);
+        }
+    } else if (vertex_to_child_map_.find(closest_encloser) != vertex_to_child_map_.end()) {
         const LabelToVertex &m = vertex_to_child_map_.find(closest_encloser)->second;
         auto it = m.find(labels[index]);
         if (it != m.end()) {
@@ -223,99 +589,107 @@ zone::Graph::VertexDescriptor zone::Graph::GetAncestor(
 
 zone::Graph::VertexDescriptor zone::Graph::GetClosestEncloser(
     zone::Graph::VertexDescriptor closest_encloser,
-    const vector<NodeLabel> &labels,
+    const DomainName &labels,
     int &index) const
 {
 
     if (labels.size() == index) {
         return closest_encloser;
     }
-    if (vertex_to_child_map_.find(closest_encloser) != vertex_to_child_map_.end()) {
+    boost::optional<VertexDescriptor> child;
+    if (!child_index_.empty()) {
+        child = child_index_.Find(closest_encloser, labels[index]);
+    } else if (vertex_to_child_map_.find(closest_encloser) != vertex_to_child_map_.end()) {
         const LabelToVertex &m = vertex_to_child_map_.find(closest_encloser)->second;
         auto it = m.find(labels[index]);
         if (it != m.end()) {
-            closest_encloser = it->second;
-            index++;
-            std::bitset<RRType::N> nodeRRtypes = GetNodeRRTypes((*this)[closest_encloser].rrs);
-            // If at any node, we encoutner NS records and they are not part of authoritative data then the search stops
-            // here as they mark cuts along the bottom of a zone.
-            // If not NS but we encounter a node with DNAME then that takes precedence.
-            if (nodeRRtypes[RRType::NS] == 1 and nodeRRtypes[RRType::SOA] != 1) {
-                return closest_encloser;
-            } else if (nodeRRtypes[RRType::DNAME] == 1 && labels.size() != index) {
-                // It should not be the last label and the current node has a DNAME RR
-                return closest_encloser;
-            }
-            return GetClosestEncloser(closest_encloser, labels, index);
+            child = it->second;
         }
     } else {
         for (VertexDescriptor v : boost::make_iterator_range(adjacent_vertices(closest_encloser, *this))) {
             if ((*this)[v].name == labels[index]) {
-                std::bitset<RRType::N> nodeRRtypes = GetNodeRRTypes((*this)[v].rrs);
-                index++;
-                if (nodeRRtypes[RRType::NS] == 1 and nodeRRtypes[RRType::SOA] != 1) {
-                    return v;
-                } else if (nodeRRtypes[RRType::DNAME] == 1 && labels.size() != index) {
-                    // It should not be the last label and the current node has a DNAME RR
-                    return v;
-                }
-                closest_encloser = v;
-                return GetClosestEncloser(closest_encloser, labels, index);
+                child = v;
+                break;
             }
         }
     }
-    return closest_encloser;
+    if (!child) {
+        return closest_encloser;
+    }
+    index++;
+    const Vertex &node = (*this)[child.get()];
+    // If at any node, we encoutner NS records and they are not part of authoritative data then the search stops
+    // here as they mark cuts along the bottom of a zone.
+    // If not NS but we encounter a node with DNAME then that takes precedence.
+    if (node.zone_cut()) {
+        return child.get();
+    } else if (node.rr_types[RRType::DNAME] == 1 && labels.size() != index) {
+        // It should not be the last label and the current node has a DNAME RR
+        return child.get();
+    }
+    return GetClosestEncloser(child.get(), labels, index);
 }
 
-std::bitset<RRType::N> zone::Graph::GetNodeRRTypes(const vector<ResourceRecord> &rrs) const
+void zone::Graph::InsertRecord(VertexDescriptor node, const ResourceRecord &record)
 {
-    std::bitset<RRType::N> rrTypes;
-    for (auto &record : rrs) {
-        rrTypes[record.get_type()] = 1;
+    vector<ResourceRecord> &rrs = (*this)[node].rrs;
+    auto it = std::upper_bound(rrs.begin(), rrs.end(), record.get_type(), [](RRType type, const ResourceRecord &rr) {
+        return type < rr.get_type();
+    });
+    rrs.insert(it, record);
+    // Records of the types groot does not model sort last and stay out of the bitmap.
+    if (record.get_type() != RRType::N) {
+        (*this)[node].rr_types.set(record.get_type());
     }
-    return rrTypes;
+}
+
+boost::optional<zone::Graph::VertexDescriptor> zone::Graph::WildcardChild(VertexDescriptor closest_encloser) const
+{
+    if (!child_index_.empty()) {
+        return child_index_.Wildcard(closest_encloser);
+    }
+    if (!(*this)[closest_encloser].wildcard_child) {
+        return {};
+    }
+    NodeLabel wildcard{"*"};
+    for (VertexDescriptor v : boost::make_iterator_range(adjacent_vertices(closest_encloser, *this))) {
+        if ((*this)[v].name == wildcard) {
+            return v;
+        }
+    }
+    return {};
 }
 
 bool zone::Graph::WildcardMatch(
-    VertexDescriptor closest_encloser,
+    boost::optional<VertexDescriptor> wildcard_child,
     std::bitset<RRType::N> &node_rr_types,
     vector<zone::LookUpAnswer> &answers,
     const EC &query) const
 {
-    NodeLabel wildcard{"*"};
-    for (VertexDescriptor v : boost::make_iterator_range(adjacent_vertices(closest_encloser, *this))) {
-        if ((*this)[v].name == wildcard) {
-            vector<ResourceRecord> matchingRRs;
-            std::bitset<RRType::N> queryTypesFound;
-            for (auto &record : (*this)[v].rrs) {
-                if (record.get_type() == RRType::CNAME) {
-                    answers.clear();
-                    matchingRRs.clear();
-                    matchingRRs.push_back(record);
-                    // Return type is Ans if only CNAME is requested
-                    if (query.rrTypes[RRType::CNAME] && query.rrTypes.count() == 1) {
-                        answers.push_back(std::make_tuple(ReturnTag::ANS, node_rr_types, matchingRRs));
-                    } else {
-                        answers.push_back(std::make_tuple(ReturnTag::REWRITE, node_rr_types, matchingRRs));
-                    }
-                    return true; // If CNAME then other records would be ignored.
-                }
-                if (query.rrTypes[record.get_type()] == 1) {
-                    matchingRRs.push_back(record);
-                    queryTypesFound.set(record.get_type());
-                }
-                // NS records at a wildcard node are forbidden.
-            }
-            if (queryTypesFound.count())
-                answers.push_back(std::make_tuple(ReturnTag::ANS, queryTypesFound, matchingRRs));
-            if ((queryTypesFound ^ query.rrTypes).count()) {
-                answers.push_back(
-                    std::make_tuple(ReturnTag::ANS, queryTypesFound ^ query.rrTypes, vector<ResourceRecord>{}));
-            }
-            return true;
+    if (!wildcard_child) {
+        return false;
+    }
+    VertexDescriptor v = wildcard_child.get();
+    if ((*this)[v].rr_types[RRType::CNAME]) {
+        answers.clear();
+        RecordRange cname = RRSet(v, RRType::CNAME);
+        RRSetView matchingRRs = View({cname.begin(), cname.begin() + 1});
+        // Return type is Ans if only CNAME is requested
+        if (query.rrTypes[RRType::CNAME] && query.rrTypes.count() == 1) {
+            answers.push_back(std::make_tuple(ReturnTag::ANS, node_rr_types, matchingRRs, nullptr));
+        } else {
+            answers.push_back(std::make_tuple(ReturnTag::REWRITE, node_rr_types, matchingRRs, nullptr));
         }
+        return true; // If CNAME then other records would be ignored.
     }
-    return false;
+    // NS records at a wildcard node are forbidden.
+    std::bitset<RRType::N> queryTypesFound = (*this)[v].rr_types & query.rrTypes;
+    if (queryTypesFound.count())
+        answers.push_back(std::make_tuple(ReturnTag::ANS, queryTypesFound, View(v, queryTypesFound), nullptr));
+    if ((queryTypesFound ^ query.rrTypes).count()) {
+        answers.push_back(std::make_tuple(ReturnTag::ANS, queryTypesFound ^ query.rrTypes, RRSetView(), nullptr));
+    }
+    return true;
 }
 
 boost::optional<vector<zone::LookUpAnswer>> zone::Graph::QueryLookUpAtZone(const EC &query, bool &complete_match) const
@@ -324,7 +698,7 @@ boost::optional<vector<zone::LookUpAnswer>> zone::Graph::QueryLookUpAtZone(const
 
     /*int index = 0;
     for (Label l : z.origin) {
-        if (index >= query.name.size() || l.n != query.name[index].n) {
+        if (index >= query.name.size() || l != query.name[index]) {
             return {};
         }
         index++;
@@ -332,9 +706,23 @@ boost::optional<vector<zone::LookUpAnswer>> zone::Graph::QueryLookUpAtZone(const
     // Logger->debug(fmt::format("zone-graph (QueryLookUpAtZone) Query: {} look up at zone with origin: {}",
     // query.ToString(), LabelUtils::LabelsToString(origin_)));
     int index = 0;
-    VertexDescriptor closest_encloser = GetClosestEncloser(root_, query.name, index);
+    VertexDescriptor closest_encloser;
+    std::bitset<RRType::N> node_rr_types;
+    boost::optional<VertexDescriptor> wildcard_child;
+    if (!canonical_index_.empty()) {
+        const CanonicalIndex::Entry &entry = canonical_index_.ClosestEncloser(query.name);
+        closest_encloser = entry.vertex;
+        index = entry.depth;
+        node_rr_types = entry.types;
+        if (entry.wildcard != CanonicalIndex::kNone) {
+            wildcard_child = canonical_index_[entry.wildcard].vertex;
+        }
+    } else {
+        closest_encloser = GetClosestEncloser(root_, query.name, index);
+        node_rr_types = (*this)[closest_encloser].rr_types;
+        wildcard_child = WildcardChild(closest_encloser);
+    }
     vector<zone::LookUpAnswer> answers;
-    NodeLabel wildcard{"*"};
 
     if (query.name.size() != index || (query.excluded && query.name.size() == index)) {
         /*
@@ -342,50 +730,35 @@ boost::optional<vector<zone::LookUpAnswer>> zone::Graph::QueryLookUpAtZone(const
          has SOA. If SOA record is there then the order is (1) DNAME (2) Wildcard (3) NX
          else (1) NS- Referral (2) DNAME (3) wildcard (4) NX
         */
-        std::bitset<RRType::N> node_rr_types = GetNodeRRTypes((*this)[closest_encloser].rrs);
         complete_match = false;
         if (node_rr_types[RRType::SOA]) {
             if (node_rr_types[RRType::DNAME]) {
-                for (auto &record : (*this)[closest_encloser].rrs) {
-                    if (record.get_type() == RRType::DNAME) {
-                        // dr < dq ∧ DNAME ∈ T,  DNAME is a singleton type, there can be no other records of DNAME type
-                        // at this node.
-                        vector<ResourceRecord> dname;
-                        dname.push_back(record);
-                        answers.push_back(std::make_tuple(ReturnTag::REWRITE, node_rr_types, dname));
-                    }
+                for (auto &record : RRSet(closest_encloser, RRType::DNAME)) {
+                    // dr < dq ∧ DNAME ∈ T,  DNAME is a singleton type, there can be no other records of DNAME type at
+                    // this node.
+                    answers.push_back(
+                        std::make_tuple(ReturnTag::REWRITE, node_rr_types, View({&record, &record + 1}), nullptr));
                 }
             } else {
-                if (WildcardMatch(closest_encloser, node_rr_types, answers, query)) {
+                if (WildcardMatch(wildcard_child, node_rr_types, answers, query)) {
                     complete_match = true;
                 } else {
-                    answers.push_back(std::make_tuple(ReturnTag::NX, query.rrTypes, vector<ResourceRecord>{}));
+                    answers.push_back(std::make_tuple(ReturnTag::NX, query.rrTypes, RRSetView(), nullptr));
                 }
             }
         } else {
             if (node_rr_types[RRType::NS]) {
-                vector<ResourceRecord> ns_records;
-                for (auto &record : (*this)[closest_encloser].rrs) {
-                    if (record.get_type() == RRType::NS) {
-                        ns_records.push_back(record);
-                    }
-                }
-                if (ns_records.size()) {
-                    AddGlueRecords(ns_records);
-                    answers.push_back(std::make_tuple(ReturnTag::REF, node_rr_types, ns_records));
-                }
+                answers.push_back(std::make_tuple(
+                    ReturnTag::REF, node_rr_types, NSAndGlueRecords(closest_encloser), ReferralAt(closest_encloser)));
             } else if (node_rr_types[RRType::DNAME]) {
-                for (auto &record : (*this)[closest_encloser].rrs) {
-                    if (record.get_type() == RRType::DNAME) {
-                        vector<ResourceRecord> dname;
-                        dname.push_back(record);
-                        answers.push_back(std::make_tuple(ReturnTag::REWRITE, node_rr_types, dname));
-                    }
+                for (auto &record : RRSet(closest_encloser, RRType::DNAME)) {
+                    answers.push_back(
+                        std::make_tuple(ReturnTag::REWRITE, node_rr_types, View({&record, &record + 1}), nullptr));
                 }
-            } else if (WildcardMatch(closest_encloser, node_rr_types, answers, query)) {
+            } else if (WildcardMatch(wildcard_child, node_rr_types, answers, query)) {
                 complete_match = true;
             } else {
-                answers.push_back(std::make_tuple(ReturnTag::NX, query.rrTypes, vector<ResourceRecord>{}));
+                answers.push_back(std::make_tuple(ReturnTag::NX, query.rrTypes, RRSetView(), nullptr));
             }
         }
         return boost::make_optional(answers);
@@ -393,65 +766,132 @@ boost::optional<vector<zone::LookUpAnswer>> zone::Graph::QueryLookUpAtZone(const
     } else {
         // Exact Query Match d_r = d_q
         complete_match = true;
-        std::bitset<RRType::N> node_rr_types = GetNodeRRTypes((*this)[closest_encloser].rrs);
-        vector<ResourceRecord> matching_rrs; // All the RRs requested by query types except NS
-        vector<ResourceRecord> ns_records;
-        std::bitset<RRType::N> query_types_found;
-        for (auto &record : (*this)[closest_encloser].rrs) {
-            if (record.get_type() == RRType::NS) {
-                ns_records.push_back(record);
-            } else if (query.rrTypes[record.get_type()] == 1) {
-                query_types_found.set(record.get_type());
-                matching_rrs.push_back(record);
-            }
-            if (record.get_type() == RRType::CNAME) {
-                // CNAME Case
-                answers.clear();
-                matching_rrs.clear();
-                matching_rrs.push_back(record);
-                // Return type is Ans if only CNAME is requested
-                if (query.rrTypes[RRType::CNAME] && query.rrTypes.count() == 1) {
-                    answers.push_back(std::make_tuple(ReturnTag::ANS, node_rr_types, matching_rrs));
-                } else {
-                    answers.push_back(std::make_tuple(ReturnTag::REWRITE, node_rr_types, matching_rrs));
-                }
-                return boost::make_optional(answers); // If CNAME then other records would be ignored.
+        if (node_rr_types[RRType::CNAME]) {
+            // CNAME Case
+            RecordRange cname = RRSet(closest_encloser, RRType::CNAME);
+            RRSetView matching_rrs = View({cname.begin(), cname.begin() + 1});
+            // Return type is Ans if only CNAME is requested
+            if (query.rrTypes[RRType::CNAME] && query.rrTypes.count() == 1) {
+                answers.push_back(std::make_tuple(ReturnTag::ANS, node_rr_types, matching_rrs, nullptr));
+            } else {
+                answers.push_back(std::make_tuple(ReturnTag::REWRITE, node_rr_types, matching_rrs, nullptr));
             }
+            return boost::make_optional(answers); // If CNAME then other records would be ignored.
         }
-        // If there are NS records, then get their glue records too.
+        // The NS records and their glue records.
+        RRSetView ns_records;
         if (node_rr_types[RRType::NS]) {
-            AddGlueRecords(ns_records);
+            ns_records = NSAndGlueRecords(closest_encloser);
         }
         // Referral case
         if (node_rr_types[RRType::NS] && !node_rr_types[RRType::SOA]) {
-            answers.push_back(std::make_tuple(ReturnTag::REF, node_rr_types, ns_records));
+            answers.push_back(std::make_tuple(ReturnTag::REF, node_rr_types, ns_records, ReferralAt(closest_encloser)));
             return boost::make_optional(answers);
         }
+        // All the RRs requested by query types except NS
+        std::bitset<RRType::N> query_types_found = node_rr_types & query.rrTypes;
+        query_types_found.reset(RRType::NS);
+        RRSetView matching_rrs = View(closest_encloser, query_types_found);
         // Add the NS and glue records if the user requested them.
         if (query.rrTypes[RRType::NS] && ns_records.size()) {
-            matching_rrs.insert(matching_rrs.end(), ns_records.begin(), ns_records.end());
+            matching_rrs.Append(ns_records);
             query_types_found.set(RRType::NS);
         }
         // Exact Type match
         if (query_types_found.count())
-            answers.push_back(std::make_tuple(ReturnTag::ANS, query_types_found, matching_rrs));
+            answers.push_back(std::make_tuple(ReturnTag::ANS, query_types_found, matching_rrs, nullptr));
         if ((query_types_found ^ query.rrTypes).count()) {
             answers.push_back(
-                std::make_tuple(ReturnTag::ANS, query_types_found ^ query.rrTypes, vector<ResourceRecord>{}));
+                std::make_tuple(ReturnTag::ANS, query_types_found ^ query.rrTypes, RRSetView(), nullptr));
         }
         return boost::make_optional(answers);
     }
 }
 
+RRSetView zone::Graph::NSAndGlueRecords(VertexDescriptor v) const
+{
+    if ((*this)[v].referral != kNoReferral) {
+        return referrals_[(*this)[v].referral].records;
+    }
+    RecordRange rrset = RRSet(v, RRType::NS);
+    vector<ResourceRecord> ns_records(rrset.begin(), rrset.end());
+    AddGlueRecords(ns_records);
+    return RRSetView(std::move(ns_records));
+}
+
+zone::Graph::RecordRange zone::Graph::Records(VertexDescriptor v) const
+{
+    const Vertex &vertex = (*this)[v];
+    if (!records_packed_) {
+        return {vertex.rrs.data(), vertex.rrs.data() + vertex.rrs.size()};
+    }
+    // The spans of a node end where those of the next one start.
+    uint32_t last = v + 1 < num_vertices(*this) ? (*this)[v + 1].rrsets : static_cast<uint32_t>(rrsets_.size());
+    const ResourceRecord *arena = record_arena_->data();
+    if (last == vertex.rrsets) {
+        return {arena, arena};
+    }
+    return {arena + rrsets_[vertex.rrsets].begin, arena + rrsets_[last - 1].end};
+}
+
+zone::Graph::RecordRange zone::Graph::RRSet(VertexDescriptor v, RRType type) const
+{
+    const Vertex &vertex = (*this)[v];
+    if (!vertex.rr_types[type]) {
+        return {nullptr, nullptr};
+    }
+    if (!records_packed_) {
+        const ResourceRecord *first = vertex.rrs.data();
+        const ResourceRecord *last = first + vertex.rrs.size();
+        first = std::lower_bound(
+            first, last, type, [](const ResourceRecord &rr, RRType t) { return rr.get_type() < t; });
+        last = std::upper_bound(
+            first, last, type, [](RRType t, const ResourceRecord &rr) { return t < rr.get_type(); });
+        return {first, last};
+    }
+    // The spans of the node are in type order, so the one of the type is at the rank of the type in the bitmap.
+    size_t rank = std::bitset<RRType::N>(vertex.rr_types.to_ulong() & ((1ul << type) - 1)).count();
+    const RRSetSpan &span = rrsets_[vertex.rrsets + rank];
+    return {record_arena_->data() + span.begin, record_arena_->data() + span.end};
+}
+
+RRSetView zone::Graph::View(RecordRange records) const
+{
+    if (records.empty()) {
+        return {};
+    }
+    if (!records_packed_) {
+        return RRSetView(vector<ResourceRecord>(records.begin(), records.end()));
+    }
+    const ResourceRecord *arena = record_arena_->data();
+    return RRSetView(record_arena_, records.begin() - arena, records.end() - arena);
+}
+
+RRSetView zone::Graph::View(VertexDescriptor v, std::bitset<RRType::N> types) const
+{
+    RecordRange records = Records(v);
+    if (!records_packed_) {
+        vector<ResourceRecord> selected;
+        for (auto &rr : records) {
+            if (rr.get_type() != RRType::N && types[rr.get_type()]) {
+                selected.push_back(rr);
+            }
+        }
+        return RRSetView(std::move(selected));
+    }
+    const ResourceRecord *arena = record_arena_->data();
+    return RRSetView(record_arena_, records.begin() - arena, records.end() - arena, types);
+}
+
 bool zone::Graph::RequireGlueRecords(const vector<ResourceRecord> &ns_records) const
 {
     for (auto &record : ns_records) {
-        vector<NodeLabel> ns_name = LabelUtils::StringToLabels(record.get_rdata());
+        const DomainName &ns_name = record.get_target();
         if (ns_name.size() < origin_.size())
             continue;
         int i = 0;
         for (; i < origin_.size(); i++) {
-            if (origin_[i].get() != ns_name[i].get()) {
+            if (origin_[i] != ns_name[i]) {
                 break;
             }
         }
@@ -3,8 +3,11 @@
 
 #include <nlohmann/json.hpp>
 
+#include "canonical-index.h"
+#include "child-index.h"
 #include "equivalence-class.h"
 #include "node-label.h"
+#include "rrset-view.h"
 
 using namespace std;
 using json = nlohmann::json;
@@ -21,62 +24,174 @@ namespace zone
 
 enum class RRAddCode { SUCCESS, DUPLICATE, CNAME_MULTIPLE, DNAME_MULTIPLE, CNAME_OTHER };
 
+const uint32_t kNoReferral = std::numeric_limits<uint32_t>::max();
+
+// An NS record and the address records of its target found in the same zone.
+using NSGlue = tuple<ResourceRecord, vector<ResourceRecord>>;
+
+// What a lookup returns for the NS records of a node, computed once when the zone is indexed: every NS record followed
+// by its glue, the same records paired up, and whether any of the targets lies inside the zone and so needs glue. The
+// answers of the lookups share the records instead of copying them.
+struct Referral {
+    RRSetView records;
+    vector<NSGlue> pairs;
+    bool glue_required;
+};
+
 struct Vertex {
     NodeLabel name;
+    // The records of the node sorted by type, those of a type in the order they were added. Once the zone is indexed
+    // they live in the record arena of the graph instead; Graph::Records and Graph::RRSet read them in either case.
     vector<ResourceRecord> rrs;
+    // Kept up to date as records and children are added.
+    std::bitset<RRType::N> rr_types;
+    bool wildcard_child = false;
+    // Set when the zone is indexed: no zone cut lies on the path from the apex to the node (the node included), and
+    // the spans of the RRsets of the node, one per type, start at rrsets in the span array of the graph.
+    bool authoritative = true;
+    uint32_t rrsets = 0;
+    // Index of the referral of a node with NS records in the referrals of the graph, or kNoReferral.
+    uint32_t referral = kNoReferral;
+
+    bool zone_cut() const
+    {
+        return rr_types[RRType::NS] && !rr_types[RRType::SOA];
+    }
 
   private:
     friend class boost::serialization::access;
     template <typename Archive> void serialize(Archive &ar, const unsigned int version)
     {
         ar &name;
-        ar &rrs;
+        ar &rr_types;
+        ar &wildcard_child;
     }
 };
 
-using LookUpAnswer = tuple<ReturnTag, std::bitset<RRType::N>, vector<ResourceRecord>>;
+// The return tag, the types at the node and the records of a lookup. The records come grouped by type like those of
+// the node, with the NS records and their glue last, so records of different types are not in the order of the zone
+// file. A referral of an indexed zone also comes with its
+// precomputed NS records and glue, so that following it needs no second lookup.
+using LookUpAnswer = tuple<ReturnTag, std::bitset<RRType::N>, RRSetView, const Referral *>;
 
 class Graph : public boost::adjacency_list<boost::vecS, boost::vecS, boost::directedS, Vertex>
 {
   public:
     using VertexDescriptor = boost::graph_traits<Graph>::vertex_descriptor;
+    using RecordRange = boost::iterator_range<const ResourceRecord *>;
 
   private:
     using EdgeDescriptor = boost::graph_traits<Graph>::edge_descriptor;
     using LabelToVertex = boost::unordered_map<NodeLabel, VertexDescriptor>;
 
     int id_;
-    vector<NodeLabel> origin_;
+    DomainName origin_;
     zone::Graph::VertexDescriptor root_ = 0;
     std::unordered_map<zone::Graph::VertexDescriptor, LabelToVertex> vertex_to_child_map_;
+    // Built by BuildChildIndex once the zone is complete; while it exists it replaces vertex_to_child_map_.
+    ChildIndex child_index_;
+    // Optional index of the names in canonical order; the query lookups use it when it is built.
+    CanonicalIndex canonical_index_;
+    // Built by BuildRecordArena: the records of all the nodes in vertex order, and the span [begin, end) of every RRset
+    // in the arena. The arena is never modified once built; the answers of the lookups hold on to it.
+    struct RRSetSpan {
+        uint32_t begin;
+        uint32_t end;
+    };
+    bool records_packed_ = false;
+    RRSetView::Storage record_arena_;
+    vector<RRSetSpan> rrsets_;
+    // Built by BuildIndexes for every node with NS records.
+    vector<Referral> referrals_;
 
     Graph();
+    friend class boost::serialization::access;
+    template <typename Archive> void save(Archive &ar, const unsigned int version) const
+    {
+        ar &boost::serialization::base_object<
+            boost::adjacency_list<boost::vecS, boost::vecS, boost::directedS, Vertex>>(*this);
+        ar &id_;
+        ar &origin_;
+        ar &root_;
+        for (VertexDescriptor v : boost::make_iterator_range(vertices(*this))) {
+            vector<ResourceRecord> rrs(Records(v).begin(), Records(v).end());
+            ar &rrs;
+        }
+    }
+    template <typename Archive> void load(Archive &ar, const unsigned int version)
+    {
+        clear();
+        vertex_to_child_map_.clear();
+        child_index_.clear();
+        canonical_index_.clear();
+        record_arena_.reset();
+        rrsets_.clear();
+        referrals_.clear();
+        records_packed_ = false;
+        ar &boost::serialization::base_object<
+            boost::adjacency_list<boost::vecS, boost::vecS, boost::directedS, Vertex>>(*this);
+        ar &id_;
+        ar &origin_;
+        ar &root_;
+        for (VertexDescriptor v : boost::make_iterator_range(vertices(*this))) {
+            ar &(*this)[v].rrs;
+        }
+        BuildIndexes();
+    }
+    BOOST_SERIALIZATION_SPLIT_MEMBER()
 
     void AddGlueRecords(vector<ResourceRecord> &) const;
-    VertexDescriptor AddNodes(VertexDescriptor, const vector<NodeLabel> &, const int &);
+    VertexDescriptor AddNodes(VertexDescriptor, const DomainName &, const int &);
     void CheckGlueRecordsPresence(VertexDescriptor, const Nameserver &);
     void ConstructChildLabelsToVertexDescriptorMap(const zone::Graph::VertexDescriptor);
-    zone::Graph::VertexDescriptor GetAncestor(zone::Graph::VertexDescriptor, const vector<NodeLabel> &, int &) const;
+    void ConstructChildLabelsToVertexDescriptorMaps();
+    zone::Graph::VertexDescriptor GetAncestor(zone::Graph::VertexDescriptor, const DomainName &, int &) const;
     zone::Graph::VertexDescriptor GetAncestor(
         zone::Graph::VertexDescriptor,
-        const vector<NodeLabel> &,
+        const DomainName &,
         vector<VertexDescriptor> &,
         int &) const;
-    zone::Graph::VertexDescriptor GetClosestEncloser(zone::Graph::VertexDescriptor, const vector<NodeLabel> &, int &)
+    zone::Graph::VertexDescriptor GetClosestEncloser(zone::Graph::VertexDescriptor, const DomainName &, int &)
         const;
-    std::bitset<RRType::N> GetNodeRRTypes(const vector<ResourceRecord> &rrs) const;
-    bool WildcardMatch(VertexDescriptor, std::bitset<RRType::N> &, vector<zone::LookUpAnswer> &, const EC &) const;
+    void BuildReferrals();
+    void DropIndexes();
+    void InsertRecord(VertexDescriptor, const ResourceRecord &);
+    RRSetView NSAndGlueRecords(VertexDescriptor) const;
+    const Referral *ReferralAt(VertexDescriptor) const;
+    // The records as an answer, shared with the arena once the zone is indexed and copied before; the second one
+    // selects the records of the types from those of the node.
+    RRSetView View(RecordRange) const;
+    RRSetView View(VertexDescriptor, std::bitset<RRType::N>) const;
+    boost::optional<VertexDescriptor> WildcardChild(VertexDescriptor) const;
+    bool WildcardMatch(
+        boost::optional<VertexDescriptor>,
+        std::bitset<RRType::N> &,
+        vector<zone::LookUpAnswer> &,
+        const EC &) const;
 
   public:
     Graph(int);
     const int &get_id();
-    const vector<NodeLabel> &get_origin() const;
+    const DomainName &get_origin() const;
+    const CanonicalIndex &get_canonical_index() const;
 
     tuple<RRAddCode, boost::optional<zone::Graph::VertexDescriptor>> AddResourceRecord(const ResourceRecord &);
+    vector<tuple<RRAddCode, boost::optional<zone::Graph::VertexDescriptor>>> AddResourceRecords(
+        const vector<ResourceRecord> &);
+    // Index the zone for the lookups; BuildIndexes builds all of them. Adding a record later drops them again.
+    void BuildCanonicalIndex();
+    void BuildChildIndex();
+    void BuildIndexes();
+    void BuildRecordArena();
     void CheckGlueRecordsPresence(const Nameserver &);
     bool CheckZoneMembership(const ResourceRecord &, const string &);
+    // The referral of the node with the name, if the zone is indexed and the node has NS records.
+    const Referral *FindReferral(const DomainName &) const;
     vector<ResourceRecord> LookUpGlueRecords(const vector<ResourceRecord> &) const;
     boost::optional<vector<zone::LookUpAnswer>> QueryLookUpAtZone(const EC &, bool &) const;
+    // All the records of a node, sorted by type, and those of one type.
+    RecordRange Records(VertexDescriptor) const;
+    RecordRange RRSet(VertexDescriptor, RRType) const;
     bool RequireGlueRecords(const vector<ResourceRecord> &NSRecords) const;
 };
 } // namespace zone
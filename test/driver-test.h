@@ -1,6 +1,7 @@
 #ifndef DRIVER_TEST_H_
 #define DRIVER_TEST_H_
 #include "../src/driver.h"
+#include "../src/zone-file-buffer.h"
 #include <boost/filesystem/operations.hpp>
 #include <boost/filesystem/path.hpp>
 
@@ -23,6 +24,39 @@ class DriverTest
         return d.ParseZoneFileAndExtendGraphs(file, nameserver, "", false);
     }
 
+    MiniContext ParseZoneFile(string_view contents, zone::Graph &g, string file, int threads, size_t chunk_size)
+    {
+        if (threads > 1) {
+            return Driver::ParseZoneFileInChunks(contents, g, file, "", true, threads, chunk_size);
+        }
+        return Driver::ParseZoneFile(contents, g, file, "", true);
+    }
+
+    MiniContext ParseZoneFile(string_view contents, zone::Graph &g, string file, bool bulk)
+    {
+        return Driver::ParseZoneFile(contents, g, file, "", true, bulk ? 0 : std::numeric_limits<size_t>::max());
+    }
+
+    MiniContext ParseCompressedZoneFile(
+        string_view contents,
+        ZoneFileDecompressor::Format format,
+        zone::Graph &g,
+        string file,
+        size_t chunk_size)
+    {
+        return Driver::ParseCompressedZoneFile(contents, format, g, file, "", true, chunk_size);
+    }
+
+    MiniContext ParseWireZoneFile(string_view contents, zone::Graph &g, string file)
+    {
+        return Driver::ParseWireZoneFile(contents, g, file, true);
+    }
+
+    MiniContext ParseOrLoadZoneFile(Driver &d, string_view contents, zone::Graph &g, string file)
+    {
+        return d.ParseOrLoadZoneFile(contents, g, file, "", true, 1, kZoneFileChunkSize);
+    }
+
     int GetNumberofViolations(Driver &d)
     {
         return static_cast<int>(d.property_violations_.size());
@@ -33,6 +67,11 @@ class DriverTest
         return d.context_.type_to_rr_count;
     }
 
+    const Context &GetContext(Driver &d)
+    {
+        return d.context_;
+    }
+
     const zone::Graph &GetLatestZone(Driver &d)
     {
         return d.context_.zoneId_to_zone.at(d.context_.zoneId_counter_);
@@ -43,6 +82,11 @@ class DriverTest
         return interpretation::Graph(ec, d.context_);
     }
 
+    void RebuildInterpretationGraph(Driver &d, interpretation::Graph &graph, const EC ec)
+    {
+        graph.Build(ec, d.context_);
+    }
+
     void GenerateLabelGraphDotFile(Driver &d, string filepath)
     {
         d.label_graph_.GenerateDotFile(filepath);
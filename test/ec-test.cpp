@@ -88,4 +88,35 @@ BOOST_AUTO_TEST_CASE(ec_inequality3)
     BOOST_CHECK(!(ec1 == ec2));
 }
 
+BOOST_AUTO_TEST_CASE(ec_table)
+{
+    EC ec1;
+    ec1.name = LabelUtils::StringToLabels("a.b.c.");
+    ec1.rrTypes.set(RRType::A);
+
+    EC ec2 = ec1;
+    ec2.rrTypes.set(RRType::AAAA);
+
+    EC ec3 = ec1;
+    ec3.nonExistent = true;
+
+    ECTable table;
+    uint32_t id1 = table.Intern(ec1);
+    uint32_t id2 = table.Intern(ec2);
+    BOOST_TEST(id1 != id2);
+    BOOST_TEST(id1 == table.Intern(ec1));
+    BOOST_TEST(hash_value(ec1) == hash_value(ec3));
+
+    // Equal to ec1 for operator== but kept apart, in the class of ec1.
+    uint32_t id3 = table.Intern(ec3);
+    BOOST_TEST(id1 != id3);
+    BOOST_TEST(table[id3].nonExistent);
+    BOOST_TEST(table.get_class(id3) == id1);
+    BOOST_TEST(table.get_class(id2) == id2);
+    BOOST_TEST(3 == table.size());
+
+    table.clear();
+    BOOST_TEST(0 == table.Intern(ec2));
+}
+
 BOOST_AUTO_TEST_SUITE_END()
\ No newline at end of file
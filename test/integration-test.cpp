@@ -1,3 +1,4 @@
+#include "../src/lint-sink.h"
 #include "driver-test.h"
 #include <boost/filesystem.hpp>
 #include <boost/test/unit_test.hpp>
@@ -38,16 +39,9 @@ BOOST_AUTO_TEST_CASE(integration_test)
             json j;
             i >> j;
 
-            fstream fs;
-            fs.open("lint.json", ios::out);
-            fs << "[\n";
-            fs.close();
-
+            Lint->Open("lint.json");
             driver.SetContext(metadata, zone_path.string(), true);
-
-            fs.open("lint.json", ios::app);
-            fs << "\n]";
-            fs.close();
+            Lint->Close();
 
             for (auto &user_job : j) {
                 driver.SetJob(user_job);
@@ -106,5 +100,36 @@ BOOST_AUTO_TEST_CASE(label_graph_dot)
     boost::filesystem::remove(actual_path);
 }
 
+BOOST_AUTO_TEST_CASE(label_graph_dot_parallel_parsing)
+{
+    Driver serial_driver;
+    Driver parallel_driver;
+    DriverTest dt;
+    boost::filesystem::path directory("TestFiles");
+    std::ifstream metadataFile((directory / "cc.il.us" / "zone_files" / "metadata.json").string());
+    json metadata;
+    metadataFile >> metadata;
+
+    auto zone_directory = (directory / "cc.il.us" / "zone_files").string();
+    long serial_rrs = serial_driver.SetContext(metadata, zone_directory, false);
+    long parallel_rrs = parallel_driver.SetContext(metadata, zone_directory, false, 4);
+    BOOST_CHECK_EQUAL(serial_rrs, parallel_rrs);
+    BOOST_CHECK(dt.GetTypeToCountMap(serial_driver) == dt.GetTypeToCountMap(parallel_driver));
+
+    auto expected_path = directory / "cc.il.us" / "label_graph_expected.dot";
+    auto actual_path = directory / "cc.il.us" / "label_graph_parallel.dot";
+
+    dt.GenerateLabelGraphDotFile(parallel_driver, actual_path.string());
+
+    std::ifstream actual(actual_path.string());
+    std::string s1((std::istreambuf_iterator<char>(actual)), std::istreambuf_iterator<char>());
+
+    std::ifstream expected(expected_path.string());
+    std::string s2((std::istreambuf_iterator<char>(expected)), std::istreambuf_iterator<char>());
+
+    BOOST_CHECK_EQUAL(s1, s2);
+    actual.close();
+    boost::filesystem::remove(actual_path);
+}
 
 BOOST_AUTO_TEST_SUITE_END()
\ No newline at end of file
@@ -133,6 +133,52 @@ BOOST_AUTO_TEST_CASE(label_graph_duplicate_dnames)
     BOOST_CHECK_EQUAL(6, num_edges(labelGraph));
 }
 
+BOOST_AUTO_TEST_CASE(label_graph_freeze_and_thaw)
+{
+    label::Graph labelGraph;
+    zone::Graph zoneGraph(0);
+
+    for (string domain : {"c.foo.com", "a.foo.com", "b.foo.com", "*.foo.com"}) {
+        ResourceRecord r(domain, "A", 1, 10, "1.2.3.4");
+        auto [code, id] = zoneGraph.AddResourceRecord(r);
+        labelGraph.AddResourceRecord(r, 0, id.get());
+    }
+    ResourceRecord r1("bar.com", "DNAME", 1, 10, "foo.com");
+    auto [code1, id1] = zoneGraph.AddResourceRecord(r1);
+    labelGraph.AddResourceRecord(r1, 0, id1.get());
+
+    labelGraph.Freeze();
+    labelGraph.Freeze();
+    BOOST_CHECK_EQUAL(8, num_vertices(labelGraph));
+    BOOST_CHECK_EQUAL(8, num_edges(labelGraph));
+    for (string label : {"a", "b", "c", "*"}) {
+        auto enclosers = labelGraph.ClosestEnclosers(label + ".foo.com");
+        BOOST_CHECK_EQUAL(1, enclosers.size());
+        BOOST_CHECK_EQUAL(label, labelGraph[enclosers[0].first].name.get());
+        BOOST_CHECK_EQUAL(3, enclosers[0].second);
+    }
+    for (auto [query, label, depth] : vector<tuple<string, string, int>>{
+             {"x.y.a.foo.com", "a", 3}, {"foo.com", "foo", 2}, {"x.com", "com", 1}, {"org", ".", 0}}) {
+        auto enclosers = labelGraph.ClosestEnclosers(query);
+        BOOST_CHECK_EQUAL(1, enclosers.size());
+        BOOST_CHECK_EQUAL(label, labelGraph[enclosers[0].first].name.get());
+        BOOST_CHECK_EQUAL(depth, enclosers[0].second);
+    }
+    auto enclosers = labelGraph.ClosestEnclosers("d.bar.com");
+    BOOST_CHECK_EQUAL(2, enclosers.size());
+    BOOST_CHECK_EQUAL("bar", labelGraph[enclosers[0].first].name.get());
+    BOOST_CHECK_EQUAL("foo", labelGraph[enclosers[1].first].name.get());
+
+    // Adding a record to the frozen graph thaws it.
+    ResourceRecord r2("d.foo.com", "A", 1, 10, "1.2.3.4");
+    auto [code2, id2] = zoneGraph.AddResourceRecord(r2);
+    labelGraph.AddResourceRecord(r2, 0, id2.get());
+    BOOST_CHECK_EQUAL(9, num_vertices(labelGraph));
+    enclosers = labelGraph.ClosestEnclosers("d.bar.com");
+    BOOST_CHECK_EQUAL(1, enclosers.size());
+    BOOST_CHECK_EQUAL("d", labelGraph[enclosers[0].first].name.get());
+}
+
 BOOST_AUTO_TEST_CASE(label_graph_examples)
 {
     CheckClosestEncloser("com", "a.com", "b.a.com", "c.b.a.com", "b");
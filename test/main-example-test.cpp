@@ -42,6 +42,8 @@ BOOST_AUTO_TEST_CASE(example_test_jobs)
     test_ec.name = LabelUtils::StringToLabels("ds3.trial.cc.il.us.");
     test_ec.rrTypes.set(RRType::A);
     interpretation::Graph ig = dt.CreateAnInterpretationGraph(driver, test_ec);
+    BOOST_CHECK_EQUAL(17, num_vertices(ig));
+    BOOST_CHECK_EQUAL(12, num_edges(ig));
     ig.GenerateDotFile("ig.dot");
 
     auto expected_path = directory / "cc.il.us" / "ig_expected.dot";
@@ -54,6 +56,19 @@ BOOST_AUTO_TEST_CASE(example_test_jobs)
     BOOST_CHECK_EQUAL(s1, s2);
     actual.close();
     boost::filesystem::remove("ig.dot");
+
+    // A graph reused for another EC and built again is the same graph.
+    EC other_ec;
+    other_ec.name = LabelUtils::StringToLabels("cc.il.us.");
+    other_ec.rrTypes.set(RRType::NS);
+    dt.RebuildInterpretationGraph(driver, ig, other_ec);
+    dt.RebuildInterpretationGraph(driver, ig, test_ec);
+    ig.GenerateDotFile("ig.dot");
+    std::ifstream rebuilt("ig.dot");
+    std::string s3((std::istreambuf_iterator<char>(rebuilt)), std::istreambuf_iterator<char>());
+    BOOST_CHECK_EQUAL(s3, s2);
+    rebuilt.close();
+    boost::filesystem::remove("ig.dot");
 }
 
 BOOST_AUTO_TEST_CASE(example_test_default_jobs)
@@ -84,4 +99,79 @@ BOOST_AUTO_TEST_CASE(example_test_default_jobs)
     BOOST_TEST(58 == dt.GetNumberofViolations(driver));
 }
 
+BOOST_AUTO_TEST_CASE(example_test_snapshot)
+{
+    DriverTest dt;
+    boost::filesystem::path directory("TestFiles");
+    std::ifstream metadataFile((directory / "cc.il.us" / "zone_files" / "metadata.json").string());
+    json metadata;
+    metadataFile >> metadata;
+
+    auto snapshot_path = directory / "cc.il.us" / "snapshot.bin";
+    vector<string> nameservers;
+    {
+        Driver driver;
+        driver.SetContext(metadata, (directory / "cc.il.us" / "zone_files").string(), false);
+        driver.SaveSnapshot(snapshot_path.string());
+        nameservers = dt.GetContext(driver).nameservers;
+    }
+
+    Driver driver;
+    driver.LoadSnapshot(snapshot_path.string());
+    boost::filesystem::remove(snapshot_path);
+
+    // The name server ids are not saved; indexing the loaded context has to number them the same way.
+    const Context &context = dt.GetContext(driver);
+    BOOST_TEST(nameservers == context.nameservers, boost::test_tools::per_element());
+    BOOST_TEST(context.nameservers.front().empty());
+    for (NameserverId id : context.top_nameserver_ids) {
+        BOOST_TEST(context.top_nameserver_set[id]);
+    }
+    NameserverId top = context.top_nameserver_ids.front();
+    boost::optional<int> zone = context.GetRelevantZone(top, LabelUtils::StringToLabels("ds3.trial.cc.il.us."));
+    BOOST_TEST(zone.has_value());
+    BOOST_TEST(LabelUtils::LabelsToString(context.zones[zone.get()]->get_origin()) == "cc.il.us.");
+    BOOST_TEST(!context.GetRelevantZone(top, LabelUtils::StringToLabels("il.us.")).has_value());
+    BOOST_TEST(!context.GetRelevantZone(kStartNameserver, LabelUtils::StringToLabels("cc.il.us.")).has_value());
+
+    // The targets of the NS records were interned when the context was indexed, and no other name server was.
+    const string &indexed = context.nameservers.back();
+    boost::optional<NameserverId> id = context.GetNameserverId(ResourceRecord("cc.il.us.", "NS", 1, 300, indexed));
+    BOOST_TEST(id.has_value());
+    BOOST_TEST(context.nameservers[id.get()] == indexed);
+    BOOST_TEST(!context.GetNameserverId(ResourceRecord("cc.il.us.", "NS", 1, 300, "ns.not-indexed.test.")));
+
+    BOOST_TEST(70 == dt.GetNumberofLabelGraphVertices(driver));
+    BOOST_TEST(70 == dt.GetNumberofLabelGraphEdges(driver));
+
+    boost::unordered_map<string, long> types_to_count = dt.GetTypeToCountMap(driver);
+
+    BOOST_TEST(1 == types_to_count["Wildcard"]);
+    BOOST_TEST(1 == types_to_count["DNAME"]);
+    BOOST_TEST(5 == types_to_count["CNAME"]);
+
+    string x = ".";
+    driver.SetJob(x);
+    driver.GenerateECsAndCheckProperties();
+    BOOST_TEST(167 == driver.GetECCountForCurrentJob());
+    BOOST_TEST(58 == dt.GetNumberofViolations(driver));
+
+    EC test_ec;
+    test_ec.name = LabelUtils::StringToLabels("ds3.trial.cc.il.us.");
+    test_ec.rrTypes.set(RRType::A);
+    interpretation::Graph ig = dt.CreateAnInterpretationGraph(driver, test_ec);
+    ig.GenerateDotFile("ig_snapshot.dot");
+
+    auto expected_path = directory / "cc.il.us" / "ig_expected.dot";
+    std::ifstream actual("ig_snapshot.dot");
+    std::string s1((std::istreambuf_iterator<char>(actual)), std::istreambuf_iterator<char>());
+
+    std::ifstream expected(expected_path.string());
+    std::string s2((std::istreambuf_iterator<char>(expected)), std::istreambuf_iterator<char>());
+
+    BOOST_CHECK_EQUAL(s1, s2);
+    actual.close();
+    boost::filesystem::remove("ig_snapshot.dot");
+}
+
 BOOST_AUTO_TEST_SUITE_END()
\ No newline at end of file
@@ -0,0 +1,31 @@
+#ifndef SPIRIT_TOKENIZER_H_
+#define SPIRIT_TOKENIZER_H_
+#include "../src/zone-file-tokenizer.h"
+#include <boost/config/warning_disable.hpp>
+#include <boost/spirit/include/lex_lexertl.hpp>
+#include <functional>
+
+namespace lex = boost::spirit::lex;
+
+// The Boost.Spirit lexertl rules the zone file parser used before ZoneFileTokenizer, kept as its reference.
+template <typename Lexer> struct zone_file_tokens : lex::lexer<Lexer> {
+    zone_file_tokens()
+    {
+        this->self.add("\\\"[^\\\"]*\\\"", ID_TEXT_WORD)(";[^\n]+", ID_COMMENT)(
+            "((\\\\\\()*(\\\\\\))*[^ ;\t\r\n\\(\\)\\\"]+)+",
+            ID_WORD)("\\(", ID_LPAREN)("\\)", ID_RPAREN)("\n", ID_EOL)("[ \t]+", ID_WHITESPACE)(".", ID_OTHER);
+    }
+};
+
+inline bool TokenizeWithSpirit(std::string_view input, const std::function<bool(const ZoneFileToken &)> &callback)
+{
+    char const *first = input.data();
+    char const *last = first + input.size();
+    zone_file_tokens<lex::lexertl::lexer<>> zone_functor;
+    return lex::tokenize(first, last, zone_functor, [&](auto const &t) {
+        return callback(ZoneFileToken{
+            static_cast<TokenIds>(t.id()), std::string_view(t.value().begin(), t.value().size())});
+    });
+}
+
+#endif
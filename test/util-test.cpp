@@ -1,6 +1,10 @@
+#include "../src/arena.h"
+#include "../src/lint-sink.h"
 #include "../src/resource-record.h"
 #include "../src/utils.h"
+#include <boost/filesystem/operations.hpp>
 #include <boost/test/unit_test.hpp>
+#include <thread>
 
 BOOST_AUTO_TEST_SUITE(UtilTestSuite)
 
@@ -36,7 +40,7 @@ BOOST_AUTO_TEST_CASE(label_conversions)
 {
     NodeLabel l1("uk");
     NodeLabel l2("co");
-    vector<NodeLabel> domain_name{l1, l2};
+    DomainName domain_name{l1, l2};
 
     auto dn = LabelUtils::LabelsToString(domain_name);
     BOOST_CHECK_EQUAL("co.uk.", dn);
@@ -71,4 +75,169 @@ BOOST_AUTO_TEST_CASE(flyweight_test)
     BOOST_ASSERT(nl == nl1);
 }
 
+BOOST_AUTO_TEST_CASE(domain_name)
+{
+    // The wire length follows the labels, inline or spilled over to the heap.
+    DomainName name;
+    BOOST_CHECK_EQUAL(1, name.wire_length());
+    string text = "";
+    for (int i = 0; i < 12; i++) {
+        text = "l" + to_string(i) + "." + text;
+        name = LabelUtils::StringToLabels(text);
+        BOOST_CHECK_EQUAL(text.size() + 1, name.wire_length());
+        BOOST_CHECK_EQUAL(text, LabelUtils::LabelsToString(name));
+    }
+    DomainName parent = name;
+    while (parent.size() > 5) {
+        parent.pop_back();
+    }
+    BOOST_CHECK(name.IsSubDomainOf(parent));
+    BOOST_CHECK(!parent.IsSubDomainOf(name));
+    BOOST_CHECK(parent == DomainName(name.begin(), name.begin() + 5));
+    BOOST_CHECK(parent != name);
+    parent.pop_back();
+    parent.push_back(NodeLabel("other"));
+    BOOST_CHECK(!name.IsSubDomainOf(parent));
+    BOOST_CHECK(name.IsSubDomainOf(DomainName()));
+}
+
+BOOST_AUTO_TEST_CASE(parsed_rdata)
+{
+    ResourceRecord ns("foo.com", "NS", 1, 10, "ns1.foo.com.");
+    BOOST_CHECK(ns.get_target() == LabelUtils::StringToLabels("ns1.foo.com"));
+    BOOST_CHECK(ns.get_address().empty());
+    ResourceRecord mx("foo.com", "MX", 1, 10, "10 mail.foo.com.");
+    BOOST_CHECK(mx.get_target() == LabelUtils::StringToLabels("mail.foo.com"));
+    BOOST_CHECK(ResourceRecord("foo.com", "TXT", 1, 10, "ns1.foo.com.").get_target().empty());
+
+    ResourceRecord a("foo.com", "A", 1, 10, "192.0.2.1");
+    BOOST_CHECK(a.get_address() == string("\xc0\x00\x02\x01", 4));
+    BOOST_CHECK(ResourceRecord("foo.com", "A", 1, 10, "192.0.2.256").get_address().empty());
+    BOOST_CHECK(ResourceRecord("foo.com", "A", 1, 10, "192.0.2").get_address().empty());
+
+    // The same address written in different ways compares equal, other rdata only when it is the same text.
+    ResourceRecord aaaa("foo.com", "AAAA", 1, 10, "2001:db8::1");
+    BOOST_CHECK_EQUAL(16, aaaa.get_address().size());
+    BOOST_CHECK(aaaa == ResourceRecord("foo.com", "AAAA", 1, 20, "2001:DB8:0:0:0:0:0:1"));
+    BOOST_CHECK(aaaa == ResourceRecord("foo.com", "AAAA", 1, 10, "2001:db8:0::0.0.0.1"));
+    BOOST_CHECK(!(aaaa == ResourceRecord("foo.com", "AAAA", 1, 10, "2001:db8::2")));
+    BOOST_CHECK(ResourceRecord("foo.com", "AAAA", 1, 10, "::").get_address() == string(16, '\0'));
+    for (string invalid : {"2001:db8:::1", "1::2::3", "1:2:3:4:5:6:7:8:9", "12345::", "1:2:3:4:5:6:7:"}) {
+        BOOST_CHECK(ResourceRecord("foo.com", "AAAA", 1, 10, invalid).get_address().empty());
+    }
+    BOOST_CHECK(ns == ResourceRecord("foo.com", "NS", 1, 20, "ns1.foo.com."));
+    BOOST_CHECK(!(ns == ResourceRecord("foo.com", "NS", 1, 10, "ns2.foo.com.")));
+    BOOST_CHECK_EQUAL("ns1.foo.com.", ns.get_rdata());
+}
+
+BOOST_AUTO_TEST_CASE(label_intern_table)
+{
+    // Labels interned concurrently get one id each, with their length and lower case form cached.
+    vector<vector<NodeLabel>> labels(4);
+    vector<std::thread> threads;
+    for (int t = 0; t < 4; t++) {
+        threads.push_back(std::thread([t, &labels]() {
+            for (int i = 0; i < 2000; i++) {
+                labels[t].push_back(NodeLabel("Label" + to_string((i * (t + 1)) % 2000)));
+            }
+        }));
+    }
+    for (auto &t : threads) {
+        t.join();
+    }
+    for (int t = 0; t < 4; t++) {
+        for (int i = 0; i < 2000; i++) {
+            BOOST_CHECK(labels[t][i] == labels[0][(i * (t + 1)) % 2000]);
+        }
+    }
+    for (int i = 0; i < 2000; i++) {
+        NodeLabel nl("Label" + to_string(i));
+        BOOST_CHECK(labels[0][i] == nl);
+        BOOST_CHECK_EQUAL("Label" + to_string(i), nl.get());
+        BOOST_CHECK_EQUAL(nl.length(), nl.get().length());
+        BOOST_CHECK(nl.lowercase() == NodeLabel("label" + to_string(i)));
+        BOOST_CHECK(nl.lowercase().lowercase() == nl.lowercase());
+    }
+    BOOST_CHECK(NodeLabel() == NodeLabel(""));
+    BOOST_CHECK(NodeLabel("a") != NodeLabel("A"));
+}
+
+BOOST_AUTO_TEST_CASE(arena)
+{
+    Arena arena;
+    vector<int, ArenaAllocator<int>> heap;
+    {
+        Arena::Scope scope(arena);
+        vector<int, ArenaAllocator<int>> numbers;
+        for (int i = 0; i < 100000; i++) {
+            numbers.push_back(i);
+        }
+        BOOST_CHECK(numbers.get_allocator().get_arena() == &arena);
+        BOOST_CHECK_EQUAL(99999, numbers.back());
+        // A container constructed outside of the scope stays on the heap, also when it is assigned one in the arena.
+        heap = numbers;
+        BOOST_CHECK(heap.get_allocator().get_arena() == nullptr);
+    }
+    BOOST_CHECK(Arena::Current() == nullptr);
+    // After a reset the arena hands out the same memory again, now from a single block.
+    arena.Reset();
+    void *first = arena.Allocate(sizeof(int), alignof(int));
+    arena.Reset();
+    BOOST_CHECK(first == arena.Allocate(1 << 16, alignof(int)));
+    BOOST_CHECK_EQUAL(99999, heap.back());
+}
+
+BOOST_AUTO_TEST_CASE(lint_sink)
+{
+    // Issues written from several threads end up whole, once each, in either format.
+    for (auto format : {LintSink::Format::JSON, LintSink::Format::NDJSON}) {
+        Lint->Open("lint_test.json", format);
+        vector<std::thread> threads;
+        for (int t = 0; t < 4; t++) {
+            threads.push_back(std::thread([t]() {
+                for (size_t line = 0; line < 5000; line++) {
+                    LintUtils::WriteRRIssueToFile(true, "thread" + to_string(t), line, "rr", "Duplicate Record", "");
+                }
+            }));
+        }
+        for (auto &t : threads) {
+            t.join();
+        }
+        Lint->Close();
+        // Nothing is written once the file is closed.
+        LintUtils::WriteRRIssueToFile(true, "closed", 0, "rr", "Duplicate Record", "");
+
+        std::ifstream in("lint_test.json");
+        vector<json> issues;
+        if (format == LintSink::Format::JSON) {
+            json all;
+            in >> all;
+            issues.assign(all.begin(), all.end());
+        } else {
+            string line;
+            while (getline(in, line)) {
+                issues.push_back(json::parse(line));
+            }
+        }
+        BOOST_REQUIRE_EQUAL(20000, issues.size());
+        std::map<string, size_t> next_line;
+        for (auto &issue : issues) {
+            // Each thread's issues keep their order.
+            BOOST_CHECK_EQUAL(next_line[issue["File Name"]]++, issue["Line Number"].get<size_t>());
+        }
+        in.close();
+        boost::filesystem::remove("lint_test.json");
+    }
+
+    // An empty JSON lint file is still an array.
+    Lint->Open("lint_test.json");
+    Lint->Close();
+    std::ifstream in("lint_test.json");
+    json all;
+    in >> all;
+    BOOST_CHECK(all.is_array() && all.empty());
+    in.close();
+    boost::filesystem::remove("lint_test.json");
+}
+
 BOOST_AUTO_TEST_SUITE_END()
\ No newline at end of file
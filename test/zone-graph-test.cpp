@@ -1,4 +1,11 @@
 #include "driver-test.h"
+#include "spirit-tokenizer.h"
+#include <boost/iostreams/copy.hpp>
+#include <boost/iostreams/device/array.hpp>
+#include <boost/iostreams/device/back_inserter.hpp>
+#include <boost/iostreams/filter/gzip.hpp>
+#include <boost/iostreams/filter/zstd.hpp>
+#include <boost/range/algorithm/equal.hpp>
 #include <boost/test/unit_test.hpp>
 
 BOOST_AUTO_TEST_SUITE(ZoneGraphTestSuite)
@@ -16,6 +23,454 @@ BOOST_AUTO_TEST_CASE(zone_graph_building)
     BOOST_TEST(5 == num_edges(g));
 }
 
+vector<tuple<int, string>> TokenizeZoneFile(std::string_view input, bool spirit)
+{
+    vector<tuple<int, string>> tokens;
+    auto collect = [&](const ZoneFileToken &t) {
+        tokens.push_back({t.id(), string(t.value())});
+        return true;
+    };
+    if (spirit) {
+        TokenizeWithSpirit(input, collect);
+    } else {
+        ZoneFileTokenizer::Tokenize(input, collect);
+    }
+    return tokens;
+}
+
+// Calls the callback with the contents and the name of every zone file in the test data.
+void ForEachTestFile(const std::function<void(std::string_view, const string &)> &callback)
+{
+    boost::filesystem::recursive_directory_iterator it("TestFiles"), end;
+    for (; it != end; ++it) {
+        if (boost::filesystem::is_regular_file(it->path()) && it->path().extension() == ".txt") {
+            ZoneFileBuffer buffer(it->path().string());
+            callback(buffer.get_contents(), it->path().string());
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE(zone_file_tokenizer)
+{
+    // The tokenizer has to agree with the Spirit lexer on every zone file in the test data.
+    ForEachTestFile([](std::string_view contents, const string &) {
+        BOOST_CHECK(TokenizeZoneFile(contents, true) == TokenizeZoneFile(contents, false));
+    });
+
+    string tricky = "a\\(b\\)c IN TXT \"x;y\" ( 1\t2 ) ;comment\n;\n\"open\r\n";
+    BOOST_CHECK(TokenizeZoneFile(tricky, true) == TokenizeZoneFile(tricky, false));
+
+    // Escaped delimiters stay inside the word or the quoted string.
+    auto tokens = TokenizeZoneFile("a\\;b \"x\\\"y\"\n", false);
+    BOOST_REQUIRE_EQUAL(4, tokens.size());
+    BOOST_CHECK(tokens[0] == make_tuple(static_cast<int>(ID_WORD), string("a\\;b")));
+    BOOST_CHECK(tokens[2] == make_tuple(static_cast<int>(ID_TEXT_WORD), string("\"x\\\"y\"")));
+}
+
+void CheckSameParse(const MiniContext &a, const zone::Graph &ga, const MiniContext &b, const zone::Graph &gb)
+{
+    BOOST_CHECK(a.label_graph_records == b.label_graph_records);
+    BOOST_CHECK(a.lint_issues == b.lint_issues);
+    BOOST_CHECK(a.type_to_count == b.type_to_count);
+    BOOST_CHECK_EQUAL(a.rrs_parsed, b.rrs_parsed);
+    BOOST_CHECK_EQUAL(a.lines, b.lines);
+    BOOST_CHECK_EQUAL(a.found_SOA, b.found_SOA);
+    BOOST_CHECK_EQUAL(a.parsed_completely, b.parsed_completely);
+    BOOST_CHECK_EQUAL(num_vertices(ga), num_vertices(gb));
+    BOOST_CHECK_EQUAL(num_edges(ga), num_edges(gb));
+}
+
+// Parses the contents of the zone file with the given name into a fresh zone graph.
+using ParseFunction = std::function<MiniContext(std::string_view, zone::Graph &, const string &)>;
+
+// Parses the contents one record at a time and with parse, and checks that both give the same parse and build the
+// same zone graph, vertex by vertex.
+void ExpectSameGraph(std::string_view contents, const string &file, const ParseFunction &parse)
+{
+    DriverTest dt;
+    zone::Graph serial_graph(1), graph(1);
+    MiniContext serial = dt.ParseZoneFile(contents, serial_graph, file, false);
+    MiniContext parsed = parse(contents, graph, file);
+    CheckSameParse(serial, serial_graph, parsed, graph);
+    BOOST_REQUIRE_EQUAL(num_vertices(serial_graph), num_vertices(graph));
+    for (auto v : boost::make_iterator_range(vertices(graph))) {
+        BOOST_CHECK(serial_graph[v].name == graph[v].name);
+        BOOST_CHECK(serial_graph[v].rrs == graph[v].rrs);
+        BOOST_CHECK(boost::range::equal(adjacent_vertices(v, serial_graph), adjacent_vertices(v, graph)));
+    }
+    BOOST_CHECK(serial_graph.get_origin() == graph.get_origin());
+}
+
+void ExpectSameGraphForAllTestFiles(const ParseFunction &parse)
+{
+    ForEachTestFile([&](std::string_view contents, const string &file) { ExpectSameGraph(contents, file, parse); });
+}
+
+// The chunk sizes the tests split zone files with, down to one record per chunk.
+const vector<size_t> kTestChunkSizes{1, 64, 4096};
+
+ParseFunction ChunkedParse(size_t chunk_size)
+{
+    return [chunk_size](std::string_view contents, zone::Graph &g, const string &file) {
+        return DriverTest().ParseZoneFile(contents, g, file, 3, chunk_size);
+    };
+}
+
+void CheckChunkedParsing(std::string_view contents, string file)
+{
+    for (size_t chunk_size : kTestChunkSizes) {
+        ExpectSameGraph(contents, file, ChunkedParse(chunk_size));
+    }
+}
+
+BOOST_AUTO_TEST_CASE(zone_file_chunked_parsing)
+{
+    // Splitting a zone file into chunks (down to one record per chunk) must not change the parse.
+    for (size_t chunk_size : kTestChunkSizes) {
+        ExpectSameGraphForAllTestFiles(ChunkedParse(chunk_size));
+    }
+
+    // $ORIGIN, $TTL, the implicit owner and open parentheses carried across chunk boundaries.
+    string zone = "$ORIGIN example.\n"
+                  "$TTL 300\n"
+                  "@ IN SOA ns1 hostmaster ( 1 2\n"
+                  "  3 4 5 )\n"
+                  "  IN NS ns1\n"
+                  "ns1 A 1.2.3.4\n"
+                  "    600 A 1.2.3.5\n"
+                  "$ORIGIN sub.example.\n"
+                  "www CNAME foo\n"
+                  "www A 1.1.1.1\n"
+                  "$TTL 100\n"
+                  "x A 1.1.1.1\n"
+                  "x A 1.1.1.1\n"
+                  "other.net. A 1.1.1.1\n";
+    CheckChunkedParsing(zone, "inline");
+
+    // A parse that stops midway stops at the same record.
+    CheckChunkedParsing(zone + "$INCLUDE other\nafter A 1.1.1.1\n", "inline");
+
+    // The default TTL set by the first explicit one and the implicit owner after a $TTL entry differ from the state
+    // after the first chunk, so the chunks that read them are parsed again.
+    string late_state = "example. SOA ns1 hostmaster 1 2 3 4 5\n"
+                        "a.example. 200 A 1.1.1.1\n"
+                        "b.example. A 1.1.1.1\n"
+                        "$TTL 50\n"
+                        "  A 1.1.1.2\n";
+    CheckChunkedParsing(late_state, "inline");
+}
+
+MiniContext BulkParse(std::string_view contents, zone::Graph &g, const string &file)
+{
+    return DriverTest().ParseZoneFile(contents, g, file, true);
+}
+
+void CheckBulkLoad(std::string_view contents, string file)
+{
+    ExpectSameGraph(contents, file, BulkParse);
+}
+
+BOOST_AUTO_TEST_CASE(zone_file_bulk_load)
+{
+    // Adding all the records of a zone file at once must build the same zone graph, vertex by vertex, and report the
+    // same issues in the same order as adding them one at a time.
+    ExpectSameGraphForAllTestFiles(BulkParse);
+
+    string zone = "$ORIGIN example.\n"
+                  "@ IN SOA ns1 hostmaster 1 2 3 4 5\n"
+                  "  IN NS ns1\n"
+                  "z.b A 1.1.1.1\n"
+                  "ns1 A 1.2.3.4\n"
+                  "ns1 A 1.2.3.4\n"
+                  "ns1 300 A 1.2.3.4\n"
+                  "www CNAME b\n"
+                  "www CNAME c\n"
+                  "www CNAME b\n"
+                  "www A 1.1.1.1\n"
+                  "b A 1.1.1.1\n"
+                  "b CNAME c\n"
+                  "d DNAME e\n"
+                  "d DNAME f\n"
+                  "d DNAME e\n"
+                  "d A 1.1.1.1\n"
+                  "x.y.z A 1.1.1.1\n"
+                  "other.net. A 1.1.1.1\n"
+                  "@ IN SOA ns1 hostmaster 1 2 3 4 5\n";
+    CheckBulkLoad(zone, "inline");
+    // Files whose zone membership depends on the order of the records are added one record at a time.
+    CheckBulkLoad(zone + "other.net. IN SOA ns1 hostmaster 1 2 3 4 5\nwww.other.net. A 1.1.1.1\n", "inline");
+}
+
+BOOST_AUTO_TEST_CASE(zone_graph_bulk_merge)
+{
+    // Adding records in bulk to a zone that already has records must merge them under the existing nodes exactly as
+    // adding them one at a time does, also below nodes with a child map and into RRsets kept in a hash set.
+    vector<ResourceRecord> records{
+        ResourceRecord("example", "SOA", 1, 10, "ns1.example. hostmaster.example. 1 2 3 4 5"),
+        ResourceRecord("example", "NS", 1, 10, "ns1.example.")};
+    for (int i = 0; i < 600; i++) {
+        records.push_back(ResourceRecord("h" + std::to_string(i) + ".example", "A", 1, 10, "1.1.1.1"));
+        if (i % 30 == 0) {
+            records.push_back(ResourceRecord("big.example", "TXT", 1, 10, std::to_string(i)));
+            records.push_back(ResourceRecord("x.h" + std::to_string(i) + ".example", "A", 1, 10, "1.1.1.1"));
+        }
+    }
+    for (string name : {"h7.example", "big.example", "www.example", "*.example", "a.b.c.example", "b.c.example"}) {
+        records.push_back(ResourceRecord(name, "A", 1, 10, "1.1.1.1"));
+        records.push_back(ResourceRecord(name, "TXT", 1, 10, "0"));
+        records.push_back(ResourceRecord(name, "CNAME", 1, 10, "h1.example."));
+        records.push_back(ResourceRecord("d." + name, "DNAME", 1, 10, "h1.example."));
+        records.push_back(ResourceRecord("d." + name, "DNAME", 1, 10, "h2.example."));
+    }
+
+    zone::Graph incremental(1);
+    vector<tuple<zone::RRAddCode, boost::optional<zone::Graph::VertexDescriptor>>> expected;
+    for (auto &record : records) {
+        expected.push_back(incremental.AddResourceRecord(record));
+    }
+    for (size_t split : {1, 2, 100, 400, 650}) {
+        zone::Graph merged(1);
+        auto results = merged.AddResourceRecords({records.begin(), records.begin() + split});
+        merged.BuildIndexes();
+        auto rest = merged.AddResourceRecords({records.begin() + split, records.end()});
+        results.insert(results.end(), rest.begin(), rest.end());
+        BOOST_CHECK(results == expected);
+        BOOST_REQUIRE_EQUAL(num_vertices(incremental), num_vertices(merged));
+        for (auto v : boost::make_iterator_range(vertices(merged))) {
+            BOOST_CHECK(incremental[v].name == merged[v].name);
+            BOOST_CHECK(incremental[v].rrs == merged[v].rrs);
+            BOOST_CHECK(incremental[v].wildcard_child == merged[v].wildcard_child);
+            BOOST_CHECK(boost::range::equal(adjacent_vertices(v, incremental), adjacent_vertices(v, merged)));
+        }
+        BOOST_CHECK(incremental.get_origin() == merged.get_origin());
+    }
+}
+
+string Compress(std::string_view contents, ZoneFileDecompressor::Format format)
+{
+    string compressed;
+    boost::iostreams::filtering_ostream out;
+    if (format == ZoneFileDecompressor::Format::GZIP) {
+        out.push(boost::iostreams::gzip_compressor());
+    } else {
+        out.push(boost::iostreams::zstd_compressor());
+    }
+    out.push(boost::iostreams::back_inserter(compressed));
+    boost::iostreams::copy(boost::iostreams::array_source(contents.data(), contents.size()), out);
+    return compressed;
+}
+
+// Compresses the contents and streams them through the parser in chunks of the given size, or lets Driver detect the
+// format when there is no chunk size.
+ParseFunction CompressedParse(ZoneFileDecompressor::Format format, boost::optional<size_t> chunk_size)
+{
+    return [format, chunk_size](std::string_view contents, zone::Graph &g, const string &file) {
+        BOOST_CHECK(ZoneFileDecompressor::DetectFormat(contents) == ZoneFileDecompressor::Format::NONE);
+        string compressed = Compress(contents, format);
+        BOOST_CHECK(ZoneFileDecompressor::DetectFormat(compressed) == format);
+        DriverTest dt;
+        if (chunk_size) {
+            return dt.ParseCompressedZoneFile(compressed, format, g, file, chunk_size.get());
+        }
+        Driver d;
+        return dt.ParseOrLoadZoneFile(d, compressed, g, file);
+    };
+}
+
+vector<ParseFunction> CompressedParses()
+{
+    vector<ParseFunction> parses;
+    for (auto format : {ZoneFileDecompressor::Format::GZIP, ZoneFileDecompressor::Format::ZSTD}) {
+        for (size_t chunk_size : kTestChunkSizes) {
+            parses.push_back(CompressedParse(format, chunk_size));
+        }
+        parses.push_back(CompressedParse(format, boost::none));
+    }
+    return parses;
+}
+
+void CheckCompressedParsing(std::string_view contents, string file)
+{
+    for (auto &parse : CompressedParses()) {
+        ExpectSameGraph(contents, file, parse);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(zone_file_compressed)
+{
+    // A gzip or zstd compressed zone file streamed through the parser (down to a line at a time) must give the same
+    // parse as the uncompressed file.
+    for (auto &parse : CompressedParses()) {
+        ExpectSameGraphForAllTestFiles(parse);
+    }
+
+    // Records in parentheses spread over several chunks, a missing final line break and a parse that stops midway.
+    string zone = "$ORIGIN example.\n"
+                  "$TTL 300\n"
+                  "@ IN SOA ns1 hostmaster ( 1 2\n"
+                  "  3\n"
+                  "  4 5 )\n"
+                  "  IN NS ns1\n"
+                  "ns1 A 1.2.3.4\n"
+                  "www CNAME foo\n"
+                  "www A 1.1.1.1\n"
+                  "other.net. A 1.1.1.1";
+    CheckCompressedParsing(zone, "inline");
+    CheckCompressedParsing(zone + "\n$INCLUDE other\nafter A 1.1.1.1\n", "inline");
+
+    // Quoted strings with line breaks that are closed in a later chunk, and a quote that is never closed.
+    string quoted = "$ORIGIN example.\n"
+                    "@ IN SOA ns1 hostmaster 1 2 3 4 5\n"
+                    "txt TXT \"first\nsecond\n\" \"third\"\n"
+                    "www A 1.1.1.1\n"
+                    "txt TXT \"a;b\n(c)\n\"\n"
+                    "www TXT \"open\nx A 1.1.1.1\n";
+    CheckCompressedParsing(quoted, "inline");
+}
+
+string Wire16(uint16_t value)
+{
+    return {static_cast<char>(value >> 8), static_cast<char>(value & 0xff)};
+}
+
+string Wire32(uint32_t value)
+{
+    return Wire16(static_cast<uint16_t>(value >> 16)) + Wire16(static_cast<uint16_t>(value));
+}
+
+string WireRecord(string owner, uint16_t type, string rdata)
+{
+    return owner + Wire16(type) + Wire16(1) + Wire32(300) + Wire16(static_cast<uint16_t>(rdata.size())) + rdata;
+}
+
+// A length prefixed AXFR response message for example. with the given answers. The question name is at offset 12,
+// so the compression pointer "\xc0\x0c" stands for example.
+string WireMessage(const vector<string> &answers)
+{
+    string message = Wire16(1) + string("\x80\x00", 2) + Wire16(1) + Wire16(static_cast<uint16_t>(answers.size())) +
+                     Wire16(0) + Wire16(0) + string("\x07" "example\x00", 9) + Wire16(252) + Wire16(1);
+    for (auto &answer : answers) {
+        message += answer;
+    }
+    return Wire16(static_cast<uint16_t>(message.size())) + message;
+}
+
+BOOST_AUTO_TEST_CASE(zone_file_wire_format)
+{
+    // An AXFR dump has to give the same parse as the zone file with the same records.
+    const string example("\xc0\x0c", 2);
+    string soa = WireRecord(
+        example, 6,
+        "\x03ns1" + example + "\x0ahostmaster" + example + Wire32(1) + Wire32(2) + Wire32(3) + Wire32(4) + Wire32(5));
+    string dump = WireMessage({
+                      soa,
+                      WireRecord(example, 2, "\x03ns1" + example),
+                      WireRecord("\x03ns1" + example, 1, "\x01\x02\x03\x04"),
+                      WireRecord("\x03www" + example, 28, string("\x20\x01\x0d\xb8", 4) + string(11, '\0') + "\x01"),
+                      WireRecord(example, 15, Wire16(10) + "\x04mail" + example),
+                      WireRecord(example, 16, "\x0bv=spf1 -all\x03" "a\"b"),
+                      WireRecord("\x03sub" + example, 48, "\x01\x02"),
+                      WireRecord("\x03sub" + example, 43, "\x01\x02\xff" + string(1, '\0')),
+                  }) +
+                  WireMessage({
+                      WireRecord("\x05" "alias" + example, 5, "\x03www" + example),
+                      WireRecord("\x03ns1" + example, 1, "\x01\x02\x03\x04"),
+                      soa,
+                  });
+    string zone = "example. 300 IN SOA ns1.example. hostmaster.example. 1 2 3 4 5\n"
+                  "example. 300 IN NS ns1.example.\n"
+                  "ns1.example. 300 IN A 1.2.3.4\n"
+                  "www.example. 300 IN AAAA 2001:db8::1\n"
+                  "example. 300 IN MX 10 mail.example.\n"
+                  "example. 300 IN TXT \"v=spf1 -all\" \"a\\\"b\"\n"
+                  "sub.example. 300 IN DS \\# 4 0102ff00\n"
+                  "alias.example. 300 IN CNAME www.example.\n"
+                  "ns1.example. 300 IN A 1.2.3.4\n";
+    DriverTest dt;
+    zone::Graph text_graph(1), wire_graph(1);
+    MiniContext text = dt.ParseZoneFile(zone, text_graph, "inline", 1, 0);
+    MiniContext wire = dt.ParseWireZoneFile(dump, wire_graph, "inline");
+    // The record of an unmodelled type is skipped but the closing SOA record is counted.
+    BOOST_CHECK_EQUAL(10, wire.lines);
+    wire.lines = text.lines;
+    CheckSameParse(text, text_graph, wire, wire_graph);
+    BOOST_CHECK(wire.parsed_completely);
+    BOOST_CHECK_EQUAL(1, wire.type_to_count["Duplicate-Records"]);
+
+    // Truncated dumps and compression pointers that do not point backwards are reported.
+    zone::Graph truncated_graph(1);
+    MiniContext truncated = dt.ParseWireZoneFile(dump.substr(0, dump.size() - 3), truncated_graph, "inline");
+    BOOST_CHECK(!truncated.parsed_completely);
+    // Only the records of the first (complete) message.
+    BOOST_CHECK_EQUAL(7, truncated.rrs_parsed);
+    zone::Graph loop_graph(1);
+    MiniContext loop = dt.ParseWireZoneFile(
+        WireMessage({soa, WireRecord("\x03ns1\xc0\x2f", 1, "\x01\x02\x03\x04")}), loop_graph, "inline");
+    BOOST_CHECK(!loop.parsed_completely);
+    BOOST_CHECK_EQUAL(1, loop.rrs_parsed);
+
+    // Driver reads the files with "Format": "wire" in the metadata as AXFR dumps, in serial and in parallel.
+    auto directory = boost::filesystem::temp_directory_path() / boost::filesystem::unique_path();
+    boost::filesystem::create_directories(directory);
+    std::ofstream((directory / "example.axfr").string(), std::ios::binary) << dump;
+    std::ofstream((directory / "example.txt").string()) << zone;
+    json metadata = {
+        {"TopNameServers", {"ns1.example."}},
+        {"ZoneFiles",
+         {{{"FileName", "example.axfr"}, {"NameServer", "ns1.example."}, {"Format", "Wire"}},
+          {{"FileName", "example.txt"}, {"NameServer", "ns2.example."}}}}};
+    for (int threads : {1, 2}) {
+        Driver d;
+        BOOST_CHECK_EQUAL(2 * text.rrs_parsed, d.SetContext(metadata, directory.string(), false, threads));
+    }
+    boost::filesystem::remove_all(directory);
+}
+
+BOOST_AUTO_TEST_CASE(zone_file_cache)
+{
+    // A zone file loaded from the cache must give the same zone graph and parse summary as parsing it.
+    auto directory = boost::filesystem::temp_directory_path() / boost::filesystem::unique_path();
+    ZoneCache cache(directory.string());
+    DriverTest dt;
+    ForEachTestFile([&](std::string_view contents, const string &file) {
+        uint64_t hash = ZoneCache::Hash(contents);
+        zone::Graph parsed_graph(1), loaded_graph(1);
+        MiniContext parsed = dt.ParseZoneFile(contents, parsed_graph, file, 1, 0);
+        cache.Store(hash, contents.size(), "", parsed);
+        MiniContext loaded;
+        loaded.file_name = file;
+        loaded.lint = true;
+        BOOST_REQUIRE(cache.Load(hash, contents.size(), "", loaded_graph, loaded));
+        CheckSameParse(parsed, parsed_graph, loaded, loaded_graph);
+        // The entry belongs to these contents parsed with this origin and lint flag only.
+        MiniContext other;
+        other.lint = false;
+        BOOST_CHECK(!cache.Load(hash, contents.size(), "", loaded_graph, other));
+        BOOST_CHECK(!cache.Load(hash, contents.size(), "example.", loaded_graph, loaded));
+        BOOST_CHECK(!cache.Load(hash + 1, contents.size(), "", loaded_graph, loaded));
+    });
+
+    // Driver stores every parsed zone file and loads it back when the contents have not changed.
+    Driver d;
+    d.SetZoneCache(directory.string());
+    string zone = "$ORIGIN example.\n@ IN SOA ns1 hostmaster 1 2 3 4 5\n  IN NS ns1\nns1 A 1.2.3.4\n";
+    auto entries = [&]() {
+        return std::distance(
+            boost::filesystem::directory_iterator(directory), boost::filesystem::directory_iterator());
+    };
+    auto before = entries();
+    zone::Graph g1(1), g2(1), g3(1);
+    MiniContext stored = dt.ParseOrLoadZoneFile(d, zone, g1, "inline");
+    BOOST_CHECK_EQUAL(before + 1, entries());
+    MiniContext loaded = dt.ParseOrLoadZoneFile(d, zone, g2, "inline");
+    BOOST_CHECK_EQUAL(before + 1, entries());
+    CheckSameParse(stored, g1, loaded, g2);
+    MiniContext changed = dt.ParseOrLoadZoneFile(d, zone + "ns1 A 1.2.3.5\n", g3, "inline");
+    BOOST_CHECK_EQUAL(before + 2, entries());
+    BOOST_CHECK_EQUAL(4, changed.rrs_parsed);
+    boost::filesystem::remove_all(directory);
+}
+
 BOOST_AUTO_TEST_CASE(multiple_CNAME)
 {
     zone::Graph zoneGraph(0);
@@ -259,4 +714,234 @@ BOOST_AUTO_TEST_CASE(Wildcard)
     BOOST_CHECK(std::get<0>(double_star_answer.get()[0]) == ReturnTag::NX);
 }
 
+BOOST_AUTO_TEST_CASE(zone_graph_child_index)
+{
+    zone::Graph zoneGraph(0);
+    ResourceRecord soa(
+        "foo.com", "SOA", 1, 10, "us.illinois.net. us-domain.illinois.net. 2018083000 14400 3600 2419200 14400");
+    zoneGraph.AddResourceRecord(soa);
+    // More children than kSortedChildrenLimit under foo.com, a few under d0.foo.com and a wildcard at both.
+    int max = kSortedChildrenLimit * 4;
+    for (int i = 0; i < max; i++) {
+        zoneGraph.AddResourceRecord(ResourceRecord("d" + std::to_string(i) + ".foo.com", "A", 1, 10, "1.1.1.1"));
+    }
+    for (int i = 0; i < 3; i++) {
+        zoneGraph.AddResourceRecord(ResourceRecord("e" + std::to_string(i) + ".d0.foo.com", "A", 1, 10, "2.2.2.2"));
+    }
+    zoneGraph.AddResourceRecord(ResourceRecord("*.foo.com", "A", 1, 10, "3.3.3.3"));
+    zoneGraph.AddResourceRecord(ResourceRecord("*.d0.foo.com", "TXT", 1, 10, "wildcard"));
+
+    vector<string> names{"foo.com",      "d7.foo.com",     "e1.d0.foo.com", "x.foo.com",
+                         "x.d0.foo.com", "a.x.d5.foo.com", "*.foo.com",     "d" + std::to_string(max) + ".foo.com"};
+    vector<EC> queries;
+    for (auto &name : names) {
+        EC query;
+        query.name = LabelUtils::StringToLabels(name);
+        query.rrTypes.set(RRType::A);
+        query.rrTypes.set(RRType::TXT);
+        queries.push_back(query);
+    }
+    auto look_up_all = [&]() {
+        vector<boost::optional<vector<zone::LookUpAnswer>>> answers;
+        for (auto &query : queries) {
+            bool complete = false;
+            answers.push_back(zoneGraph.QueryLookUpAtZone(query, complete));
+        }
+        return answers;
+    };
+
+    auto unindexed = look_up_all();
+    zoneGraph.BuildChildIndex();
+    BOOST_CHECK(unindexed == look_up_all());
+    BOOST_CHECK(std::get<0>(unindexed[3].get()[0]) == ReturnTag::ANS);
+    BOOST_CHECK_EQUAL("3.3.3.3", std::get<2>(unindexed[3].get()[0]).front().get_rdata());
+    BOOST_CHECK(std::get<0>(unindexed[4].get()[0]) == ReturnTag::ANS);
+    BOOST_CHECK_EQUAL("wildcard", std::get<2>(unindexed[4].get()[0]).front().get_rdata());
+
+    // Adding a record drops the index.
+    auto [code, id] = zoneGraph.AddResourceRecord(ResourceRecord("x.foo.com", "A", 1, 10, "4.4.4.4"));
+    BOOST_CHECK(code == zone::RRAddCode::SUCCESS);
+    auto added = look_up_all();
+    BOOST_CHECK_EQUAL("4.4.4.4", std::get<2>(added[3].get()[0]).front().get_rdata());
+    zoneGraph.BuildChildIndex();
+    BOOST_CHECK(added == look_up_all());
+}
+
+BOOST_AUTO_TEST_CASE(zone_graph_canonical_index)
+{
+    zone::Graph zoneGraph(0);
+    ResourceRecord soa(
+        "foo.com", "SOA", 1, 10, "us.illinois.net. us-domain.illinois.net. 2018083000 14400 3600 2419200 14400");
+    zoneGraph.AddResourceRecord(soa);
+    zoneGraph.AddResourceRecord(ResourceRecord("foo.com", "NS", 1, 10, "ns.foo.com."));
+    zoneGraph.AddResourceRecord(ResourceRecord("ns.foo.com", "A", 1, 10, "1.1.1.1"));
+    zoneGraph.AddResourceRecord(ResourceRecord("sub.foo.com", "NS", 1, 10, "ns.sub.foo.com."));
+    zoneGraph.AddResourceRecord(ResourceRecord("ns.sub.foo.com", "A", 1, 10, "2.2.2.2"));
+    zoneGraph.AddResourceRecord(ResourceRecord("dn.foo.com", "DNAME", 1, 10, "bar.com."));
+    zoneGraph.AddResourceRecord(ResourceRecord("a.dn.foo.com", "A", 1, 10, "3.3.3.3"));
+    zoneGraph.AddResourceRecord(ResourceRecord("*.foo.com", "TXT", 1, 10, "wildcard"));
+    zoneGraph.AddResourceRecord(ResourceRecord("z.a.foo.com", "A", 1, 10, "4.4.4.4"));
+    zoneGraph.AddResourceRecord(ResourceRecord("0.foo.com", "A", 1, 10, "5.5.5.5"));
+    zoneGraph.AddResourceRecord(ResourceRecord("-.foo.com", "A", 1, 10, "6.6.6.6"));
+
+    vector<EC> queries;
+    for (string name : {"foo.com", "ns.foo.com", "sub.foo.com", "x.ns.sub.foo.com", "dn.foo.com", "a.dn.foo.com",
+                        "a.foo.com", "b.a.foo.com", "z.a.foo.com", "y.z.a.foo.com", "0.foo.com", "1.foo.com",
+                        "-.foo.com", "*.foo.com", "com", "bar.com", "org"}) {
+        EC query;
+        query.name = LabelUtils::StringToLabels(name);
+        query.rrTypes.set(RRType::A);
+        query.rrTypes.set(RRType::NS);
+        queries.push_back(query);
+        query.excluded = boost::make_optional(std::vector<NodeLabel>{});
+        queries.push_back(query);
+    }
+    auto look_up_all = [&]() {
+        vector<tuple<bool, boost::optional<vector<zone::LookUpAnswer>>>> answers;
+        for (auto &query : queries) {
+            bool complete = false;
+            auto answer = zoneGraph.QueryLookUpAtZone(query, complete);
+            answers.push_back({complete, answer});
+        }
+        return answers;
+    };
+    auto unindexed = look_up_all();
+    zoneGraph.BuildCanonicalIndex();
+    BOOST_CHECK(unindexed == look_up_all());
+    zoneGraph.BuildChildIndex();
+    BOOST_CHECK(unindexed == look_up_all());
+
+    // The names of the zone come in canonical order and a subtree is a contiguous range.
+    vector<string> names;
+    for (auto &entry : zoneGraph.get_canonical_index().Subtree(LabelUtils::StringToLabels("foo.com"))) {
+        names.push_back(LabelUtils::LabelsToString(zoneGraph.get_canonical_index().Name(entry)));
+    }
+    vector<string> expected{"foo.com.",    "*.foo.com.",     "-.foo.com.",  "0.foo.com.",     "a.foo.com.",
+                            "z.a.foo.com.", "dn.foo.com.",   "a.dn.foo.com.", "ns.foo.com.", "sub.foo.com.",
+                            "ns.sub.foo.com."};
+    BOOST_CHECK_EQUAL_COLLECTIONS(names.begin(), names.end(), expected.begin(), expected.end());
+    BOOST_CHECK_EQUAL(2, zoneGraph.get_canonical_index().Subtree(LabelUtils::StringToLabels("a.foo.com")).size());
+    BOOST_CHECK(zoneGraph.get_canonical_index().Subtree(LabelUtils::StringToLabels("b.foo.com")).empty());
+    BOOST_CHECK(zoneGraph.get_canonical_index().Find(LabelUtils::StringToLabels("sub.foo.com"))->zone_cut);
+}
+
+BOOST_AUTO_TEST_CASE(zone_graph_record_arena)
+{
+    zone::Graph zoneGraph(0);
+    ResourceRecord soa(
+        "foo.com", "SOA", 1, 10, "us.illinois.net. us-domain.illinois.net. 2018083000 14400 3600 2419200 14400");
+    zoneGraph.AddResourceRecord(soa);
+    zoneGraph.AddResourceRecord(ResourceRecord("foo.com", "TXT", 1, 10, "first"));
+    zoneGraph.AddResourceRecord(ResourceRecord("foo.com", "NS", 1, 10, "ns.foo.com."));
+    zoneGraph.AddResourceRecord(ResourceRecord("foo.com", "A", 1, 10, "1.1.1.1"));
+    zoneGraph.AddResourceRecord(ResourceRecord("foo.com", "TXT", 1, 10, "second"));
+    zoneGraph.AddResourceRecord(ResourceRecord("foo.com", "A", 1, 10, "1.1.1.2"));
+    zoneGraph.AddResourceRecord(ResourceRecord("ns.foo.com", "AAAA", 1, 10, "::1"));
+    zoneGraph.AddResourceRecord(ResourceRecord("ns.foo.com", "A", 1, 10, "1.1.1.3"));
+    zoneGraph.AddResourceRecord(ResourceRecord("sub.foo.com", "NS", 1, 10, "ns.sub.foo.com."));
+    zoneGraph.AddResourceRecord(ResourceRecord("ns.sub.foo.com", "A", 1, 10, "2.2.2.2"));
+    zoneGraph.AddResourceRecord(ResourceRecord("*.foo.com", "TXT", 1, 10, "wildcard"));
+
+    vector<EC> queries;
+    for (string name : {"foo.com", "ns.foo.com", "sub.foo.com", "ns.sub.foo.com", "x.foo.com"}) {
+        EC query;
+        query.name = LabelUtils::StringToLabels(name);
+        query.rrTypes.set(RRType::A);
+        query.rrTypes.set(RRType::NS);
+        query.rrTypes.set(RRType::TXT);
+        queries.push_back(query);
+    }
+    auto look_up_all = [&]() {
+        vector<boost::optional<vector<zone::LookUpAnswer>>> answers;
+        for (auto &query : queries) {
+            bool complete = false;
+            answers.push_back(zoneGraph.QueryLookUpAtZone(query, complete));
+        }
+        return answers;
+    };
+    auto rrsets = [&](string name) {
+        zone::Graph::VertexDescriptor v = 0;
+        for (auto &label : LabelUtils::StringToLabels(name)) {
+            for (auto u : boost::make_iterator_range(adjacent_vertices(v, zoneGraph))) {
+                if (zoneGraph[u].name == label) {
+                    v = u;
+                }
+            }
+        }
+        vector<vector<string>> rdata(RRType::N);
+        for (int type = 0; type < RRType::N; type++) {
+            for (auto &rr : zoneGraph.RRSet(v, static_cast<RRType>(type))) {
+                rdata[type].push_back(rr.get_rdata());
+            }
+        }
+        return std::make_tuple(v, rdata);
+    };
+
+    // The records of a node are grouped by type and keep the order they were added in within a type.
+    auto [apex, apex_rrsets] = rrsets("foo.com");
+    vector<string> txt{"first", "second"};
+    BOOST_CHECK(apex_rrsets[RRType::TXT] == txt);
+    BOOST_CHECK_EQUAL(6, zoneGraph.Records(apex).size());
+    BOOST_CHECK(zoneGraph.Records(apex).front().get_type() == RRType::A);
+    BOOST_CHECK(zoneGraph[apex].rr_types[RRType::SOA] && !zoneGraph[apex].zone_cut());
+    BOOST_CHECK(zoneGraph[apex].wildcard_child);
+
+    // Only the answers of an indexed zone carry the referral; the rest of the answers must not depend on the index.
+    auto without_referrals = [](vector<boost::optional<vector<zone::LookUpAnswer>>> answers) {
+        for (auto &answer : answers) {
+            for (auto &a : answer.get()) {
+                std::get<3>(a) = nullptr;
+            }
+        }
+        return answers;
+    };
+
+    auto unindexed = look_up_all();
+    zoneGraph.BuildIndexes();
+    auto indexed = look_up_all();
+    BOOST_CHECK(unindexed == without_referrals(indexed));
+    BOOST_CHECK(std::get<1>(rrsets("foo.com")) == apex_rrsets);
+    BOOST_CHECK_EQUAL(6, zoneGraph.Records(apex).size());
+    BOOST_CHECK(zoneGraph.RRSet(apex, RRType::MX).empty());
+    auto [cut, cut_rrsets] = rrsets("sub.foo.com");
+    auto [glue, glue_rrsets] = rrsets("ns.sub.foo.com");
+    BOOST_CHECK(zoneGraph[cut].zone_cut());
+    BOOST_CHECK(zoneGraph[apex].authoritative && !zoneGraph[cut].authoritative && !zoneGraph[glue].authoritative);
+    BOOST_CHECK_EQUAL("2.2.2.2", glue_rrsets[RRType::A][0]);
+
+    // The referral of a cut pairs every NS record with its glue.
+    const zone::Referral *referral = zoneGraph.FindReferral(LabelUtils::StringToLabels("sub.foo.com"));
+    BOOST_REQUIRE(referral);
+    BOOST_CHECK(referral->glue_required);
+    BOOST_REQUIRE_EQUAL(1, referral->pairs.size());
+    BOOST_CHECK_EQUAL("ns.sub.foo.com.", std::get<0>(referral->pairs[0]).get_rdata());
+    BOOST_REQUIRE_EQUAL(1, std::get<1>(referral->pairs[0]).size());
+    BOOST_CHECK_EQUAL("2.2.2.2", std::get<1>(referral->pairs[0])[0].get_rdata());
+    BOOST_CHECK_EQUAL(3, zoneGraph.FindReferral(LabelUtils::StringToLabels("foo.com"))->records.size());
+    BOOST_CHECK(!zoneGraph.FindReferral(LabelUtils::StringToLabels("ns.foo.com")));
+    BOOST_CHECK(!zoneGraph.FindReferral(LabelUtils::StringToLabels("y.foo.com")));
+    BOOST_CHECK(std::get<0>(indexed[2].get()[0]) == ReturnTag::REF);
+    BOOST_CHECK(std::get<3>(indexed[2].get()[0]) == referral);
+    BOOST_CHECK(!std::get<3>(unindexed[2].get()[0]));
+
+    // An answer lists the records grouped by type, the NS records and their glue last, and not in the order they were
+    // added to the node.
+    vector<string> answer;
+    for (auto &rr : std::get<2>(indexed[0].get()[0])) {
+        answer.push_back(rr.get_rdata());
+    }
+    vector<string> expected{"1.1.1.1", "1.1.1.2", "first", "second", "ns.foo.com.", "1.1.1.3", "::1"};
+    BOOST_CHECK(answer == expected);
+
+    // Adding a record moves the records back to the nodes.
+    zoneGraph.AddResourceRecord(ResourceRecord("foo.com", "TXT", 1, 10, "third"));
+    // The answers share the arena, which outlives the index for them.
+    BOOST_CHECK(unindexed == without_referrals(indexed));
+    BOOST_CHECK_EQUAL(7, std::get<2>(indexed[0].get()[0]).size());
+    txt.push_back("third");
+    BOOST_CHECK(std::get<1>(rrsets("foo.com"))[RRType::TXT] == txt);
+    BOOST_CHECK_EQUAL("2.2.2.2", std::get<1>(rrsets("ns.sub.foo.com"))[RRType::A][0]);
+    BOOST_CHECK_EQUAL(7, zoneGraph.Records(apex).size());
+}
+
 BOOST_AUTO_TEST_SUITE_END()
\ No newline at end of file